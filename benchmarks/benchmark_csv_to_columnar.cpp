@@ -66,9 +66,17 @@ static CsvCompareResult CompareCsvFiles(const std::filesystem::path& lhs_path, c
 int main(const int argc, char** argv) {
     try {
         size_t rows_per_group = RowsPerGroup;
-        if (argc == 2) {
+        Compression compression = DefaultCompression;
+        int compression_level = DefaultCompressionLevel;
+        if (argc >= 2) {
             rows_per_group = std::stoull(argv[1]);
         }
+        if (argc >= 3) {
+            compression = CompressionFromName(argv[2]);
+        }
+        if (argc >= 4) {
+            compression_level = std::stoi(argv[3]);
+        }
 
         const std::filesystem::path schema_path = COLUMNAR_BENCHMARK_DEFAULT_SCHEMA;
         const std::filesystem::path data_path = COLUMNAR_BENCHMARK_DEFAULT_DATA;
@@ -77,7 +85,7 @@ int main(const int argc, char** argv) {
         const std::filesystem::path roundtrip_data_path = COLUMNAR_BENCHMARK_DEFAULT_ROUNDTRIP_DATA;
 
         const auto csv_to_columnar_started_at = std::chrono::steady_clock::now();
-        ConvertCsvToColumnar(schema_path, data_path, output_path, rows_per_group, DefaultCompression);
+        ConvertCsvToColumnar(schema_path, data_path, output_path, rows_per_group, compression, compression_level);
         const auto csv_to_columnar_finished_at = std::chrono::steady_clock::now();
 
         const auto columnar_to_csv_started_at = std::chrono::steady_clock::now();
@@ -98,7 +106,8 @@ int main(const int argc, char** argv) {
         std::cout << "schema: " << schema_path << std::endl
                   << "data: " << data_path << std::endl
                   << "columnar_output: " << output_path << std::endl
-                  << "compression: " << CompressionName(DefaultCompression) << std::endl
+                  << "compression: " << CompressionName(compression) << std::endl
+                  << "compression_level: " << compression_level << std::endl
                   << "roundtrip_schema: " << roundtrip_schema_path << std::endl
                   << "roundtrip_data: " << roundtrip_data_path << std::endl
                   << "rows_per_group: " << rows_per_group << std::endl
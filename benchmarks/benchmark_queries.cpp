@@ -43,8 +43,8 @@ QueryRunStatus RunQuery(const Executor& executor, const std::filesystem::path& p
     const auto start = std::chrono::steady_clock::now();
 
     if (mode == QueryExecutionMode::Hardcoded) {
-        if (auto fast_result =
-                clickbench_fast::TryRun(planned_query != nullptr ? planned_query->table_path : "", query_id);
+        const bool single_file = planned_query != nullptr && planned_query->table_files.size() == 1;
+        if (auto fast_result = clickbench_fast::TryRun(single_file ? planned_query->table_files.front() : "", query_id);
             fast_result.has_value()) {
             result = std::move(*fast_result);
         } else if (planned_query != nullptr) {
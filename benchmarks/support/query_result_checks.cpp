@@ -79,7 +79,7 @@ static std::string TrimCopy(const std::string_view value) {
 
 static std::vector<std::vector<std::string>> ParseCsvRows(const std::string_view text) {
     std::istringstream in{std::string(text)};
-    const CsvReader reader(in);
+    CsvReader reader(in);
 
     std::vector<std::vector<std::string>> rows;
     std::vector<std::string> row;
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <vector>
+
+// Values are packed least significant bit first, each one taking exactly `width` bits; the last byte is zero padded.
+
+inline uint8_t BitWidthFor(const uint64_t max_value) { return static_cast<uint8_t>(std::bit_width(max_value)); }
+
+inline size_t PackedByteCount(const size_t count, const uint8_t width) { return (count * width + 7) / 8; }
+
+template <std::unsigned_integral T>
+void PackBits(const std::span<const T> values, const uint8_t width, std::vector<uint8_t>& out) {
+    const size_t begin = out.size();
+    out.resize(begin + PackedByteCount(values.size(), width), 0);
+    if (width == 0) {
+        return;
+    }
+
+    uint8_t* data = out.data() + begin;
+    size_t bit = 0;
+
+    for (const T value : values) {
+        uint64_t remaining_value = static_cast<uint64_t>(value);
+        size_t remaining_bits = width;
+
+        while (remaining_bits > 0) {
+            const size_t shift = bit & 7;
+            const size_t take = std::min<size_t>(remaining_bits, 8 - shift);
+            data[bit >> 3] |= static_cast<uint8_t>((remaining_value & ((uint64_t{1} << take) - 1)) << shift);
+
+            remaining_value >>= take;
+            remaining_bits -= take;
+            bit += take;
+        }
+    }
+}
+
+// Calls store(index, value) for `count` packed values; `packed` must hold PackedByteCount(count, width) bytes.
+// Byte-aligned widths are plain little-endian loads the compiler can vectorize; other widths read one 64-bit
+// window per value.
+template <class Store>
+void ForEachUnpacked(const std::span<const uint8_t> packed, const uint8_t width, const size_t count, Store&& store) {
+    const uint8_t* data = packed.data();
+
+    switch (width) {
+        case 0:
+            for (size_t i = 0; i < count; ++i) {
+                store(i, uint64_t{0});
+            }
+            return;
+        case 8:
+            for (size_t i = 0; i < count; ++i) {
+                store(i, static_cast<uint64_t>(data[i]));
+            }
+            return;
+        case 16:
+            for (size_t i = 0; i < count; ++i) {
+                uint16_t value = 0;
+                std::memcpy(&value, data + i * sizeof(value), sizeof(value));
+                store(i, static_cast<uint64_t>(value));
+            }
+            return;
+        case 32:
+            for (size_t i = 0; i < count; ++i) {
+                uint32_t value = 0;
+                std::memcpy(&value, data + i * sizeof(value), sizeof(value));
+                store(i, static_cast<uint64_t>(value));
+            }
+            return;
+        case 64:
+            for (size_t i = 0; i < count; ++i) {
+                uint64_t value = 0;
+                std::memcpy(&value, data + i * sizeof(value), sizeof(value));
+                store(i, value);
+            }
+            return;
+        default:
+            break;
+    }
+
+    const uint64_t mask = (uint64_t{1} << width) - 1;
+
+    for (size_t i = 0; i < count; ++i) {
+        const size_t bit = i * width;
+        const size_t byte = bit >> 3;
+        const size_t shift = bit & 7;
+
+        uint64_t word = 0;
+        if (byte + sizeof(word) <= packed.size()) {
+            std::memcpy(&word, data + byte, sizeof(word));
+        } else {
+            std::memcpy(&word, data + byte, packed.size() - byte);
+        }
+
+        uint64_t value = word >> shift;
+        if (shift + width > 64) {
+            value |= static_cast<uint64_t>(data[byte + sizeof(word)]) << (64 - shift);
+        }
+
+        store(i, value & mask);
+    }
+}
+
+template <std::unsigned_integral T>
+void UnpackBits(const std::span<const uint8_t> packed, const uint8_t width, const std::span<T> out) {
+    ForEachUnpacked(packed, width, out.size(), [&](const size_t i, const uint64_t value) {
+        out[i] = static_cast<T>(value);
+    });
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+// Split-block Bloom filter: a value sets one bit in each of the eight words of a single 256-bit block, so a lookup
+// touches one cache line. Values are given as 64-bit hashes; the high half picks the block, the low half the bits.
+class BloomFilter {
+   public:
+    static constexpr size_t WordsPerBlock = 8;
+    static constexpr size_t BitsPerValue = 10;
+
+    BloomFilter() = default;
+    explicit BloomFilter(const size_t block_count) : words_(block_count * WordsPerBlock, 0) {}
+    explicit BloomFilter(std::vector<uint32_t> words) : words_(std::move(words)) {}
+
+    // Sized for about 1% false positives at the given number of distinct values.
+    static BloomFilter ForDistinctCount(const size_t distinct_count) {
+        const size_t bits = std::max<size_t>(distinct_count, 1) * BitsPerValue;
+        return BloomFilter((bits + WordsPerBlock * 32 - 1) / (WordsPerBlock * 32));
+    }
+
+    bool Empty() const { return words_.empty(); }
+    size_t BlockCount() const { return words_.size() / WordsPerBlock; }
+    std::span<const uint32_t> Words() const { return words_; }
+
+    void Insert(const uint64_t hash) {
+        uint32_t* block = words_.data() + BlockIndex(hash) * WordsPerBlock;
+        for (size_t i = 0; i < WordsPerBlock; ++i) {
+            block[i] |= BitFor(hash, i);
+        }
+    }
+
+    // An empty filter was never built, so it cannot rule anything out.
+    bool MayContain(const uint64_t hash) const {
+        if (words_.empty()) {
+            return true;
+        }
+
+        const uint32_t* block = words_.data() + BlockIndex(hash) * WordsPerBlock;
+        for (size_t i = 0; i < WordsPerBlock; ++i) {
+            if ((block[i] & BitFor(hash, i)) == 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+   private:
+    static constexpr std::array<uint32_t, WordsPerBlock> Salts = {0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+                                                                  0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+
+    size_t BlockIndex(const uint64_t hash) const { return static_cast<size_t>(((hash >> 32) * BlockCount()) >> 32); }
+
+    static uint32_t BitFor(const uint64_t hash, const size_t word) {
+        return uint32_t{1} << ((static_cast<uint32_t>(hash) * Salts[word]) >> 27);
+    }
+
+    std::vector<uint32_t> words_;
+};
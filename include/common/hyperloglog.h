@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// HyperLogLog distinct-count sketch over 64-bit hashes with 2^14 registers (about 0.8% standard error). Sketches
+// built from the same hash function merge by taking the register-wise maximum.
+class HyperLogLog {
+   public:
+    static constexpr uint8_t Precision = 14;
+    static constexpr size_t RegisterCount = size_t{1} << Precision;
+
+    HyperLogLog();
+
+    void Insert(uint64_t hash);
+    void Merge(const HyperLogLog& other);
+    uint64_t Estimate() const;
+
+    // Dense sketches are stored as 6-bit packed registers, sparse ones as (index, rank) pairs, whichever is smaller.
+    void Serialize(std::vector<uint8_t>& out) const;
+    static HyperLogLog Deserialize(std::span<const uint8_t> bytes);
+
+   private:
+    bool IsDense() const { return !registers_.empty(); }
+    void Set(size_t index, uint8_t rank);
+    void Densify();
+
+    // Small sketches stay sparse: an unsorted list of (index << 8 | rank) entries that is compacted when it fills up,
+    // so a sketch only allocates the dense registers once enough of them are set.
+    std::vector<uint32_t> sparse_;
+    std::vector<uint8_t> registers_;
+};
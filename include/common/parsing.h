@@ -2,11 +2,12 @@
 
 #include <cstdint>
 #include <optional>
+#include <span>
 #include <string>
 #include <string_view>
 
-#include "model/schema.h"
 #include "common/int128.h"
+#include "model/schema.h"
 
 bool ParseBoolean(std::string_view value);
 int16_t ParseInt16(std::string_view value);
@@ -26,10 +27,21 @@ std::optional<int32_t> TryParseDate(std::string_view value);
 std::optional<int64_t> TryParseTimestamp(std::string_view value);
 std::optional<char> TryParseCharacter(std::string_view value);
 
+// Parse values[i] into out[i], which must be at least as long as values. Returns the index of the first value that
+// does not parse, with only the outputs before it written, or nothing when every value parses.
+std::optional<size_t> TryParseInt16s(std::span<const std::string_view> values, std::span<int16_t> out);
+std::optional<size_t> TryParseInt32s(std::span<const std::string_view> values, std::span<int32_t> out);
+std::optional<size_t> TryParseInt64s(std::span<const std::string_view> values, std::span<int64_t> out);
+std::optional<size_t> TryParseDates(std::span<const std::string_view> values, std::span<int32_t> out);
+std::optional<size_t> TryParseTimestamps(std::span<const std::string_view> values, std::span<int64_t> out);
+
 std::string BooleanToString(bool value);
 std::string Int128ToString(Int128 value);
 std::string DateToString(int32_t value);
 std::string TimestampToString(int64_t value);
+// Append the text of DateToString and TimestampToString to `out`.
+void AppendDate(std::string& out, int32_t value);
+void AppendTimestamp(std::string& out, int64_t value);
 
 ColumnType ParseColumnType(std::string_view input);
 std::string ColumnTypeToString(ColumnType type);
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#include "common/int128.h"
+
+// Hashes that end up in file metadata (Bloom filters, sketches), so they must not change between builds or platforms
+// the way std::hash may.
+
+inline uint64_t StableHash(uint64_t value) {
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ULL;
+    value ^= value >> 33;
+    return value;
+}
+
+inline uint64_t StableHash(const Int128 value) {
+    const auto bits = static_cast<UInt128>(value);
+    const uint64_t high = StableHash(static_cast<uint64_t>(bits >> 64) + uint64_t{0x9e3779b97f4a7c15ULL});
+    return StableHash(static_cast<uint64_t>(bits) ^ high);
+}
+
+inline uint64_t StableHash(const std::string_view value) {
+    uint64_t hash = StableHash(uint64_t{value.size()} ^ uint64_t{0x2545f4914f6cdd1dULL});
+
+    size_t offset = 0;
+    for (; offset + sizeof(uint64_t) <= value.size(); offset += sizeof(uint64_t)) {
+        uint64_t word = 0;
+        std::memcpy(&word, value.data() + offset, sizeof(word));
+        hash = StableHash(hash ^ word);
+    }
+
+    uint64_t tail = 0;
+    std::memcpy(&tail, value.data() + offset, value.size() - offset);
+    return StableHash(hash ^ tail);
+}
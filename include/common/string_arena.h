@@ -27,10 +27,14 @@ class StringArena {
 };
 
 struct StringViewHash {
+    using is_transparent = void;
+
     size_t operator()(std::string_view value) const noexcept;
 };
 
 struct StringViewEqual {
+    using is_transparent = void;
+
     bool operator()(std::string_view lhs, std::string_view rhs) const noexcept;
 };
 
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+class ThreadPool {
+   public:
+    explicit ThreadPool(size_t threads = DefaultThreadCount());
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool(ThreadPool&&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    ThreadPool& operator=(ThreadPool&&) = delete;
+    ~ThreadPool();
+
+    static size_t DefaultThreadCount();
+
+    size_t ThreadCount() const { return workers_.size(); }
+
+    template <class F>
+    std::future<std::invoke_result_t<F>> Submit(F task) {
+        using Result = std::invoke_result_t<F>;
+        auto packaged = std::make_shared<std::packaged_task<Result()>>(std::move(task));
+        std::future<Result> future = packaged->get_future();
+        Enqueue([packaged] { (*packaged)(); });
+        return future;
+    }
+
+   private:
+    void Enqueue(std::function<void()> task);
+    void WorkerLoop();
+
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::deque<std::function<void()>> tasks_;
+    bool stopping_ = false;
+
+    std::vector<std::thread> workers_;
+};
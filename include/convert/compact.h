@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+#include "convert/csv_columnar.h"
+#include "io/columnar_batch.h"
+
+struct CompactOptions {
+    // Output row groups end at whichever limit comes first; the byte limit is on the uncompressed chunk size estimated
+    // from the input footer, and 0 disables it.
+    size_t target_rows = DefaultMaxRowsPerGroup;
+    uint64_t target_bytes = 0;
+
+    // Codec and encodings of the rewritten chunks. Bloom filters and distinct sketches the input already has are kept.
+    ColumnarWriteOptions write_options = {};
+    // Empty keeps the input row order.
+    SortOptions sort = {};
+
+    // Row groups encoded at once; 0 uses the hardware concurrency.
+    size_t threads = 0;
+};
+
+// Streams the row groups of `input` into `output` with small groups coalesced and large ones split. Memory stays
+// around `threads` output row groups (plus one sort run when sorting). `output` may be `input`, which is then replaced
+// once the compacted file is complete.
+void CompactColumnarFile(const std::filesystem::path& input, const std::filesystem::path& output,
+                         const CompactOptions& options = {});
@@ -2,13 +2,38 @@
 
 #include <cstddef>
 #include <filesystem>
+#include <string>
+#include <vector>
 
+#include "convert/pipeline.h"
+#include "io/columnar_batch.h"
 #include "io/compression.h"
 
 inline constexpr size_t DefaultMaxRowsPerGroup = 1 << 14;
+inline constexpr size_t DefaultSortRunRows = 1 << 20;
+
+// Clusters the output by `columns`, compared in order, so each row group covers a narrow key range that min/max
+// pruning can skip. Rows are sorted in runs of at most run_rows that are spilled next to the output and merged.
+struct SortOptions {
+    std::vector<std::string> columns = {};
+    size_t run_rows = DefaultSortRunRows;
+};
 
 void ConvertCsvToColumnar(const std::filesystem::path& schema_path, const std::filesystem::path& data_path,
                           const std::filesystem::path& output_path, size_t max_rows_per_group = DefaultMaxRowsPerGroup,
-                          Compression compression = Compression::None);
+                          Compression compression = Compression::None,
+                          int compression_level = DefaultCompressionLevel);
+void ConvertCsvToColumnar(const std::filesystem::path& schema_path, const std::filesystem::path& data_path,
+                          const std::filesystem::path& output_path, size_t max_rows_per_group,
+                          const ColumnarWriteOptions& options);
+void ConvertCsvToColumnar(const std::filesystem::path& schema_path, const std::filesystem::path& data_path,
+                          const std::filesystem::path& output_path, size_t max_rows_per_group,
+                          const ColumnarWriteOptions& options, const SortOptions& sort);
+// Parsing, encoding and writing overlap through a ConvertPipeline. With more than one encode worker whole row groups
+// are encoded at once, and options.encode_threads is not used.
+void ConvertCsvToColumnar(const std::filesystem::path& schema_path, const std::filesystem::path& data_path,
+                          const std::filesystem::path& output_path, size_t max_rows_per_group,
+                          const ColumnarWriteOptions& options, const SortOptions& sort,
+                          const PipelineOptions& pipeline);
 void ConvertColumnarToCsv(const std::filesystem::path& columnar_path, const std::filesystem::path& schema_path,
                           const std::filesystem::path& data_path);
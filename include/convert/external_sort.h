@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "io/batch.h"
+#include "model/batch.h"
+
+std::vector<size_t> ResolveSortColumns(const Schema& schema, const std::vector<std::string>& names);
+
+// Sorts batches by key columns within bounded memory: every added batch is sorted into a run, runs are spilled to
+// temporary columnar files, and Merge streams them back in key order. Equal keys keep their arrival order.
+class ExternalSorter {
+   public:
+    ExternalSorter(Schema schema, std::vector<size_t> key_columns, std::filesystem::path spill_prefix);
+    ExternalSorter(const ExternalSorter&) = delete;
+    ExternalSorter& operator=(const ExternalSorter&) = delete;
+    ~ExternalSorter();
+
+    void Add(const Batch& batch);
+    void Merge(BatchWriter& writer, size_t rows_per_batch);
+
+   private:
+    void Spill(const Batch& run);
+
+    Schema schema_;
+    std::vector<size_t> key_columns_;
+    std::filesystem::path spill_prefix_;
+
+    // The latest run stays in memory, so an input that fits in one run is never spilled.
+    std::optional<Batch> pending_run_;
+    std::vector<std::filesystem::path> spilled_runs_;
+};
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include "common/bounded_queue.h"
+#include "common/thread_pool.h"
+#include "io/batch.h"
+#include "io/columnar_batch.h"
+#include "model/batch.h"
+
+inline constexpr size_t DefaultPipelineQueueBatches = 4;
+
+struct PipelineOptions {
+    // Threads parsing chunks of the CSV input; 0 uses the hardware concurrency.
+    size_t parse_workers = 0;
+    // Threads encoding and compressing row groups; 0 uses the hardware concurrency.
+    size_t encode_workers = 0;
+    // Batches waiting to be encoded, and encoded row groups held back for an earlier one still being encoded.
+    size_t queue_batches = DefaultPipelineQueueBatches;
+};
+
+// Turns batches into row groups in three stages: the thread calling Submit produces them, `encode_workers` threads
+// encode them and one more thread writes them to `writer` in submission order. The stages are linked by bounded
+// queues, so memory stays around queue_batches + encode_workers batches and throughput follows the slowest stage
+// rather than their sum. The first failure of any stage stops the others and is rethrown by Submit or Flush.
+class ConvertPipeline final : public BatchWriter {
+   public:
+    explicit ConvertPipeline(ColumnarBatchWriter& writer, const PipelineOptions& options = {});
+    ConvertPipeline(const ConvertPipeline&) = delete;
+    ConvertPipeline& operator=(const ConvertPipeline&) = delete;
+    ~ConvertPipeline() override;
+
+    void Write(const Batch& batch) override { Submit(batch); }
+    void Submit(Batch batch);
+
+    // Waits until every submitted batch is written; no batches are accepted afterwards.
+    void Flush() override;
+
+   private:
+    struct PendingBatch {
+        uint64_t sequence = 0;
+        Batch batch;
+    };
+
+    void EncodeStage();
+    void WriteStage();
+    void Fail(std::exception_ptr error);
+    void Stop();
+    void RethrowFailure();
+
+    ColumnarBatchWriter& writer_;
+    uint64_t reorder_window_;
+    BoundedQueue<PendingBatch> encode_queue_;
+
+    std::mutex mutex_;
+    std::condition_variable changed_;
+    std::map<uint64_t, EncodedRowGroup> encoded_;
+    uint64_t submitted_ = 0;
+    uint64_t written_ = 0;
+    bool closed_ = false;
+    bool stopping_ = false;
+    std::exception_ptr error_;
+
+    std::vector<std::future<void>> stages_;
+    ThreadPool pool_;
+};
@@ -7,6 +7,8 @@
 #include "common/int128.h"
 #include "executor/query_plan.h"
 
+class HyperLogLog;
+
 class AggState {
    public:
     AggState() = default;
@@ -20,6 +22,8 @@ class AggState {
     virtual void ConsumeInt128(Int128 value);
     virtual void ConsumeRow() = 0;
     virtual void ConsumeRows(size_t count);
+    // Folds in a precomputed sketch of the input, as stored in chunk metadata; only sketch-based states accept it.
+    virtual void ConsumeSketch(const HyperLogLog& sketch);
 
     virtual std::string Finalize() const = 0;
 };
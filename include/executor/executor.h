@@ -20,6 +20,7 @@ class Executor {
 
     void RegisterTable(const std::string& name, std::filesystem::path path);
     void SetUnsupportedFallbackEnabled(bool enabled);
+    void SetScanOptions(ScanOptions options);
 
     PlannedQuery Plan(const Query& query) const;
     ExecuteExpected Execute(std::string_view query) const;
@@ -32,5 +33,7 @@ class Executor {
 
     std::unordered_map<std::string, std::filesystem::path> tables_;
 
+    ScanOptions scan_options_;
+
     bool unsupported_fallback_enabled_ = false;
 };
@@ -5,15 +5,22 @@
 #include <optional>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "executor/operator.h"
 #include "executor/query_utils.h"
 
-std::unique_ptr<Operator> CreateMetadataCountOperator(std::filesystem::path path, std::string output_name);
-std::unique_ptr<Operator> CreateMetadataExtremaOperator(std::filesystem::path path, std::vector<PlannedAgg> aggregates);
+std::unique_ptr<Operator> CreateMetadataCountOperator(std::vector<std::filesystem::path> paths,
+                                                      std::string output_name);
+std::unique_ptr<Operator> CreateMetadataExtremaOperator(std::vector<std::filesystem::path> paths,
+                                                        std::vector<PlannedAgg> aggregates);
 std::unique_ptr<Operator> CreateScanOperator(std::filesystem::path path, std::vector<size_t> projection_indexes,
-                                             PredicatePtr filter);
+                                             PredicatePtr filter, ScanOptions options = {});
+// Concatenates the scans of the files in order; every file must have the table schema.
+std::unique_ptr<Operator> CreateTableScanOperator(std::vector<std::filesystem::path> paths, Schema schema,
+                                                  std::vector<size_t> projection_indexes, PredicatePtr filter,
+                                                  ScanOptions options = {});
 std::unique_ptr<Operator> CreateFilterOperator(std::unique_ptr<Operator> child, PredicatePtr filter);
 std::unique_ptr<Operator> CreateEnsureSchemaOperator(std::unique_ptr<Operator> child, Schema schema);
 std::unique_ptr<Operator> CreateProjectionOperator(std::unique_ptr<Operator> child, std::vector<SelectItemSpec> items,
@@ -31,6 +38,11 @@ std::unique_ptr<Operator> CreateGroupAggTopKOperator(std::unique_ptr<Operator> c
                                                      std::vector<PlannedSelectItem> select_items, PredicatePtr filter,
                                                      std::vector<PlannedOrderBy> order_by, size_t limit);
 
+// False when the Hive-style partition values of a file rule out every row the predicate could keep. Only keys that are
+// also columns of the schema take part; the others are ignored.
+bool MayMatchPartition(const PredicatePtr& predicate, const Schema& schema,
+                       const std::vector<std::pair<std::string, std::string>>& partition_values);
+
 void ApplyOrderOffsetLimit(std::unique_ptr<Operator>& root, const PlannedQuery& planned, bool& limit_applied_by_top_k);
 Schema ProjectionOutputSchema(const std::vector<SelectItemSpec>& items, const Schema& source_schema);
 
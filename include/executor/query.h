@@ -131,6 +131,14 @@ struct PredicateSpec {
     Int128 metadata_typed_literal_value = 0;
     ComparisonKind metadata_typed_comparison = ComparisonKind::Equal;
 
+    // Set for String columns when the literal compares as a plain string, i.e. it does not parse as a number, date
+    // or timestamp.
+    bool metadata_string_comparison_bound = false;
+
+    size_t metadata_string_column_index = 0;
+    std::string metadata_string_value;
+    ComparisonKind metadata_string_comparison = ComparisonKind::Equal;
+
     bool literal_in_set_bound = false;
 
     size_t in_column_index = 0;
@@ -141,9 +149,15 @@ struct PredicateSpec {
     size_t metadata_typed_in_column_index = 0;
     std::vector<Int128> metadata_typed_in_values;
 
+    // literal_in_values against a String column, by its index in the file schema.
+    bool metadata_string_in_set_bound = false;
+
+    size_t metadata_string_in_column_index = 0;
+
     bool literal_like_pattern_bound = false;
 
     size_t like_column_index = 0;
+    size_t metadata_like_column_index = 0;
     std::string like_pattern;
     bool like_negated = false;
 };
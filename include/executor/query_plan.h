@@ -11,6 +11,7 @@
 #include "common/int128.h"
 #include "executor/aggregate_function.h"
 #include "executor/query.h"
+#include "io/io_scheduler.h"
 #include "model/schema.h"
 
 struct PlannedAgg {
@@ -79,8 +80,30 @@ struct PlannedPredicate {
     PredicatePtr predicate;
 };
 
+constexpr size_t DefaultScanReadAheadRowGroups = 2;
+constexpr size_t DefaultScanConcurrentFiles = 4;
+
+enum class ScanIo {
+    Mapped,
+    Scheduled,
+};
+
+struct ScanOptions {
+    // Row groups decoded ahead of the consumer on a worker pool; 0 reads synchronously in Next().
+    size_t read_ahead_row_groups = DefaultScanReadAheadRowGroups;
+    // 0 uses the hardware concurrency.
+    size_t worker_threads = 0;
+    // Files of a partitioned table scanned at once, each by its own scan; the scans share one pool of worker threads.
+    size_t concurrent_files = DefaultScanConcurrentFiles;
+
+    // Scheduled issues the chunk reads of each read-ahead row group as one IoScheduler batch.
+    ScanIo io = ScanIo::Scheduled;
+    IoBackend io_backend = IoBackend::Auto;
+};
+
 struct PlannedQuery {
-    std::filesystem::path table_path;
+    // Files left after partition pruning; the schema comes from the first file of the table.
+    std::vector<std::filesystem::path> table_files;
     Schema table_schema;
 
     std::vector<size_t> projection_indexes;
@@ -100,6 +123,8 @@ struct PlannedQuery {
     std::optional<size_t> limit;
     size_t offset = 0;
 
+    ScanOptions scan_options;
+
     bool plain_select = false;
     bool metadata_count_only = false;
     bool metadata_extrema_only = false;
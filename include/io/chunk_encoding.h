@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "model/column.h"
+
+// How a chunk's values are laid out before the codec is applied.
+enum class ChunkEncoding : uint8_t {
+    Plain = 0,
+    Dictionary = 1,
+    // Frame of reference: the chunk minimum followed by bit-packed offsets from it.
+    BitPacked = 2,
+    // Run values as a bit-packed frame of reference followed by bit-packed run lengths.
+    RunLength = 3,
+    // First value followed by the bit-packed differences between neighbours.
+    Delta = 4,
+    // First value and first difference followed by the bit-packed differences between neighbouring differences.
+    DeltaOfDelta = 5,
+};
+
+struct EncodedChunk {
+    ChunkEncoding encoding = ChunkEncoding::Plain;
+    std::vector<uint8_t> bytes;
+};
+
+const char* ChunkEncodingName(ChunkEncoding encoding);
+
+std::vector<uint8_t> SerializeColumn(const Column& column);
+
+// Returns the plain layout unless `lightweight` is set and a type-specific encoding is smaller.
+EncodedChunk EncodeColumnChunk(const Column& column, bool lightweight);
+
+// Reads an encoded chunk into a column, which may replace the default column of the type.
+std::unique_ptr<MutableColumn> DecodeColumnChunk(std::span<const uint8_t> bytes, ChunkEncoding encoding,
+                                                 ColumnType type, uint32_t row_count);
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+#include "io/compression.h"
+
+inline constexpr size_t DefaultCodecSampleBytes = 64 << 10;
+
+enum class CodecObjective {
+    SmallestSize,
+    FastestDecode,
+    Balanced,
+};
+
+enum class CodecSelectionScope {
+    RowGroup,
+    File,
+};
+
+struct CodecSelection {
+    CodecObjective objective = CodecObjective::Balanced;
+    CodecSelectionScope scope = CodecSelectionScope::RowGroup;
+    size_t sample_bytes = DefaultCodecSampleBytes;
+};
+
+struct CodecChoice {
+    Compression compression = Compression::None;
+    int level = DefaultCompressionLevel;
+};
+
+const char* CodecObjectiveName(CodecObjective objective);
+CodecObjective CodecObjectiveFromName(std::string_view name);
+CodecSelectionScope CodecSelectionScopeFromName(std::string_view name);
+
+// Compresses evenly spaced slices of the chunk with each candidate codec and scores the extrapolated result.
+CodecChoice ChooseCodec(std::span<const uint8_t> chunk, const CodecSelection& selection);
@@ -1,11 +1,17 @@
 #pragma once
 
+#include <cstdint>
 #include <filesystem>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <span>
+#include <string>
 #include <vector>
 
+#include "common/thread_pool.h"
 #include "io/batch.h"
+#include "io/codec_selection.h"
 #include "io/compression.h"
 #include "io/file.h"
 #include "model/metadata.h"
@@ -24,43 +30,141 @@ class ColumnarBatchReader final : public BatchReader {
     const Schema& GetSchema() const { return metadata_.schema; }
     const ColumnarMetadata& GetMetadata() const { return metadata_; }
 
+    // The serialized metadata inside the mapping, located through the file footer.
+    static std::span<const uint8_t> MetadataBlob(const MappedFile& input);
+    // Maps a columnar file up to its last committed footer, leaving out what an append in progress or an interrupted
+    // one has written past it. Never writes to the file.
+    static MappedFile OpenFile(const std::filesystem::path& path);
+
    private:
-    static ColumnarMetadata ReadFileMetadata(const std::filesystem::path& path);
+    static ColumnarMetadata ReadFileMetadata(const MappedFile& input);
 
     std::filesystem::path path_;
-    InputFile input_;
+    MappedFile input_;
 
     ColumnarMetadata metadata_;
     size_t next_group_ = 0;
 };
 
+inline constexpr uint32_t DefaultPageRows = 1024;
+
+struct ColumnarWriteOptions {
+    Compression compression = Compression::None;
+    int compression_level = DefaultCompressionLevel;
+
+    // When set, each chunk's codec is chosen from a sample instead of using compression/compression_level.
+    std::optional<CodecSelection> adaptive_codec = std::nullopt;
+
+    // Stores a chunk with a lightweight encoding (dictionary, bit-packing, runs, deltas) when that is smaller than
+    // the plain layout.
+    bool lightweight_encoding = true;
+
+    // Rows covered by each page zone map inside a chunk; 0 keeps only the chunk-level min/max.
+    uint32_t page_rows = DefaultPageRows;
+
+    // Columns whose chunks get a Bloom filter for equality and IN pruning; worth it for high-cardinality keys that
+    // min/max cannot rule out.
+    std::vector<std::string> bloom_filter_columns = {};
+
+    // Columns whose chunks carry a HyperLogLog sketch, so APPROX_COUNT_DISTINCT can be answered from metadata.
+    std::vector<std::string> distinct_sketch_columns = {};
+
+    // Threads encoding, compressing and summarizing the columns of a row group; 0 uses the hardware concurrency and 1
+    // does all of it on the calling thread. Chunks are written in column order either way.
+    size_t encode_threads = 0;
+
+    // Append adds row groups to an existing file with the same schema (a missing file is created) and writes only them
+    // and a new footer, so the cost follows the new data rather than the file size. The old footer stays behind as
+    // dead bytes until the file is compacted.
+    FileOpenMode open_mode = FileOpenMode::Truncate;
+};
+
+// A row group encoded and compressed but not yet in the file; WriteEncoded fills in the chunk offsets.
+struct EncodedRowGroup {
+    RowGroupMetadata metadata;
+    std::vector<std::vector<uint8_t>> payloads;
+};
+
 class ColumnarBatchWriter final : public BatchWriter {
    public:
-    ColumnarBatchWriter(const std::filesystem::path& path, Schema schema, Compression compression = Compression::None);
+    ColumnarBatchWriter(const std::filesystem::path& path, Schema schema, Compression compression = Compression::None,
+                        int compression_level = DefaultCompressionLevel);
+    ColumnarBatchWriter(const std::filesystem::path& path, Schema schema, ColumnarWriteOptions options);
     ColumnarBatchWriter(const ColumnarBatchWriter&) = delete;
     ColumnarBatchWriter(ColumnarBatchWriter&&) noexcept = default;
     ColumnarBatchWriter& operator=(const ColumnarBatchWriter&) = delete;
-    ColumnarBatchWriter& operator=(ColumnarBatchWriter&&) noexcept = default;
-    ~ColumnarBatchWriter() override = default;
+    // Deleted: taking over another writer would drop this one's unfinished append without rolling it back.
+    ColumnarBatchWriter& operator=(ColumnarBatchWriter&&) = delete;
+    // Rolls back an append that was never finalized.
+    ~ColumnarBatchWriter() override;
 
     void Write(const Batch& batch) override;
     void Flush() override;
 
+    // Write split in two, so row groups can be encoded on several threads at once and written in order. With
+    // adaptive file-scope codecs the choice comes from whichever row group reaches a column first.
+    EncodedRowGroup Encode(const Batch& batch);
+    void WriteEncoded(EncodedRowGroup row_group);
+
     void Finalize() &;
     void Finalize() &&;
 
     const ColumnarMetadata& GetMetadata() const { return metadata_; }
 
    private:
+    void OpenForAppend();
+    CodecChoice ChooseChunkCodec(size_t column_index, std::span<const uint8_t> serialized);
+    ColumnChunkMetadata EncodeChunk(const Column& column, size_t column_index, std::vector<uint8_t>& payload);
+
     std::filesystem::path path_;
     std::ofstream out_;
+    // Journal of the append in progress, locked for as long as the append runs; empty when the file was created.
+    std::filesystem::path journal_path_;
+    std::unique_ptr<FileLock> journal_lock_;
 
     ColumnarMetadata metadata_;
-    Compression compression_ = Compression::None;
+    ColumnarWriteOptions options_;
+    std::vector<std::optional<CodecChoice>> file_codecs_;
+    std::unique_ptr<std::mutex> file_codecs_mutex_ = std::make_unique<std::mutex>();
+    std::vector<bool> bloom_filter_columns_;
+    std::vector<bool> distinct_sketch_columns_;
+    std::unique_ptr<ThreadPool> encode_pool_;
     bool finalized_ = false;
 };
 
-std::vector<uint8_t> ReadColumnChunk(const std::filesystem::path& path, InputFile& input,
-                                     const ColumnChunkMetadata& chunk);
-void ReadBatchColumnChunk(const std::filesystem::path& path, InputFile& input, const ColumnChunkMetadata& chunk,
-                          uint32_t row_count, const Batch& batch, size_t column_index);
+// An append keeps the size the file had before it in `<path>.append` until the new footer is synced, and readers stop
+// there while the journal exists. When an interrupted append left it behind, cuts the file back to that size, unless
+// the new footer had already been synced, and removes the journal. Called by every append and in-place compaction, or
+// directly to repair a file; returns false, leaving the file alone, while a running append holds the journal.
+bool RollBackInterruptedAppend(const std::filesystem::path& path);
+
+std::vector<uint8_t> ReadColumnChunk(const MappedFile& input, const ColumnChunkMetadata& chunk);
+void DecodeBatchColumnChunk(std::span<const uint8_t> raw, const ColumnChunkMetadata& chunk, uint32_t row_count,
+                            Batch& batch, size_t column_index);
+// Fills the column straight from the chunk statistics when they determine every value (e.g. all strings empty);
+// returns false when the chunk has to be read.
+bool MaterializeFromStatistics(const ColumnChunkMetadata& chunk, uint32_t row_count, Batch& batch,
+                               size_t column_index);
+// The same for a read of only `output_rows` of the chunk's rows.
+bool MaterializeFromStatistics(const ColumnChunkMetadata& chunk, uint32_t row_count, size_t output_rows, Batch& batch,
+                               size_t column_index);
+void ReadBatchColumnChunk(const MappedFile& input, const ColumnChunkMetadata& chunk, uint32_t row_count,
+                          Batch& batch, size_t column_index);
+
+struct RowRange {
+    size_t begin = 0;
+    size_t count = 0;
+};
+
+size_t RangeRows(std::span<const RowRange> ranges);
+
+// Bytes per row of a plain fixed-width chunk, whose rows can be addressed without decoding; nullopt for other chunks.
+std::optional<uint64_t> PlainRowWidth(const ColumnChunkMetadata& chunk, uint32_t row_count);
+
+// Like DecodeBatchColumnChunk, but appends only the rows of the ascending, disjoint ranges. Rows of plain fixed-width
+// chunks are copied range by range, so the pages of an uncompressed chunk outside the ranges are never touched; other
+// chunks are decoded whole first.
+void DecodeBatchColumnChunkRanges(std::span<const uint8_t> raw, const ColumnChunkMetadata& chunk, uint32_t row_count,
+                                  std::span<const RowRange> ranges, Batch& batch, size_t column_index);
+void ReadBatchColumnChunkRanges(const MappedFile& input, const ColumnChunkMetadata& chunk, uint32_t row_count,
+                                std::span<const RowRange> ranges, Batch& batch, size_t column_index);
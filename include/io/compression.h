@@ -8,10 +8,19 @@
 enum class Compression : uint8_t {
     None = 0,
     Lz4 = 1,
+    Zstd = 2,
+    Lz4Hc = 3,
 };
 
+// Selects the codec's own default level; levels are ignored by None and Lz4.
+inline constexpr int DefaultCompressionLevel = 0;
+
 const char* CompressionName(Compression compression);
 Compression CompressionFromName(std::string_view name);
 
-std::vector<uint8_t> Compress(std::span<const uint8_t> input, Compression compression);
+void ValidateCompressionLevel(Compression compression, int level);
+
+std::vector<uint8_t> Compress(std::span<const uint8_t> input, Compression compression,
+                              int level = DefaultCompressionLevel);
+void DecompressInto(std::span<const uint8_t> input, Compression compression, std::span<uint8_t> output);
 std::vector<uint8_t> Decompress(std::span<const uint8_t> input, Compression compression, uint64_t uncompressed_size);
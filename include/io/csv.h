@@ -1,30 +1,72 @@
 #pragma once
 
+#include <cstdint>
 #include <filesystem>
 #include <fstream>
 #include <iosfwd>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
+#include "io/csv_scan.h"
+
 class CsvReader {
    public:
     explicit CsvReader(std::istream& in);
     explicit CsvReader(const std::filesystem::path& path);
+    // Reads only bytes [begin, end) of the file, which should start at a row.
+    CsvReader(const std::filesystem::path& path, uint64_t begin, uint64_t end);
     CsvReader(const CsvReader&) = delete;
     CsvReader(CsvReader&& other) noexcept;
     CsvReader& operator=(const CsvReader&) = delete;
     CsvReader& operator=(CsvReader&& other) noexcept;
     ~CsvReader() = default;
 
-    bool ReadRow(std::vector<std::string>& row) const;
+    bool ReadRow(std::vector<std::string>& row);
+    // The fields point into the reader's buffer and stay valid until the next read.
+    bool ReadRow(std::vector<std::string_view>& row);
+    // Reads up to max_rows rows of `columns` fields each into `fields`, one row after another, but stops before
+    // refilling the buffer once it has a row. Returns the rows read, 0 only at the end of input; the fields stay valid
+    // until the next read.
+    size_t ReadRows(std::vector<std::string_view>& fields, size_t columns, size_t max_rows);
+
+    // Whether a quote that neither opened, closed nor escaped a quoted value was read, such as the one in `ab"c`. Until
+    // then, the quotes read so far having even count means being outside a quoted value.
+    bool SawStrayQuotes() const { return stray_quotes_; }
 
    private:
+    // Where a field's value lives: a span of the buffer, or of unescaped_ when quotes had to be removed from within.
+    struct FieldSpan {
+        size_t offset = 0;
+        size_t size = 0;
+        bool unescaped = false;
+    };
+
     void RebindAfterMove(bool uses_owned_stream, std::istream* source_stream) noexcept;
+    bool Refill();
+    bool ParseRow(bool at_eof);
+    void AppendFieldViews(std::vector<std::string_view>& views) const;
+    std::optional<size_t> ParseField(CsvStructureScanner& scanner, size_t begin, bool at_eof);
 
     std::ifstream owned_in_;
     std::istream* in_ = nullptr;
+
+    // Input is read in large blocks and rows are parsed in place; buffer_[begin_, end_) is not parsed yet.
+    std::vector<char> buffer_;
+    size_t begin_ = 0;
+    size_t end_ = 0;
+    uint64_t remaining_ = UINT64_MAX;
+    bool stray_quotes_ = false;
+
+    std::vector<FieldSpan> fields_;
+    std::string unescaped_;
+    std::vector<std::string_view> views_;
 };
 
+// Appends `value` as one CSV field: as is, or quoted with its quotes doubled when NeedsCsvQuotes.
+void AppendCsvField(std::string& out, std::string_view value);
+
 class CsvWriter {
    public:
     explicit CsvWriter(std::ostream& out);
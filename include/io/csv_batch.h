@@ -1,15 +1,26 @@
 #pragma once
 
+#include <cstdint>
+#include <deque>
 #include <filesystem>
+#include <memory>
 #include <optional>
+#include <span>
+#include <string>
+#include <string_view>
 #include <vector>
 
 #include "io/batch.h"
 #include "io/csv.h"
+#include "io/csv_chunks.h"
+#include "io/csv_format.h"
+#include "io/file.h"
 
 class CsvBatchReader final : public BatchReader {
    public:
     CsvBatchReader(const std::filesystem::path& path, Schema schema, BatchSizing sizing);
+    // Reads rows from `reader`, which must outlive this one.
+    CsvBatchReader(CsvReader& reader, Schema schema, BatchSizing sizing);
     CsvBatchReader(const CsvBatchReader&) = delete;
     CsvBatchReader(CsvBatchReader&&) noexcept = default;
     CsvBatchReader& operator=(const CsvBatchReader&) = delete;
@@ -21,30 +32,91 @@ class CsvBatchReader final : public BatchReader {
     const Schema& GetSchema() const { return schema_; }
 
    private:
-    CsvReader csv_reader_;
+    // Appends fields to one column of a batch through the concrete column type, so parsing needs no virtual call.
+    struct FieldDecoder {
+        MutableColumn* column = nullptr;
+        void (*append)(MutableColumn& column, std::span<const std::string_view> values) = nullptr;
+    };
+
+    Batch StartBatch(std::vector<FieldDecoder>& decoders) const;
+
+    std::unique_ptr<CsvReader> owned_reader_;
+    CsvReader* csv_reader_ = nullptr;
 
     Schema schema_;
     BatchSizing sizing_;
 
-    std::optional<std::vector<std::string>> pending_row_;
+    std::vector<std::string_view> fields_;
+    std::vector<std::string_view> column_fields_;
+    // The row that did not fit the previous batch, already decoded into the next one.
+    std::optional<Batch> next_batch_;
+    std::vector<FieldDecoder> next_decoders_;
+    uint64_t next_bytes_ = 0;
     bool reached_eof_ = false;
 };
 
+// Parses chunks of the file on several threads and returns their batches in file order. The last batch of a chunk is
+// topped up with rows from the first batch of the next one, so a chunk boundary leaves at most one batch smaller than
+// `sizing` allows. A file with stray quotes (see CsvReader::SawStrayQuotes) is read on one thread from the first chunk
+// that has them.
+class ParallelCsvBatchReader final : public BatchReader {
+   public:
+    ParallelCsvBatchReader(const std::filesystem::path& path, Schema schema, BatchSizing sizing,
+                           const CsvParallelOptions& options = {});
+    ParallelCsvBatchReader(const ParallelCsvBatchReader&) = delete;
+    ParallelCsvBatchReader& operator=(const ParallelCsvBatchReader&) = delete;
+    ~ParallelCsvBatchReader() override = default;
+
+    std::optional<Batch> ReadNext() override;
+
+    const Schema& GetSchema() const { return schema_; }
+
+   private:
+    struct ParsedBatch {
+        Batch batch;
+        bool ends_chunk = false;
+    };
+
+    bool FillReady();
+    size_t TopUpCarry(const Batch& next);
+    uint64_t RowsBytes(const Batch& batch, size_t begin, size_t end) const;
+
+    Schema schema_;
+    BatchSizing sizing_;
+    CsvChunkParser<std::vector<Batch>> chunks_;
+    std::deque<ParsedBatch> ready_;
+    // The last batch of a chunk, held back until the first batch of the next one has topped it up.
+    std::optional<Batch> carry_;
+    uint64_t carry_bytes_ = 0;
+
+    std::optional<CsvReader> remainder_;
+    std::optional<CsvBatchReader> remainder_batches_;
+};
+
+// Formats each batch a block of rows and a column at a time (see FormatCsvColumn), interleaves the fields into rows in
+// a large buffer and writes that to the file in big blocks. The destructor writes what is still buffered and closes the
+// file but swallows any error, so call Finalize to find out whether everything reached the file.
 class CsvBatchWriter final : public BatchWriter {
    public:
     CsvBatchWriter(const std::filesystem::path& path, Schema schema);
     CsvBatchWriter(const CsvBatchWriter&) = delete;
     CsvBatchWriter(CsvBatchWriter&&) noexcept = default;
     CsvBatchWriter& operator=(const CsvBatchWriter&) = delete;
-    CsvBatchWriter& operator=(CsvBatchWriter&&) noexcept = default;
-    ~CsvBatchWriter() override = default;
+    // Would drop the rows still buffered for the file being replaced.
+    CsvBatchWriter& operator=(CsvBatchWriter&&) = delete;
+    ~CsvBatchWriter() override;
 
     void Write(const Batch& batch) override;
     void Flush() override;
+    // Flushes and closes the file, reporting a write error that only shows up on close.
+    void Finalize();
 
    private:
-    CsvWriter csv_writer_;
+    OutputFile out_;
     Schema schema_;
+
+    std::string buffer_;
+    std::vector<CsvColumnText> columns_;
 };
 
 void AppendBatchRows(const Batch& batch, std::vector<std::vector<std::string>>& rows);
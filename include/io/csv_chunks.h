@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "common/thread_pool.h"
+#include "io/csv.h"
+
+inline constexpr uint64_t DefaultCsvChunkBytes = 32 << 20;
+
+struct CsvParallelOptions {
+    // Chunks parsed at once; 0 uses the hardware concurrency.
+    size_t threads = 0;
+    uint64_t chunk_bytes = DefaultCsvChunkBytes;
+};
+
+struct CsvChunk {
+    uint64_t begin = 0;
+    uint64_t end = 0;
+};
+
+// Splits the file into ranges of about chunk_bytes that each start at a row. Whether a split point falls inside a
+// quoted value (which may hold line breaks) is decided from the parity of the quotes before it, counted on `pool`.
+// That is exact unless the file has stray quotes, which a reader of the chunk reports through SawStrayQuotes.
+std::vector<CsvChunk> SplitCsvFile(const std::filesystem::path& path, uint64_t chunk_bytes, ThreadPool& pool);
+
+// Runs `parse` over the chunks of a CSV file on a pool and hands the results back in file order, with at most one chunk
+// per thread in flight. When a chunk turns out to have stray quotes, the split after it cannot be trusted: Next then
+// stops, and TakeRemainder gives a reader over the rest of the file from that chunk's start.
+template <class Result>
+class CsvChunkParser {
+   public:
+    using Parse = std::function<Result(CsvReader&)>;
+
+    CsvChunkParser(std::filesystem::path path, const CsvParallelOptions& options, Parse parse)
+        : path_(std::move(path)),
+          parse_(std::move(parse)),
+          pool_(options.threads == 0 ? ThreadPool::DefaultThreadCount() : options.threads) {
+        chunks_ = SplitCsvFile(path_, options.chunk_bytes, pool_);
+        SubmitChunks();
+    }
+
+    CsvChunkParser(const CsvChunkParser&) = delete;
+    CsvChunkParser& operator=(const CsvChunkParser&) = delete;
+
+    ~CsvChunkParser() { WaitPending(); }
+
+    std::optional<Result> Next() {
+        if (pending_.empty()) {
+            return std::nullopt;
+        }
+
+        ChunkOutcome outcome = pending_.front().get();
+        pending_.pop_front();
+        const CsvChunk chunk = chunks_[next_result_++];
+
+        if (outcome.stray_quotes) {
+            WaitPending();
+            next_chunk_ = chunks_.size();
+            remainder_.emplace(path_, chunk.begin, chunks_.back().end);
+            return std::nullopt;
+        }
+        if (outcome.error) {
+            std::rethrow_exception(outcome.error);
+        }
+
+        SubmitChunks();
+        return std::move(outcome.result);
+    }
+
+    std::optional<CsvReader> TakeRemainder() { return std::exchange(remainder_, std::nullopt); }
+
+   private:
+    struct ChunkOutcome {
+        std::optional<Result> result;
+        std::exception_ptr error;
+        bool stray_quotes = false;
+    };
+
+    void SubmitChunks() {
+        while (next_chunk_ < chunks_.size() && pending_.size() < pool_.ThreadCount()) {
+            pending_.push_back(pool_.Submit([this, chunk = chunks_[next_chunk_]] {
+                CsvReader reader(path_, chunk.begin, chunk.end);
+                ChunkOutcome outcome;
+                try {
+                    outcome.result = parse_(reader);
+                } catch (...) {
+                    outcome.error = std::current_exception();
+                }
+                outcome.stray_quotes = reader.SawStrayQuotes();
+                return outcome;
+            }));
+            ++next_chunk_;
+        }
+    }
+
+    void WaitPending() {
+        for (const auto& pending : pending_) {
+            pending.wait();
+        }
+        pending_.clear();
+    }
+
+    std::filesystem::path path_;
+    Parse parse_;
+    std::vector<CsvChunk> chunks_;
+    size_t next_chunk_ = 0;
+    size_t next_result_ = 0;
+    std::deque<std::future<ChunkOutcome>> pending_;
+    std::optional<CsvReader> remainder_;
+    ThreadPool pool_;
+};
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "model/column.h"
+
+// The fields of one column as CSV text, quoted where needed: field i is text[ends[i - 1], ends[i]) (from 0 for i = 0).
+struct CsvColumnText {
+    std::string text;
+    std::vector<size_t> ends;
+};
+
+// Formats rows [begin, begin + count) of a column at once, so the type is resolved per column rather than per value:
+// fixed-width values are written from the typed array with to_chars and digit-pair tables. The text of each field is
+// what ValueAsString gives, escaped as CsvWriter would write it.
+void FormatCsvColumn(const Column& column, size_t begin, size_t count, CsvColumnText& out);
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+inline constexpr char CsvDelimiter = ',';
+inline constexpr char CsvQuote = '"';
+inline constexpr char CsvLf = '\n';
+inline constexpr char CsvCr = '\r';
+
+inline constexpr size_t CsvBlockBytes = 64;
+
+// Bit i describes data[i]: `quotes` marks quote characters and `separators` marks delimiters, LF and CR.
+struct CsvBlockMasks {
+    uint64_t quotes = 0;
+    uint64_t separators = 0;
+};
+
+// Classifies the first min(size, CsvBlockBytes) bytes of `data`, with AVX2 or SSE2 on x86-64 and a scalar loop
+// elsewhere and for a short last block.
+CsvBlockMasks ScanCsvBlock(const char* data, size_t size);
+
+// Whether `value` holds a delimiter, quote or line break, and so has to be written quoted; checked a block at a time.
+bool NeedsCsvQuotes(std::string_view value);
+
+// Walks the structural characters of data[begin, end) in order, classifying one block at a time.
+class CsvStructureScanner {
+   public:
+    CsvStructureScanner(const char* data, size_t begin, size_t end) : data_(data), begin_(begin), end_(end) {}
+
+    // Position of the first quote (or, unless quotes_only, separator) at or after `pos`; `end` when there is none.
+    size_t Next(size_t pos, bool quotes_only);
+
+   private:
+    const char* data_;
+    size_t begin_;
+    size_t end_;
+    size_t block_ = SIZE_MAX;
+    CsvBlockMasks masks_;
+};
@@ -1,11 +1,14 @@
 #pragma once
 
 #include <concepts>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
+#include <memory>
 #include <optional>
 #include <span>
 #include <string>
+#include <string_view>
 #include <vector>
 
 struct FileMetadata {
@@ -51,6 +54,40 @@ class InputFile {
     std::ifstream in_;
 };
 
+class MappedFile {
+   public:
+    explicit MappedFile(std::filesystem::path path);
+    // Maps only the first `length` bytes, which the file must have.
+    MappedFile(std::filesystem::path path, uint64_t length);
+    MappedFile(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    ~MappedFile();
+
+    const std::filesystem::path& Path() const { return path_; }
+    uint64_t Size() const { return size_; }
+
+    std::span<const uint8_t> ReadAt(uint64_t offset, uint64_t size) const;
+
+    template <std::integral T>
+    T ReadAt(const uint64_t offset) const {
+        T value = 0;
+        std::memcpy(&value, ReadAt(offset, sizeof(value)).data(), sizeof(value));
+        return value;
+    }
+
+   private:
+    MappedFile(std::filesystem::path path, std::optional<uint64_t> length);
+
+    void Unmap() noexcept;
+
+    std::filesystem::path path_;
+
+    const uint8_t* data_ = nullptr;
+    uint64_t size_ = 0;
+};
+
 enum class FileOpenMode {
     Truncate,
     Append,
@@ -58,6 +95,55 @@ enum class FileOpenMode {
 
 std::ofstream OpenOutputFile(const std::filesystem::path& path, FileOpenMode mode = FileOpenMode::Truncate);
 
+// A file created (or truncated) for writing with write(2) straight from the caller's buffer, for output that is
+// already assembled in large blocks.
+class OutputFile {
+   public:
+    explicit OutputFile(std::filesystem::path path);
+    OutputFile(const OutputFile&) = delete;
+    OutputFile(OutputFile&& other) noexcept;
+    OutputFile& operator=(const OutputFile&) = delete;
+    OutputFile& operator=(OutputFile&& other) noexcept;
+    ~OutputFile();
+
+    const std::filesystem::path& Path() const { return path_; }
+
+    void Write(std::string_view bytes);
+    // Closes the file and reports a write error that close(2) only learns of now (NFS, quotas). The destructor closes
+    // it too, but ignores any error.
+    void Close();
+
+   private:
+    void CloseQuietly() noexcept;
+
+    std::filesystem::path path_;
+    int fd_ = -1;
+};
+
+// fsync, for files whose contents must be durable before a later step relies on them.
+void SyncFile(const std::filesystem::path& path);
+// fsync of the directory holding `path`, so that creating, renaming or removing it is durable.
+void SyncParentDirectory(const std::filesystem::path& path);
+
+// Exclusive advisory flock(2) on a file, held until the object is destroyed. It also excludes other opens of the file
+// within this process.
+class FileLock {
+   public:
+    // Null when the lock is held elsewhere, or when the file is gone or was replaced while being locked.
+    static std::unique_ptr<FileLock> TryAcquire(const std::filesystem::path& path);
+
+    FileLock(const FileLock&) = delete;
+    FileLock(FileLock&&) = delete;
+    FileLock& operator=(const FileLock&) = delete;
+    FileLock& operator=(FileLock&&) = delete;
+    ~FileLock();
+
+   private:
+    explicit FileLock(int fd) : fd_(fd) {}
+
+    int fd_ = -1;
+};
+
 std::string ReadTextFile(const std::filesystem::path& path);
 std::vector<uint8_t> ReadFileBytes(const std::filesystem::path& path);
 void WriteFileBytes(const std::filesystem::path& path, std::span<const uint8_t> bytes);
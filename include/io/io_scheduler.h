@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <vector>
+
+constexpr size_t DefaultIoQueueDepth = 64;
+
+struct IoReadRequest {
+    uint64_t offset = 0;
+    std::span<uint8_t> buffer;
+};
+
+enum class IoBackend {
+    Auto,
+    Preadv,
+    IoUring,
+};
+
+class IoScheduler {
+   public:
+    using Ticket = uint64_t;
+
+    IoScheduler() = default;
+    IoScheduler(const IoScheduler&) = delete;
+    IoScheduler(IoScheduler&&) = delete;
+    IoScheduler& operator=(const IoScheduler&) = delete;
+    IoScheduler& operator=(IoScheduler&&) = delete;
+    virtual ~IoScheduler() = default;
+
+    virtual IoBackend Backend() const = 0;
+
+    // Starts all reads of the batch; buffers must stay alive until Wait() returns for the ticket.
+    virtual Ticket Submit(std::vector<IoReadRequest> requests) = 0;
+    virtual void Wait(Ticket ticket) = 0;
+};
+
+const char* IoBackendName(IoBackend backend);
+IoBackend IoBackendFromName(std::string_view name);
+bool IoUringAvailable();
+
+std::unique_ptr<IoScheduler> CreateIoScheduler(const std::filesystem::path& path, IoBackend backend = IoBackend::Auto,
+                                               size_t queue_depth = DefaultIoQueueDepth);
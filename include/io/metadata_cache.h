@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "model/metadata.h"
+
+inline constexpr size_t DefaultMetadataCacheBytes = size_t{64} << 20;
+
+// Footers shared by the planner and operators; an entry is reused while the file keeps its size and modification
+// time. Each entry owns a flat copy of the footer bytes, converted once for footers written before that layout, and
+// the least recently used entries are dropped once the footers exceed the capacity.
+class MetadataCache {
+   public:
+    explicit MetadataCache(size_t capacity_bytes = DefaultMetadataCacheBytes);
+
+    static MetadataCache& Instance();
+
+    std::shared_ptr<const MetadataView> Get(const std::filesystem::path& path);
+    void Clear();
+
+    size_t Size() const;
+
+   private:
+    struct Entry {
+        uintmax_t size = 0;
+        std::filesystem::file_time_type last_write_time;
+        std::shared_ptr<const MetadataView> metadata;
+        size_t footer_bytes = 0;
+        std::list<std::string>::iterator recency;
+    };
+
+    void Evict();
+
+    size_t capacity_bytes_ = 0;
+
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, Entry> entries_;
+    // Keys from the most to the least recently used.
+    std::list<std::string> recency_;
+    size_t footer_bytes_ = 0;
+};
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+constexpr std::string_view TableManifestExtension = ".manifest";
+
+struct TableFile {
+    std::filesystem::path path;
+    // Hive-style `key=value` directories between the table root and the file, outermost first.
+    std::vector<std::pair<std::string, std::string>> partition_values;
+};
+
+// A table is a single columnar file, a directory of them searched recursively (names starting with '.' or '_' are
+// skipped, and the files come back sorted by path), or a `.manifest` text file listing one file per line relative to
+// the manifest, kept in that order.
+std::vector<TableFile> ListTableFiles(const std::filesystem::path& path);
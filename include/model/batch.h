@@ -3,6 +3,7 @@
 #include <cstdint>
 #include <iosfwd>
 #include <memory>
+#include <optional>
 #include <span>
 #include <string>
 #include <string_view>
@@ -30,17 +31,24 @@ class Batch {
     void Reserve(size_t n) const;
     void AppendValueFromString(size_t column_index, std::string_view value) const;
     void AppendValueFromColumn(size_t column_index, const Column& source, size_t row) const;
-    void AppendColumnRange(size_t column_index, const Column& source, size_t begin, size_t count) const;
-    void AppendColumnSelected(size_t column_index, const Column& source, std::span<const size_t> rows) const;
-    void AppendRowsRangeFromBatch(const Batch& source, size_t begin, size_t count) const;
-    void AppendRowsSelectedFromBatch(const Batch& source, std::span<const size_t> rows) const;
+    void AppendColumnRange(size_t column_index, const Column& source, size_t begin, size_t count);
+    void AppendColumnSelected(size_t column_index, const Column& source, std::span<const size_t> rows);
+    void AppendRowsRangeFromBatch(const Batch& source, size_t begin, size_t count);
+    void AppendRowsSelectedFromBatch(const Batch& source, std::span<const size_t> rows);
     void ReadColumnFrom(size_t column_index, std::istream& in, uint32_t row_count, uint64_t size) const;
+    void ReadColumnFrom(size_t column_index, std::span<const uint8_t> bytes, uint32_t row_count) const;
+    std::optional<std::span<uint8_t>> PrepareColumnRawRead(size_t column_index, uint32_t row_count,
+                                                           uint64_t size) const;
+    void SetColumn(size_t column_index, std::unique_ptr<MutableColumn> column);
 
     const Column& ColumnAt(size_t i) const;
 
     void Validate() const;
 
    private:
+    // Lets an empty column switch to the source's representation (e.g. keep dictionary codes) before a bulk append.
+    void AdoptCompatibleColumn(size_t column_index, const Column& source);
+
     Schema schema_;
 
     std::vector<std::unique_ptr<MutableColumn>> columns_;
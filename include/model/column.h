@@ -3,6 +3,7 @@
 #include <cstdint>
 #include <iosfwd>
 #include <memory>
+#include <optional>
 #include <span>
 #include <string>
 #include <string_view>
@@ -21,6 +22,8 @@ enum class ValueComparison {
     GreaterOrEqual,
 };
 
+class MutableColumn;
+
 class Column {
    public:
     explicit Column(ColumnType type);
@@ -44,6 +47,9 @@ class Column {
     virtual void AppendEncodedValue(size_t row, std::string& out) const;
     virtual std::unique_ptr<Column> Clone() const = 0;
 
+    // Empty column that takes rows from this one without re-encoding them, or nullptr when CreateColumn(Type()) does.
+    virtual std::unique_ptr<MutableColumn> CreateCompatibleColumn() const;
+
     virtual void WriteTo(std::ostream& out) const = 0;
 
    protected:
@@ -62,11 +68,18 @@ class MutableColumn : public Column {
     virtual void Clear() = 0;
 
     virtual void AppendFromString(std::string_view value) = 0;
+    virtual void AppendFromStrings(std::span<const std::string_view> values);
     virtual void AppendFromColumn(const Column& source, size_t row) = 0;
     virtual void AppendRangeFromColumn(const Column& source, size_t begin, size_t count) = 0;
     virtual void AppendSelectedFromColumn(const Column& source, std::span<const size_t> rows) = 0;
 
     virtual void ReadFrom(std::istream& in, uint32_t row_count, uint64_t size) = 0;
+    virtual void ReadFrom(std::span<const uint8_t> bytes, uint32_t row_count) = 0;
+
+    // Resizes the column to row_count and exposes its storage when the encoded chunk is the raw value array.
+    virtual std::optional<std::span<uint8_t>> PrepareRawRead(uint32_t row_count, uint64_t size);
+    // Row boundaries of equal-value runs, kept by columns that can evaluate filters a run at a time.
+    virtual void SetRunEnds(std::vector<uint32_t> run_ends);
 
     virtual std::unique_ptr<MutableColumn> CloneMutable() const = 0;
 };
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "common/string_arena.h"
+#include "model/column.h"
+
+// String column stored as codes into a dictionary that is shared with columns cut from it (filters, projections),
+// so predicates and group keys can work per distinct value instead of per row.
+class DictionaryStringColumn final : public MutableColumn {
+   public:
+    using Dictionary = std::vector<std::string>;
+
+    DictionaryStringColumn();
+    explicit DictionaryStringColumn(std::shared_ptr<const Dictionary> dictionary);
+    DictionaryStringColumn(const DictionaryStringColumn& other);
+    DictionaryStringColumn(DictionaryStringColumn&&) noexcept = default;
+    DictionaryStringColumn& operator=(const DictionaryStringColumn& other);
+    DictionaryStringColumn& operator=(DictionaryStringColumn&&) noexcept = default;
+    ~DictionaryStringColumn() override = default;
+
+    static const char* ModuleName() { return "column_dictionary_string"; }
+
+    const std::shared_ptr<const Dictionary>& GetDictionary() const { return dictionary_; }
+    std::span<const uint32_t> Codes() const { return codes_; }
+    std::string_view ValueAt(size_t row) const;
+
+    size_t Size() const override;
+    void Reserve(size_t n) override;
+    void Clear() override;
+
+    void AppendFromString(std::string_view value) override;
+    void AppendRepeated(std::string_view value, size_t count);
+    void AppendFromColumn(const Column& source, size_t row) override;
+    void AppendRangeFromColumn(const Column& source, size_t begin, size_t count) override;
+    void AppendSelectedFromColumn(const Column& source, std::span<const size_t> rows) override;
+    std::string ValueAsString(size_t row) const override;
+    void SelectRowsByStringSet(const std::unordered_set<std::string>& values, std::vector<size_t>& rows) const override;
+    void SelectRowsByLikePattern(std::string_view pattern, bool negated, std::vector<size_t>& rows) const override;
+    void AppendEncodedValue(size_t row, std::string& out) const override;
+
+    std::unique_ptr<Column> Clone() const override;
+    std::unique_ptr<MutableColumn> CloneMutable() const override;
+    std::unique_ptr<MutableColumn> CreateCompatibleColumn() const override;
+
+    // WriteTo/ReadFrom use the plain string chunk layout; the dictionary layout has its own pair.
+    void WriteTo(std::ostream& out) const override;
+    void ReadFrom(std::istream& in, uint32_t row_count, uint64_t size) override;
+    void ReadFrom(std::span<const uint8_t> bytes, uint32_t row_count) override;
+
+    void WriteDictionaryTo(std::vector<uint8_t>& out) const;
+    void ReadDictionaryFrom(std::span<const uint8_t> bytes, uint32_t row_count);
+
+   private:
+    using DictionaryIndex = std::unordered_map<std::string, uint32_t, StringViewHash, StringViewEqual>;
+
+    // Returns the source when its codes can be copied as is, adopting its dictionary if this column is empty.
+    const DictionaryStringColumn* SharedDictionarySource(const Column& source);
+    uint32_t Intern(std::string_view value);
+
+    std::shared_ptr<const Dictionary> dictionary_;
+    std::vector<uint32_t> codes_;
+
+    // Set while this column is the only owner of dictionary_ and may extend it in place.
+    std::shared_ptr<Dictionary> owned_;
+    // Built on the first append of a value that does not come with a code for this dictionary.
+    DictionaryIndex index_;
+};
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <span>
 #include <string>
 #include <string_view>
@@ -19,11 +20,14 @@ class StringColumn final : public MutableColumn {
 
     static const char* ModuleName() { return "column_string"; }
 
+    std::string_view ValueAt(size_t row) const;
+
     size_t Size() const override;
     void Reserve(size_t n) override;
     void Clear() override;
 
     void AppendFromString(std::string_view value) override;
+    void AppendFromStrings(std::span<const std::string_view> values) override;
     void AppendFromColumn(const Column& source, size_t row) override;
     void AppendRangeFromColumn(const Column& source, size_t begin, size_t count) override;
     void AppendSelectedFromColumn(const Column& source, std::span<const size_t> rows) override;
@@ -37,7 +41,13 @@ class StringColumn final : public MutableColumn {
 
     void WriteTo(std::ostream& out) const override;
     void ReadFrom(std::istream& in, uint32_t row_count, uint64_t size) override;
+    void ReadFrom(std::span<const uint8_t> bytes, uint32_t row_count) override;
 
    private:
-    std::vector<std::string> values_;
+    std::string_view StoredValue(size_t row) const;
+    void AppendStoredValue(std::string_view value);
+
+    // Values are stored back to back in bytes_, so appending one does not allocate it a string of its own.
+    std::string bytes_;
+    std::vector<uint64_t> ends_;
 };
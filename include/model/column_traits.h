@@ -1,6 +1,8 @@
 #pragma once
 
 #include <cstdint>
+#include <optional>
+#include <span>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -26,6 +28,10 @@ struct ColumnValueTraits<ColumnType::Int16> {
     using Type = int16_t;
 
     static Type Parse(const std::string_view value) { return ParseInt16(value); }
+    static std::optional<size_t> TryParseMany(const std::span<const std::string_view> values,
+                                              const std::span<Type> out) {
+        return TryParseInt16s(values, out);
+    }
     static std::string ToString(const Type value) { return std::to_string(value); }
 };
 
@@ -34,6 +40,10 @@ struct ColumnValueTraits<ColumnType::Int32> {
     using Type = int32_t;
 
     static Type Parse(const std::string_view value) { return ParseInt32(value); }
+    static std::optional<size_t> TryParseMany(const std::span<const std::string_view> values,
+                                              const std::span<Type> out) {
+        return TryParseInt32s(values, out);
+    }
     static std::string ToString(const Type value) { return std::to_string(value); }
 };
 
@@ -42,6 +52,10 @@ struct ColumnValueTraits<ColumnType::Int64> {
     using Type = int64_t;
 
     static Type Parse(const std::string_view value) { return ParseInt64(value); }
+    static std::optional<size_t> TryParseMany(const std::span<const std::string_view> values,
+                                              const std::span<Type> out) {
+        return TryParseInt64s(values, out);
+    }
     static std::string ToString(const Type value) { return std::to_string(value); }
 };
 
@@ -58,6 +72,10 @@ struct ColumnValueTraits<ColumnType::Date> {
     using Type = int32_t;
 
     static Type Parse(const std::string_view value) { return ParseDate(value); }
+    static std::optional<size_t> TryParseMany(const std::span<const std::string_view> values,
+                                              const std::span<Type> out) {
+        return TryParseDates(values, out);
+    }
     static std::string ToString(const Type value) { return DateToString(value); }
 };
 
@@ -66,6 +84,10 @@ struct ColumnValueTraits<ColumnType::Timestamp> {
     using Type = int64_t;
 
     static Type Parse(const std::string_view value) { return ParseTimestamp(value); }
+    static std::optional<size_t> TryParseMany(const std::span<const std::string_view> values,
+                                              const std::span<Type> out) {
+        return TryParseTimestamps(values, out);
+    }
     static std::string ToString(const Type value) { return TimestampToString(value); }
 };
 
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <cstring>
+#include <optional>
 #include <span>
+#include <utility>
 #include <vector>
 
 #include "common/error.h"
@@ -18,14 +21,38 @@ class FixedColumn : public MutableColumn {
     FixedColumn& operator=(FixedColumn&&) noexcept = default;
     ~FixedColumn() override = default;
 
+    std::span<const T> Values() const { return values_; }
+
     size_t Size() const override { return values_.size(); }
     void Reserve(const size_t n) override { values_.reserve(n); }
-    void Clear() override { values_.clear(); }
+    void Clear() override {
+        values_.clear();
+        run_ends_.clear();
+    }
 
     void AppendFromString(const std::string_view value) override {
         AppendValue(ColumnValueTraits<TypeValue>::Parse(value));
     }
 
+    void AppendFromStrings(const std::span<const std::string_view> values) override {
+        if constexpr (requires(std::span<T> out) { ColumnValueTraits<TypeValue>::TryParseMany(values, out); }) {
+            run_ends_.clear();
+            const size_t begin = values_.size();
+            values_.resize(begin + values.size());
+            const std::optional<size_t> invalid =
+                ColumnValueTraits<TypeValue>::TryParseMany(values, std::span(values_).subspan(begin));
+            if (invalid) {
+                values_.resize(begin);
+                ColumnValueTraits<TypeValue>::Parse(values[*invalid]);
+                throw Error::MalformedData(ColumnImpl::ModuleName(), "invalid value");
+            }
+        } else {
+            for (const std::string_view value : values) {
+                AppendFromString(value);
+            }
+        }
+    }
+
     void AppendFromColumn(const Column& source, const size_t row) override {
         if (source.Type() != TypeValue) {
             throw Error::InconsistentData(ColumnImpl::ModuleName(), "column type mismatch");
@@ -42,6 +69,7 @@ class FixedColumn : public MutableColumn {
         if (begin > typed_source.values_.size() || count > typed_source.values_.size() - begin) {
             throw Error::OutOfRange(ColumnImpl::ModuleName(), "row range out of range");
         }
+        run_ends_.clear();
         values_.insert(values_.end(), typed_source.values_.begin() + static_cast<std::ptrdiff_t>(begin),
                        typed_source.values_.begin() + static_cast<std::ptrdiff_t>(begin + count));
     }
@@ -51,6 +79,7 @@ class FixedColumn : public MutableColumn {
             throw Error::InconsistentData(ColumnImpl::ModuleName(), "column type mismatch");
         }
         const auto& typed_source = static_cast<const FixedColumn&>(source);
+        run_ends_.clear();
         values_.reserve(values_.size() + rows.size());
         for (const size_t row : rows) {
             values_.push_back(typed_source.ValueAt(row));
@@ -70,6 +99,11 @@ class FixedColumn : public MutableColumn {
 
     void SelectRowsByInt128Comparison(const Int128 rhs, const ValueComparison comparison,
                                       std::vector<size_t>& rows) const override {
+        if (!run_ends_.empty()) {
+            SelectRunsByInt128Comparison(rhs, comparison, rows);
+            return;
+        }
+
         for (size_t row = 0; row < values_.size(); ++row) {
             if (MatchesValueComparison(static_cast<Int128>(values_[row]), rhs, comparison)) {
                 rows.push_back(row);
@@ -94,12 +128,40 @@ class FixedColumn : public MutableColumn {
         if (size != expected) {
             throw Error::InconsistentData(ColumnImpl::ModuleName(), "column chunk size mismatch");
         }
+        run_ends_.clear();
         values_.resize(row_count);
         ReadBytes(in, reinterpret_cast<char*>(values_.data()), values_.size() * sizeof(T));
     }
 
+    void ReadFrom(const std::span<const uint8_t> bytes, const uint32_t row_count) override {
+        const std::span<uint8_t> target = *PrepareRawRead(row_count, bytes.size());
+        if (!target.empty()) {
+            std::memcpy(target.data(), bytes.data(), target.size());
+        }
+    }
+
+    std::optional<std::span<uint8_t>> PrepareRawRead(const uint32_t row_count, const uint64_t size) override {
+        const uint64_t expected = static_cast<uint64_t>(row_count) * sizeof(T);
+        if (size != expected) {
+            throw Error::InconsistentData(ColumnImpl::ModuleName(), "column chunk size mismatch");
+        }
+        run_ends_.clear();
+        values_.resize(row_count);
+        return std::span<uint8_t>(reinterpret_cast<uint8_t*>(values_.data()), values_.size() * sizeof(T));
+    }
+
+    void SetRunEnds(std::vector<uint32_t> run_ends) override {
+        if (!run_ends.empty() && run_ends.back() != values_.size()) {
+            throw Error::InconsistentData(ColumnImpl::ModuleName(), "run ends do not cover the column");
+        }
+        run_ends_ = std::move(run_ends);
+    }
+
    protected:
-    void AppendValue(const T value) { values_.push_back(value); }
+    void AppendValue(const T value) {
+        run_ends_.clear();
+        values_.push_back(value);
+    }
 
     static bool MatchesValueComparison(const Int128 lhs, const Int128 rhs, const ValueComparison comparison) {
         switch (comparison) {
@@ -120,10 +182,25 @@ class FixedColumn : public MutableColumn {
         return false;
     }
 
+    void SelectRunsByInt128Comparison(const Int128 rhs, const ValueComparison comparison,
+                                      std::vector<size_t>& rows) const {
+        size_t begin = 0;
+        for (const uint32_t end : run_ends_) {
+            if (MatchesValueComparison(static_cast<Int128>(values_[begin]), rhs, comparison)) {
+                for (size_t row = begin; row < end; ++row) {
+                    rows.push_back(row);
+                }
+            }
+            begin = end;
+        }
+    }
+
     T ValueAt(const size_t row) const {
         CheckRowIndex(ColumnImpl::ModuleName(), row, values_.size());
         return values_[row];
     }
 
     std::vector<T> values_;
+    // End row of each run of equal values when the chunk was run-length encoded; empty otherwise.
+    std::vector<uint32_t> run_ends_;
 };
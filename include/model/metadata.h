@@ -2,23 +2,54 @@
 
 #include <cstdint>
 #include <iosfwd>
+#include <optional>
+#include <span>
+#include <string>
 #include <vector>
 
+#include "common/bloom_filter.h"
+#include "common/hyperloglog.h"
 #include "common/int128.h"
+#include "io/chunk_encoding.h"
 #include "io/compression.h"
 #include "model/schema.h"
 
+struct ZoneMap {
+    Int128 min_value = 0;
+    Int128 max_value = 0;
+};
+
 struct ColumnChunkMetadata {
     uint64_t offset = 0;
 
     uint64_t compressed_size = 0;
     uint64_t uncompressed_size = 0;
     Compression compression = Compression::None;
+    ChunkEncoding encoding = ChunkEncoding::Plain;
 
     bool has_min_max = false;
 
     Int128 min_value = 0;
     Int128 max_value = 0;
+
+    // Min/max of every page_rows-row slice of the chunk; only recorded when the chunk spans several pages.
+    uint32_t page_rows = 0;
+    std::vector<ZoneMap> pages;
+
+    // Built over StableHash of every value for the columns the writer was asked to index; empty otherwise.
+    BloomFilter bloom_filter;
+
+    // String chunks only. The bounds may be truncated prefixes: string_min rounds down and string_max rounds up, so
+    // every value v satisfies string_min <= v <= string_max.
+    bool has_string_stats = false;
+
+    std::string string_min;
+    std::string string_max;
+    uint32_t empty_count = 0;
+    uint32_t max_length = 0;
+
+    // Built over StableHash of every value for the columns the writer was asked to sketch.
+    std::optional<HyperLogLog> distinct_sketch;
 };
 
 struct RowGroupMetadata {
@@ -31,5 +62,39 @@ struct ColumnarMetadata {
     std::vector<RowGroupMetadata> row_groups;
 };
 
+// Footer laid out as fixed-size row group and chunk records at known offsets, so it can be used in place: only the
+// header and schema are parsed up front and a chunk is decoded when asked for. The bytes must outlive the view.
+class MetadataView {
+   public:
+    explicit MetadataView(std::span<const uint8_t> blob);
+
+    static bool IsFlat(std::span<const uint8_t> blob);
+
+    const Schema& GetSchema() const { return schema_; }
+    size_t RowGroupCount() const { return row_group_count_; }
+    uint32_t RowCount(size_t row_group) const;
+
+    // Everything but the distinct sketch, which is large and only needed to answer APPROX_COUNT_DISTINCT.
+    ColumnChunkMetadata Chunk(size_t row_group, size_t column) const;
+    bool HasDistinctSketch(size_t row_group, size_t column) const;
+    std::optional<HyperLogLog> DistinctSketch(size_t row_group, size_t column) const;
+
+    // Decodes the given columns of one row group; the other chunks keep no statistics, so pruning cannot skip on them.
+    void DecodeRowGroup(size_t row_group, std::span<const size_t> columns, RowGroupMetadata& out) const;
+    ColumnarMetadata Decode() const;
+
+   private:
+    uint64_t RecordOffset(size_t row_group, size_t column) const;
+
+    std::span<const uint8_t> blob_;
+    Schema schema_;
+
+    size_t row_group_count_ = 0;
+    uint64_t row_group_table_ = 0;
+    uint64_t chunk_table_ = 0;
+    uint64_t extra_ = 0;
+    uint64_t extra_size_ = 0;
+};
+
 ColumnarMetadata ReadMetadata(std::istream& in);
 void WriteMetadata(std::ostream& out, const ColumnarMetadata& metadata);
@@ -2,8 +2,10 @@
 
 #include <filesystem>
 
+#include "io/csv_chunks.h"
 #include "model/schema.h"
 
 Schema ReadSchemaCsv(const std::filesystem::path& path);
-Schema InferSchemaCsv(const std::filesystem::path& path);
+// Chunks of the file are examined in parallel; a column gets the narrowest type all of its values parse as.
+Schema InferSchemaCsv(const std::filesystem::path& path, const CsvParallelOptions& options = {});
 void WriteSchemaCsv(const std::filesystem::path& path, const Schema& schema);
@@ -40,8 +40,9 @@ class TempFile {
         if (path_.empty()) {
             return;
         }
+        // remove_all, so a TempFile can also own a directory tree such as a partitioned table.
         std::error_code ec;
-        std::filesystem::remove(path_, ec);
+        std::filesystem::remove_all(path_, ec);
     }
 
     std::filesystem::path path_;
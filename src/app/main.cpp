@@ -1,9 +1,11 @@
+#include <algorithm>
 #include <argparse/argparse.hpp>
 #include <iostream>
 #include <stdexcept>
 #include <vector>
 
 #include "common/error.h"
+#include "convert/compact.h"
 #include "convert/csv_columnar.h"
 #include "executor/executor.h"
 #include "io/csv_batch.h"
@@ -15,6 +17,20 @@ void ConfigureInferSchemaCommand(argparse::ArgumentParser& command) {
     command.add_description("Infer a schema from a CSV file.");
     command.add_argument("--input").required();
     command.add_argument("--output").required();
+    command.add_argument("--threads").scan<'u', size_t>().default_value(size_t{0});
+}
+
+void ConfigureColumnarWriteArguments(argparse::ArgumentParser& command) {
+    command.add_argument("--compression").default_value(std::string("none"));
+    command.add_argument("--compression-level").scan<'i', int>().default_value(DefaultCompressionLevel);
+    command.add_argument("--codec-objective").default_value(std::string("balanced"));
+    command.add_argument("--codec-scope").default_value(std::string("row-group"));
+    command.add_argument("--encoding").default_value(std::string("auto"));
+    command.add_argument("--page-rows").scan<'u', uint32_t>().default_value(DefaultPageRows);
+    command.add_argument("--bloom-filter").append();
+    command.add_argument("--distinct-sketch").append();
+    command.add_argument("--sort-by").default_value(std::string());
+    command.add_argument("--sort-run-rows").scan<'u', size_t>().default_value(DefaultSortRunRows);
 }
 
 void ConfigureConvertCommand(argparse::ArgumentParser& command) {
@@ -23,7 +39,22 @@ void ConfigureConvertCommand(argparse::ArgumentParser& command) {
     command.add_argument("--input").required();
     command.add_argument("--output").required();
     command.add_argument("--row-group-size").scan<'u', size_t>().default_value(size_t{1 << 14});
-    command.add_argument("--compression").default_value(std::string("none"));
+    ConfigureColumnarWriteArguments(command);
+    command.add_argument("--append").default_value(false).implicit_value(true);
+    command.add_argument("--encode-threads").scan<'u', size_t>().default_value(size_t{0});
+    command.add_argument("--parse-workers").scan<'u', size_t>().default_value(size_t{0});
+    command.add_argument("--encode-workers").scan<'u', size_t>().default_value(size_t{0});
+    command.add_argument("--queue-batches").scan<'u', size_t>().default_value(DefaultPipelineQueueBatches);
+}
+
+void ConfigureCompactCommand(argparse::ArgumentParser& command) {
+    command.add_description("Rewrite a columnar file with its row groups coalesced, optionally re-encoded or sorted.");
+    command.add_argument("--input").required();
+    command.add_argument("--output").required();
+    command.add_argument("--row-group-size").scan<'u', size_t>().default_value(size_t{1 << 14});
+    command.add_argument("--row-group-bytes").scan<'u', uint64_t>().default_value(uint64_t{0});
+    command.add_argument("--threads").scan<'u', size_t>().default_value(size_t{0});
+    ConfigureColumnarWriteArguments(command);
 }
 
 void ConfigureRoundtripCommand(argparse::ArgumentParser& command) {
@@ -34,32 +65,110 @@ void ConfigureRoundtripCommand(argparse::ArgumentParser& command) {
 }
 
 void ConfigureRunQueryCommand(argparse::ArgumentParser& command) {
-    command.add_description("Execute a SQL query against a columnar file and write the result to CSV.");
+    command.add_description("Execute a SQL query against a columnar table and write the result to CSV.");
     command.add_argument("--input").required();
     command.add_argument("--output").required();
     command.add_argument("--table-name").default_value(std::string("hits"));
     command.add_argument("--query");
     command.add_argument("--query-file");
+    command.add_argument("--read-ahead").scan<'u', size_t>().default_value(size_t{DefaultScanReadAheadRowGroups});
+    command.add_argument("--scan-threads").scan<'u', size_t>().default_value(size_t{0});
+    command.add_argument("--concurrent-files").scan<'u', size_t>().default_value(size_t{DefaultScanConcurrentFiles});
+    command.add_argument("--scan-io").default_value(std::string("scheduled"));
+    command.add_argument("--io-backend").default_value(std::string("auto"));
 }
 
 int RunInferSchema(const argparse::ArgumentParser& command) {
     const auto input_path = std::filesystem::path(command.get<std::string>("--input"));
     const auto output_path = std::filesystem::path(command.get<std::string>("--output"));
 
+    const CsvParallelOptions options{.threads = command.get<size_t>("--threads")};
+
     EnsureParentDirectory(output_path);
-    WriteSchemaCsv(output_path, InferSchemaCsv(input_path));
+    WriteSchemaCsv(output_path, InferSchemaCsv(input_path, options));
 
     return 0;
 }
 
+ColumnarWriteOptions ConvertWriteOptions(const argparse::ArgumentParser& command) {
+    ColumnarWriteOptions options;
+    const auto compression = command.get<std::string>("--compression");
+
+    if (compression == "auto") {
+        options.adaptive_codec = CodecSelection{
+            .objective = CodecObjectiveFromName(command.get<std::string>("--codec-objective")),
+            .scope = CodecSelectionScopeFromName(command.get<std::string>("--codec-scope")),
+        };
+    } else {
+        options.compression = CompressionFromName(compression);
+        options.compression_level = command.get<int>("--compression-level");
+    }
+
+    const auto encoding = command.get<std::string>("--encoding");
+    if (encoding != "auto" && encoding != "plain") {
+        throw Error::InvalidArgument("app", "unsupported chunk encoding mode: " + encoding);
+    }
+    options.lightweight_encoding = encoding == "auto";
+    options.page_rows = command.get<uint32_t>("--page-rows");
+    if (const auto columns = command.present<std::vector<std::string>>("--bloom-filter")) {
+        options.bloom_filter_columns = *columns;
+    }
+    if (const auto columns = command.present<std::vector<std::string>>("--distinct-sketch")) {
+        options.distinct_sketch_columns = *columns;
+    }
+
+    return options;
+}
+
+SortOptions ConvertSortOptions(const argparse::ArgumentParser& command) {
+    SortOptions options;
+    options.run_rows = command.get<size_t>("--sort-run-rows");
+
+    const auto sort_by = command.get<std::string>("--sort-by");
+    for (size_t begin = 0; begin < sort_by.size();) {
+        const size_t end = std::min(sort_by.find(',', begin), sort_by.size());
+        if (end == begin) {
+            throw Error::InvalidArgument("app", "empty column name in --sort-by: " + sort_by);
+        }
+        options.columns.push_back(sort_by.substr(begin, end - begin));
+        begin = end + 1;
+    }
+
+    return options;
+}
+
 int RunConvert(const argparse::ArgumentParser& command) {
     const auto output_path = std::filesystem::path(command.get<std::string>("--output"));
 
+    ColumnarWriteOptions options = ConvertWriteOptions(command);
+    options.encode_threads = command.get<size_t>("--encode-threads");
+    if (command.get<bool>("--append")) {
+        options.open_mode = FileOpenMode::Append;
+    }
+
     EnsureParentDirectory(output_path);
     ConvertCsvToColumnar(std::filesystem::path(command.get<std::string>("--schema")),
                          std::filesystem::path(command.get<std::string>("--input")), output_path,
-                         command.get<size_t>("--row-group-size"),
-                         CompressionFromName(command.get<std::string>("--compression")));
+                         command.get<size_t>("--row-group-size"), options, ConvertSortOptions(command),
+                         PipelineOptions{.parse_workers = command.get<size_t>("--parse-workers"),
+                                         .encode_workers = command.get<size_t>("--encode-workers"),
+                                         .queue_batches = command.get<size_t>("--queue-batches")});
+
+    return 0;
+}
+
+int RunCompact(const argparse::ArgumentParser& command) {
+    const auto output_path = std::filesystem::path(command.get<std::string>("--output"));
+
+    EnsureParentDirectory(output_path);
+    CompactColumnarFile(std::filesystem::path(command.get<std::string>("--input")), output_path,
+                        CompactOptions{
+                            .target_rows = command.get<size_t>("--row-group-size"),
+                            .target_bytes = command.get<uint64_t>("--row-group-bytes"),
+                            .write_options = ConvertWriteOptions(command),
+                            .sort = ConvertSortOptions(command),
+                            .threads = command.get<size_t>("--threads"),
+                        });
 
     return 0;
 }
@@ -77,6 +186,17 @@ int RunRoundtrip(const argparse::ArgumentParser& command) {
     return 0;
 }
 
+ScanIo ScanIoFromName(const std::string& name) {
+    if (name == "mapped") {
+        return ScanIo::Mapped;
+    }
+    if (name == "scheduled") {
+        return ScanIo::Scheduled;
+    }
+
+    throw Error::InvalidArgument("app", "unsupported scan io mode: " + name);
+}
+
 int RunQuery(const argparse::ArgumentParser& command) {
     const bool has_query = command.is_used("--query");
     const bool has_query_file = command.is_used("--query-file");
@@ -94,6 +214,13 @@ int RunQuery(const argparse::ArgumentParser& command) {
     Executor executor;
     executor.RegisterTable(command.get<std::string>("--table-name"),
                            std::filesystem::path(command.get<std::string>("--input")));
+    executor.SetScanOptions({
+        .read_ahead_row_groups = command.get<size_t>("--read-ahead"),
+        .worker_threads = command.get<size_t>("--scan-threads"),
+        .concurrent_files = command.get<size_t>("--concurrent-files"),
+        .io = ScanIoFromName(command.get<std::string>("--scan-io")),
+        .io_backend = IoBackendFromName(command.get<std::string>("--io-backend")),
+    });
 
     const ExecuteExpected result = executor.Execute(query);
     if (!result.has_value()) {
@@ -110,16 +237,19 @@ int main(const int argc, char** argv) {
         argparse::ArgumentParser program("columnar_engine");
         argparse::ArgumentParser infer_schema_command("infer-schema");
         argparse::ArgumentParser convert_command("convert");
+        argparse::ArgumentParser compact_command("compact");
         argparse::ArgumentParser roundtrip_command("roundtrip");
         argparse::ArgumentParser run_query_command("run-query");
 
         ConfigureInferSchemaCommand(infer_schema_command);
         ConfigureConvertCommand(convert_command);
+        ConfigureCompactCommand(compact_command);
         ConfigureRoundtripCommand(roundtrip_command);
         ConfigureRunQueryCommand(run_query_command);
 
         program.add_subparser(infer_schema_command);
         program.add_subparser(convert_command);
+        program.add_subparser(compact_command);
         program.add_subparser(roundtrip_command);
         program.add_subparser(run_query_command);
         program.parse_args(argc, argv);
@@ -132,6 +262,10 @@ int main(const int argc, char** argv) {
             return RunConvert(convert_command);
         }
 
+        if (program.is_subcommand_used("compact")) {
+            return RunCompact(compact_command);
+        }
+
         if (program.is_subcommand_used("roundtrip")) {
             return RunRoundtrip(roundtrip_command);
         }
@@ -0,0 +1,186 @@
+#include "common/hyperloglog.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+#include "common/bit_packing.h"
+#include "common/error.h"
+
+static constexpr uint8_t RegisterWidth = 6;
+
+enum class SketchLayout : uint8_t {
+    Dense = 0,
+    Sparse = 1,
+};
+
+static constexpr size_t SparseEntryBytes = sizeof(uint16_t) + sizeof(uint8_t);
+
+// A full sparse list takes as much memory as the dense registers; it turns dense once compaction leaves it half full.
+static constexpr size_t SparseMaxEntries = HyperLogLog::RegisterCount / 4;
+
+static uint32_t SparseEntry(const size_t index, const uint8_t rank) {
+    return static_cast<uint32_t>(index << 8) | rank;
+}
+
+static size_t SparseIndex(const uint32_t entry) { return entry >> 8; }
+
+static uint8_t SparseRank(const uint32_t entry) { return static_cast<uint8_t>(entry); }
+
+// Sorts the entries by index and keeps the highest rank of each register.
+static void CompactSparse(std::vector<uint32_t>& entries) {
+    std::ranges::sort(entries);
+    size_t kept = 0;
+    for (const uint32_t entry : entries) {
+        if (kept > 0 && SparseIndex(entries[kept - 1]) == SparseIndex(entry)) {
+            entries[kept - 1] = entry;
+        } else {
+            entries[kept++] = entry;
+        }
+    }
+    entries.resize(kept);
+}
+
+HyperLogLog::HyperLogLog() = default;
+
+void HyperLogLog::Insert(const uint64_t hash) {
+    const size_t index = hash >> (64 - Precision);
+    const uint64_t remaining = (hash << Precision) | (uint64_t{1} << (Precision - 1));
+    Set(index, static_cast<uint8_t>(std::countl_zero(remaining) + 1));
+}
+
+void HyperLogLog::Set(const size_t index, const uint8_t rank) {
+    if (IsDense()) {
+        registers_[index] = std::max(registers_[index], rank);
+        return;
+    }
+
+    sparse_.push_back(SparseEntry(index, rank));
+    if (sparse_.size() >= SparseMaxEntries) {
+        CompactSparse(sparse_);
+        if (sparse_.size() > SparseMaxEntries / 2) {
+            Densify();
+        }
+    }
+}
+
+void HyperLogLog::Densify() {
+    registers_.assign(RegisterCount, 0);
+    for (const uint32_t entry : sparse_) {
+        uint8_t& rank = registers_[SparseIndex(entry)];
+        rank = std::max(rank, SparseRank(entry));
+    }
+    sparse_ = {};
+}
+
+void HyperLogLog::Merge(const HyperLogLog& other) {
+    if (!other.IsDense()) {
+        for (const uint32_t entry : other.sparse_) {
+            Set(SparseIndex(entry), SparseRank(entry));
+        }
+        return;
+    }
+
+    if (!IsDense()) {
+        Densify();
+    }
+    for (size_t i = 0; i < RegisterCount; ++i) {
+        registers_[i] = std::max(registers_[i], other.registers_[i]);
+    }
+}
+
+uint64_t HyperLogLog::Estimate() const {
+    constexpr auto registers = static_cast<double>(RegisterCount);
+    const double alpha = 0.7213 / (1.0 + 1.079 / registers);
+
+    double inverse_sum = 0;
+    size_t zero_registers = 0;
+    if (IsDense()) {
+        for (const uint8_t rank : registers_) {
+            inverse_sum += std::ldexp(1.0, -static_cast<int>(rank));
+            zero_registers += rank == 0 ? 1 : 0;
+        }
+    } else {
+        std::vector<uint32_t> entries = sparse_;
+        CompactSparse(entries);
+        for (const uint32_t entry : entries) {
+            inverse_sum += std::ldexp(1.0, -static_cast<int>(SparseRank(entry)));
+        }
+        zero_registers = RegisterCount - entries.size();
+        inverse_sum += static_cast<double>(zero_registers);
+    }
+
+    double estimate = alpha * registers * registers / inverse_sum;
+    // Linear counting is more accurate while many registers are still empty.
+    if (estimate <= 2.5 * registers && zero_registers > 0) {
+        estimate = registers * std::log(registers / static_cast<double>(zero_registers));
+    }
+
+    return static_cast<uint64_t>(std::llround(estimate));
+}
+
+void HyperLogLog::Serialize(std::vector<uint8_t>& out) const {
+    std::vector<uint32_t> entries;
+    if (IsDense()) {
+        const auto non_zero =
+            static_cast<size_t>(std::ranges::count_if(registers_, [](const uint8_t rank) { return rank != 0; }));
+        if (non_zero * SparseEntryBytes >= PackedByteCount(RegisterCount, RegisterWidth)) {
+            out.push_back(static_cast<uint8_t>(SketchLayout::Dense));
+            PackBits<uint8_t>(registers_, RegisterWidth, out);
+            return;
+        }
+
+        for (size_t i = 0; i < RegisterCount; ++i) {
+            if (registers_[i] != 0) {
+                entries.push_back(SparseEntry(i, registers_[i]));
+            }
+        }
+    } else {
+        // Never more entries than the dense layout would take room for.
+        entries = sparse_;
+        CompactSparse(entries);
+    }
+
+    out.push_back(static_cast<uint8_t>(SketchLayout::Sparse));
+    for (const uint32_t entry : entries) {
+        const auto index = static_cast<uint16_t>(SparseIndex(entry));
+        out.push_back(static_cast<uint8_t>(index));
+        out.push_back(static_cast<uint8_t>(index >> 8));
+        out.push_back(SparseRank(entry));
+    }
+}
+
+HyperLogLog HyperLogLog::Deserialize(const std::span<const uint8_t> bytes) {
+    if (bytes.empty()) {
+        throw Error::MalformedData("hyperloglog", "empty sketch");
+    }
+
+    HyperLogLog sketch;
+    const std::span<const uint8_t> payload = bytes.subspan(1);
+
+    switch (static_cast<SketchLayout>(bytes.front())) {
+        case SketchLayout::Dense:
+            if (payload.size() != PackedByteCount(RegisterCount, RegisterWidth)) {
+                throw Error::MalformedData("hyperloglog", "dense sketch size mismatch");
+            }
+            sketch.registers_.resize(RegisterCount);
+            UnpackBits<uint8_t>(payload, RegisterWidth, sketch.registers_);
+            return sketch;
+        case SketchLayout::Sparse:
+            if (payload.size() % SparseEntryBytes != 0) {
+                throw Error::MalformedData("hyperloglog", "sparse sketch size mismatch");
+            }
+            for (size_t offset = 0; offset < payload.size(); offset += SparseEntryBytes) {
+                const size_t index = payload[offset] | (size_t{payload[offset + 1]} << 8);
+                if (index >= RegisterCount) {
+                    throw Error::MalformedData("hyperloglog", "sparse register index out of range");
+                }
+                if (payload[offset + 2] != 0) {
+                    sketch.Set(index, payload[offset + 2]);
+                }
+            }
+            return sketch;
+    }
+
+    throw Error::MalformedData("hyperloglog", "unknown sketch layout");
+}
@@ -1,23 +1,21 @@
 #include "common/parsing.h"
 
+#include <array>
+#include <bit>
 #include <charconv>
 #include <chrono>
 #include <concepts>
+#include <cstring>
 #include <iomanip>
 #include <limits>
 #include <optional>
 #include <sstream>
+#include <type_traits>
 
 #include "common/ascii.h"
 #include "common/error.h"
 
 constexpr size_t DateTextLength = 10;
-constexpr size_t DateYearOffset = 0;
-constexpr size_t DateYearLength = 4;
-constexpr size_t DateMonthOffset = 5;
-constexpr size_t DateMonthLength = 2;
-constexpr size_t DateDayOffset = 8;
-constexpr size_t DateDayLength = 2;
 constexpr size_t DateFirstSeparatorIndex = 4;
 constexpr size_t DateSecondSeparatorIndex = 7;
 
@@ -25,9 +23,6 @@ constexpr size_t TimestampMinLength = 19;
 constexpr size_t TimestampDateLength = 10;
 constexpr size_t TimestampSeparatorIndex = 10;
 constexpr size_t TimestampHourOffset = 11;
-constexpr size_t TimestampMinuteOffset = 14;
-constexpr size_t TimestampSecondOffset = 17;
-constexpr size_t TimestampComponentLength = 2;
 constexpr size_t TimestampHourMinuteSeparatorIndex = 13;
 constexpr size_t TimestampMinuteSecondSeparatorIndex = 16;
 constexpr size_t TimestampFractionSeparatorIndex = 19;
@@ -44,6 +39,33 @@ constexpr char TimestampAlternativeDateTimeSeparator = 'T';
 constexpr char TimeSeparator = ':';
 constexpr char FractionSeparator = '.';
 
+// Words of 8 characters, loaded so that the first character is the lowest byte whatever the byte order.
+static uint64_t LoadWord(const char* data) {
+    uint64_t word = 0;
+    std::memcpy(&word, data, sizeof(word));
+    if constexpr (std::endian::native == std::endian::big) {
+        word = std::byteswap(word);
+    }
+    return word;
+}
+
+static bool IsEightDigits(const uint64_t word) {
+    return ((word & 0xF0F0F0F0F0F0F0F0) | (((word + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) ==
+           0x3333333333333333;
+}
+
+// The value of 8 digit characters, combining neighbouring digits in pairs, then fours, then eights.
+static uint32_t ParseEightDigits(uint64_t word) {
+    word -= 0x3030303030303030;
+    word = word * 10 + (word >> 8);
+    word = (((word & 0x000000FF000000FF) * (100 + (1000000ULL << 32))) +
+            (((word >> 16) & 0x000000FF000000FF) * (1 + (10000ULL << 32)))) >>
+           32;
+    return static_cast<uint32_t>(word);
+}
+
+constexpr size_t MaxFastIntegerDigits = 19;
+
 template <std::integral T>
 bool TryParseInteger(const std::string_view value, T& result) {
     if (value.empty()) {
@@ -52,9 +74,40 @@ bool TryParseInteger(const std::string_view value, T& result) {
 
     const char* begin = value.data();
     const char* end = begin + value.size();
-    const auto [ptr, ec] = std::from_chars(begin, end, result);
+    const bool negative = std::is_signed_v<T> && *begin == '-';
+    const char* digits = begin + (negative ? 1 : 0);
+    const auto count = static_cast<size_t>(end - digits);
+
+    // Up to 19 digits fit in 64 bits, 8 of them at a time; longer inputs are mostly leading zeros.
+    if (count == 0 || count > MaxFastIntegerDigits) {
+        const auto [ptr, ec] = std::from_chars(begin, end, result);
+        return ec == std::errc() && ptr == end;
+    }
+
+    uint64_t magnitude = 0;
+    const char* pos = digits;
+    for (; end - pos >= 8; pos += 8) {
+        const uint64_t word = LoadWord(pos);
+        if (!IsEightDigits(word)) {
+            return false;
+        }
+        magnitude = magnitude * 100000000 + ParseEightDigits(word);
+    }
+    for (; pos < end; ++pos) {
+        const auto digit = static_cast<unsigned char>(*pos - '0');
+        if (digit > 9) {
+            return false;
+        }
+        magnitude = magnitude * 10 + digit;
+    }
 
-    return ec == std::errc() && ptr == end;
+    using Unsigned = std::make_unsigned_t<T>;
+    const auto limit = static_cast<uint64_t>(std::numeric_limits<T>::max()) + (negative ? 1 : 0);
+    if (magnitude > limit) {
+        return false;
+    }
+    result = static_cast<T>(negative ? static_cast<Unsigned>(0 - magnitude) : static_cast<Unsigned>(magnitude));
+    return true;
 }
 
 template <std::integral T>
@@ -71,42 +124,77 @@ T ParseInteger(const std::string_view value, const std::string_view type_name) {
     return result;
 }
 
-static bool TryParseUnsignedPart(const std::string_view input, const size_t offset, const size_t length,
-                                 unsigned& value) {
-    const char* begin = input.data() + offset;
-    const char* end = begin + length;
-    const auto [ptr, ec] = std::from_chars(begin, end, value);
-    return ec == std::errc() && ptr == end;
+static unsigned DaysInMonth(const unsigned year, const unsigned month) {
+    constexpr std::array<unsigned, 12> Days = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    const bool leap = year % 4 == 0 && (year % 100 != 0 || year % 400 == 0);
+    return month == 2 && leap ? 29 : Days[month - 1];
 }
 
+// Days since 1970-01-01 of a valid date in years 0 to 9999, counting from March so that leap days end a year. The
+// year is shifted by one 400-year era to stay positive for January and February of year 0.
+static int32_t DaysFromCivil(const unsigned year, const unsigned month, const unsigned day) {
+    constexpr int32_t EraDays = 146097;
+    constexpr int32_t EpochDays = 719468;
+
+    const unsigned shifted_year = year + 400 - (month <= 2 ? 1 : 0);
+    const unsigned era = shifted_year / 400;
+    const unsigned year_of_era = shifted_year - era * 400;
+    const unsigned day_of_year = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    const unsigned day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    return static_cast<int32_t>(era) * EraDays + static_cast<int32_t>(day_of_era) - EpochDays - EraDays;
+}
+
+// "YYYY-MM-DD" read as two overlapping words whose digits are gathered into one "YYYYMMDD" word.
 static bool TryParseDatePoint(const std::string_view value, std::chrono::sys_days& result) {
     if (value.size() != DateTextLength || value[DateFirstSeparatorIndex] != DateSeparator ||
         value[DateSecondSeparatorIndex] != DateSeparator) {
         return false;
     }
 
-    unsigned year = 0;
-    unsigned month = 0;
-    unsigned day = 0;
+    const uint64_t head = LoadWord(value.data());
+    const uint64_t tail = LoadWord(value.data() + DateTextLength - sizeof(uint64_t));
+    const uint64_t digits =
+        (head & 0x00000000FFFFFFFF) | ((head >> 8) & 0x0000FFFF00000000) | (tail & 0xFFFF000000000000);
+    if (!IsEightDigits(digits)) {
+        return false;
+    }
 
-    if (!TryParseUnsignedPart(value, DateYearOffset, DateYearLength, year) ||
-        !TryParseUnsignedPart(value, DateMonthOffset, DateMonthLength, month) ||
-        !TryParseUnsignedPart(value, DateDayOffset, DateDayLength, day)) {
+    const uint32_t packed = ParseEightDigits(digits);
+    const unsigned year = packed / 10000;
+    const unsigned month = packed / 100 % 100;
+    const unsigned day = packed % 100;
+    if (month < 1 || month > 12 || day < 1 || day > DaysInMonth(year, month)) {
         return false;
     }
 
-    const std::chrono::year_month_day ymd{
-        std::chrono::year{static_cast<int>(year)},
-        std::chrono::month{month},
-        std::chrono::day{day},
-    };
+    result = std::chrono::sys_days{std::chrono::days{DaysFromCivil(year, month, day)}};
+
+    return true;
+}
+
+// "HH:MM:SS" as one word, with its digits gathered into "00HHMMSS".
+static bool TryParseTimeOfDay(const std::string_view value, unsigned& seconds) {
+    if (value[TimestampHourMinuteSeparatorIndex] != TimeSeparator ||
+        value[TimestampMinuteSecondSeparatorIndex] != TimeSeparator) {
+        return false;
+    }
 
-    if (!ymd.ok()) {
+    const uint64_t word = LoadWord(value.data() + TimestampHourOffset);
+    const uint64_t digits = 0x3030 | ((word & 0x000000000000FFFF) << 16) | ((word & 0x000000FFFF000000) << 8) |
+                            (word & 0xFFFF000000000000);
+    if (!IsEightDigits(digits)) {
         return false;
     }
 
-    result = std::chrono::sys_days{ymd};
+    const uint32_t packed = ParseEightDigits(digits);
+    const unsigned hour = packed / 10000;
+    const unsigned minute = packed / 100 % 100;
+    const unsigned second = packed % 100;
+    if (hour > MaxHour || minute > MaxMinute || second > MaxSecond) {
+        return false;
+    }
 
+    seconds = (hour * 60 + minute) * 60 + second;
     return true;
 }
 
@@ -278,22 +366,8 @@ std::optional<int64_t> TryParseTimestamp(const std::string_view value) {
         return std::nullopt;
     }
 
-    if (value[TimestampHourMinuteSeparatorIndex] != TimeSeparator ||
-        value[TimestampMinuteSecondSeparatorIndex] != TimeSeparator) {
-        return std::nullopt;
-    }
-
-    unsigned hour = 0;
-    unsigned minute = 0;
-    unsigned second = 0;
-
-    if (!TryParseUnsignedPart(value, TimestampHourOffset, TimestampComponentLength, hour) ||
-        !TryParseUnsignedPart(value, TimestampMinuteOffset, TimestampComponentLength, minute) ||
-        !TryParseUnsignedPart(value, TimestampSecondOffset, TimestampComponentLength, second)) {
-        return std::nullopt;
-    }
-
-    if (hour > MaxHour || minute > MaxMinute || second > MaxSecond) {
+    unsigned seconds = 0;
+    if (!TryParseTimeOfDay(value, seconds)) {
         return std::nullopt;
     }
 
@@ -309,19 +383,19 @@ std::optional<int64_t> TryParseTimestamp(const std::string_view value) {
             return std::nullopt;
         }
 
-        unsigned fractional = 0;
-        if (!TryParseUnsignedPart(value, TimestampFractionDigitsOffset, digits, fractional)) {
-            return std::nullopt;
-        }
-
-        microseconds = static_cast<int64_t>(fractional);
-        for (size_t i = digits; i < TimestampMaxFractionDigits; ++i) {
-            microseconds *= 10;
+        for (size_t i = 0; i < TimestampMaxFractionDigits; ++i) {
+            unsigned digit = 0;
+            if (i < digits) {
+                digit = static_cast<unsigned char>(value[TimestampFractionDigitsOffset + i] - '0');
+                if (digit > 9) {
+                    return std::nullopt;
+                }
+            }
+            microseconds = microseconds * 10 + digit;
         }
     }
 
-    const auto timestamp = day_point + std::chrono::hours{hour} + std::chrono::minutes{minute} +
-                           std::chrono::seconds{second} + std::chrono::microseconds{microseconds};
+    const auto timestamp = day_point + std::chrono::seconds{seconds} + std::chrono::microseconds{microseconds};
 
     return std::chrono::duration_cast<std::chrono::microseconds>(timestamp.time_since_epoch()).count();
 }
@@ -334,6 +408,43 @@ int64_t ParseTimestamp(const std::string_view value) {
     return *result;
 }
 
+template <class T, class TryParse>
+static std::optional<size_t> TryParseAll(const std::span<const std::string_view> values, const std::span<T> out,
+                                         TryParse&& try_parse) {
+    if (out.size() < values.size()) {
+        throw Error::InvalidArgument("common", "parse output is shorter than its input");
+    }
+    for (size_t i = 0; i < values.size(); ++i) {
+        const std::optional<T> value = try_parse(values[i]);
+        if (!value) {
+            return i;
+        }
+        out[i] = *value;
+    }
+    return std::nullopt;
+}
+
+std::optional<size_t> TryParseInt16s(const std::span<const std::string_view> values, const std::span<int16_t> out) {
+    return TryParseAll(values, out, TryParseInt16);
+}
+
+std::optional<size_t> TryParseInt32s(const std::span<const std::string_view> values, const std::span<int32_t> out) {
+    return TryParseAll(values, out, TryParseInt32);
+}
+
+std::optional<size_t> TryParseInt64s(const std::span<const std::string_view> values, const std::span<int64_t> out) {
+    return TryParseAll(values, out, TryParseInt64);
+}
+
+std::optional<size_t> TryParseDates(const std::span<const std::string_view> values, const std::span<int32_t> out) {
+    return TryParseAll(values, out, TryParseDate);
+}
+
+std::optional<size_t> TryParseTimestamps(const std::span<const std::string_view> values,
+                                         const std::span<int64_t> out) {
+    return TryParseAll(values, out, TryParseTimestamp);
+}
+
 std::optional<char> TryParseCharacter(const std::string_view value) {
     if (value.size() != 1) {
         return std::nullopt;
@@ -382,33 +493,115 @@ std::string Int128ToString(const Int128 value) {
     return out;
 }
 
-std::string DateToString(const int32_t value) {
-    const auto day_point = std::chrono::sys_days{} + std::chrono::days{value};
-    return FormatDateParts(std::chrono::year_month_day{day_point});
+// "00" to "99", so that two digits are written with one copy.
+static constexpr std::array<char, 200> DigitPairs = [] {
+    std::array<char, 200> pairs{};
+    for (size_t i = 0; i < 100; ++i) {
+        pairs[2 * i] = static_cast<char>('0' + i / 10);
+        pairs[2 * i + 1] = static_cast<char>('0' + i % 10);
+    }
+    return pairs;
+}();
+
+static char* WriteTwoDigits(char* out, const unsigned value) {
+    std::memcpy(out, DigitPairs.data() + 2 * value, 2);
+    return out + 2;
 }
 
-std::string TimestampToString(const int64_t value) {
-    const std::chrono::sys_time<std::chrono::microseconds> timestamp{std::chrono::microseconds{value}};
-    const auto day_point = std::chrono::floor<std::chrono::days>(timestamp);
-    const std::chrono::hh_mm_ss tod{timestamp - day_point};
+struct CivilDate {
+    int64_t year = 0;
+    unsigned month = 0;
+    unsigned day = 0;
+};
+
+// The inverse of DaysFromCivil, for any day count.
+static CivilDate CivilFromDays(int64_t days) {
+    constexpr int64_t EraDays = 146097;
+
+    days += 719468;
+    const int64_t era = (days >= 0 ? days : days - (EraDays - 1)) / EraDays;
+    const auto day_of_era = static_cast<unsigned>(days - era * EraDays);
+    const unsigned year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+    const unsigned day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+    const unsigned month_from_march = (5 * day_of_year + 2) / 153;
+
+    CivilDate date;
+    date.day = day_of_year - (153 * month_from_march + 2) / 5 + 1;
+    date.month = month_from_march < 10 ? month_from_march + 3 : month_from_march - 9;
+    date.year = static_cast<int64_t>(year_of_era) + era * 400 + (date.month <= 2 ? 1 : 0);
+    return date;
+}
 
-    std::ostringstream out;
-    out << FormatDateParts(std::chrono::year_month_day{day_point}) << TimestampDateTimeSeparator
-        << std::setfill('0') << std::setw(2) << tod.hours().count() << TimeSeparator << std::setw(2)
-        << tod.minutes().count() << TimeSeparator << std::setw(2) << tod.seconds().count();
+static void AppendDateDays(std::string& out, const int64_t days) {
+    const CivilDate date = CivilFromDays(days);
+    if (date.year < 0 || date.year > 9999) {
+        const std::chrono::year_month_day ymd{std::chrono::sys_days{} + std::chrono::days{days}};
+        out += FormatDateParts(ymd);
+        return;
+    }
+
+    std::array<char, DateTextLength> text{};
+    char* pos = WriteTwoDigits(text.data(), static_cast<unsigned>(date.year / 100));
+    pos = WriteTwoDigits(pos, static_cast<unsigned>(date.year % 100));
+    *pos++ = DateSeparator;
+    pos = WriteTwoDigits(pos, date.month);
+    *pos++ = DateSeparator;
+    WriteTwoDigits(pos, date.day);
+    out.append(text.data(), text.size());
+}
 
-    const int64_t fractional = tod.subseconds().count();
+void AppendDate(std::string& out, const int32_t value) { AppendDateDays(out, value); }
+
+void AppendTimestamp(std::string& out, const int64_t value) {
+    constexpr int64_t MicrosPerSecond = 1000000;
+    constexpr int64_t MicrosPerDay = 86400 * MicrosPerSecond;
+
+    int64_t days = value / MicrosPerDay;
+    int64_t micros = value % MicrosPerDay;
+    if (micros < 0) {
+        --days;
+        micros += MicrosPerDay;
+    }
+    AppendDateDays(out, days);
+
+    const auto seconds = static_cast<unsigned>(micros / MicrosPerSecond);
+    std::array<char, 9> time{};
+    time[0] = TimestampDateTimeSeparator;
+    char* pos = WriteTwoDigits(time.data() + 1, seconds / 3600);
+    *pos++ = TimeSeparator;
+    pos = WriteTwoDigits(pos, seconds / 60 % 60);
+    *pos++ = TimeSeparator;
+    WriteTwoDigits(pos, seconds % 60);
+    out.append(time.data(), time.size());
+
+    auto fraction = static_cast<unsigned>(micros % MicrosPerSecond);
+    if (fraction == 0) {
+        return;
+    }
+    size_t digits = TimestampMaxFractionDigits;
+    while (fraction % 10 == 0) {
+        fraction /= 10;
+        --digits;
+    }
+    std::array<char, TimestampMaxFractionDigits + 1> text{};
+    text[0] = FractionSeparator;
+    for (size_t i = digits; i > 0; --i) {
+        text[i] = static_cast<char>('0' + fraction % 10);
+        fraction /= 10;
+    }
+    out.append(text.data(), digits + 1);
+}
 
-    if (fractional != 0) {
-        std::string frac = std::to_string(fractional);
-        frac.insert(frac.begin(), TimestampMaxFractionDigits - static_cast<std::ptrdiff_t>(frac.size()), '0');
-        while (!frac.empty() && frac.back() == '0') {
-            frac.pop_back();
-        }
-        out << FractionSeparator << frac;
-    }
+std::string DateToString(const int32_t value) {
+    std::string out;
+    AppendDate(out, value);
+    return out;
+}
 
-    return out.str();
+std::string TimestampToString(const int64_t value) {
+    std::string out;
+    AppendTimestamp(out, value);
+    return out;
 }
 
 ColumnType ParseColumnType(const std::string_view input) {
@@ -0,0 +1,50 @@
+#include "common/thread_pool.h"
+
+#include <algorithm>
+#include <utility>
+
+ThreadPool::ThreadPool(const size_t threads) {
+    const size_t count = std::max<size_t>(threads, 1);
+    workers_.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        workers_.emplace_back([this] { WorkerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+    }
+    ready_.notify_all();
+
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+size_t ThreadPool::DefaultThreadCount() { return std::max<size_t>(std::thread::hardware_concurrency(), 1); }
+
+void ThreadPool::Enqueue(std::function<void()> task) {
+    {
+        std::lock_guard lock(mutex_);
+        tasks_.push_back(std::move(task));
+    }
+    ready_.notify_one();
+}
+
+void ThreadPool::WorkerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock lock(mutex_);
+            ready_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+            if (tasks_.empty()) {
+                return;
+            }
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        task();
+    }
+}
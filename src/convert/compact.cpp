@@ -0,0 +1,151 @@
+#include "convert/compact.h"
+
+#include <algorithm>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "common/error.h"
+#include "convert/external_sort.h"
+#include "convert/pipeline.h"
+#include "io/file.h"
+
+// target_rows, lowered so that a row group of average input rows stays within target_bytes.
+static size_t OutputRowGroupRows(const ColumnarMetadata& metadata, const CompactOptions& options) {
+    if (options.target_bytes == 0) {
+        return options.target_rows;
+    }
+
+    uint64_t rows = 0;
+    uint64_t bytes = 0;
+    for (const auto& row_group : metadata.row_groups) {
+        rows += row_group.row_count;
+        for (const auto& chunk : row_group.columns) {
+            bytes += chunk.uncompressed_size;
+        }
+    }
+    if (rows == 0 || bytes == 0) {
+        return options.target_rows;
+    }
+
+    const uint64_t row_bytes = std::max<uint64_t>(bytes / rows, 1);
+    return static_cast<size_t>(std::clamp<uint64_t>(options.target_bytes / row_bytes, 1, options.target_rows));
+}
+
+static void KeepInputStatistics(const ColumnarMetadata& metadata, ColumnarWriteOptions& options) {
+    const auto keep = [](std::vector<std::string>& names, const std::string& name) {
+        if (std::ranges::find(names, name) == names.end()) {
+            names.push_back(name);
+        }
+    };
+
+    for (const auto& row_group : metadata.row_groups) {
+        for (size_t column = 0; column < row_group.columns.size(); ++column) {
+            const std::string& name = metadata.schema.columns[column].name;
+            if (!row_group.columns[column].bloom_filter.Empty()) {
+                keep(options.bloom_filter_columns, name);
+            }
+            if (row_group.columns[column].distinct_sketch) {
+                keep(options.distinct_sketch_columns, name);
+            }
+        }
+    }
+}
+
+// Hands the input on in batches of exactly `rows` rows, except for the last one.
+template <class Emit>
+static void Regroup(ColumnarBatchReader& reader, const size_t rows, Emit&& emit) {
+    const Schema& schema = reader.GetSchema();
+    Batch pending(schema, rows);
+
+    while (std::optional<Batch> batch = reader.ReadNext()) {
+        if (pending.RowsCount() == 0 && batch->RowsCount() == rows) {
+            emit(std::move(*batch));
+            continue;
+        }
+
+        for (size_t begin = 0; begin < batch->RowsCount();) {
+            const size_t count = std::min(rows - pending.RowsCount(), batch->RowsCount() - begin);
+            pending.AppendRowsRangeFromBatch(*batch, begin, count);
+            begin += count;
+
+            if (pending.RowsCount() == rows) {
+                emit(std::exchange(pending, Batch(schema, rows)));
+            }
+        }
+    }
+
+    if (pending.RowsCount() > 0) {
+        emit(std::move(pending));
+    }
+}
+
+static void WriteCompacted(ColumnarBatchReader& reader, const std::filesystem::path& target,
+                           const CompactOptions& options) {
+    const Schema& schema = reader.GetSchema();
+    const std::vector<size_t> sort_columns = ResolveSortColumns(schema, options.sort.columns);
+    const size_t group_rows = OutputRowGroupRows(reader.GetMetadata(), options);
+
+    // Parallelism comes from encoding whole row groups at once here, not from the columns of one.
+    ColumnarWriteOptions write_options = options.write_options;
+    write_options.open_mode = FileOpenMode::Truncate;
+    write_options.encode_threads = 1;
+    KeepInputStatistics(reader.GetMetadata(), write_options);
+
+    ColumnarBatchWriter writer(target, schema, write_options);
+    ConvertPipeline encoder(writer, PipelineOptions{.encode_workers = options.threads});
+
+    if (sort_columns.empty()) {
+        Regroup(reader, group_rows, [&](Batch batch) { encoder.Submit(std::move(batch)); });
+    } else {
+        ExternalSorter sorter(schema, sort_columns, target);
+        Regroup(reader, options.sort.run_rows, [&](const Batch& batch) { sorter.Add(batch); });
+        sorter.Merge(encoder, group_rows);
+    }
+
+    encoder.Flush();
+    writer.Finalize();
+}
+
+void CompactColumnarFile(const std::filesystem::path& input, const std::filesystem::path& output,
+                         const CompactOptions& options) {
+    if (options.target_rows == 0) {
+        throw Error::InvalidArgument("convert", "row group size must be > 0");
+    }
+    if (!options.sort.columns.empty() && options.sort.run_rows == 0) {
+        throw Error::InvalidArgument("convert", "sort run size must be > 0");
+    }
+
+    std::error_code error;
+    const bool in_place = std::filesystem::equivalent(input, output, error);
+    // Replacing the file under a journal would leave the journal describing the wrong file.
+    if (in_place && !RollBackInterruptedAppend(input)) {
+        throw Error::InvalidState("convert", "an append to the file is in progress", input.string());
+    }
+
+    ColumnarBatchReader reader(input);
+    if (!in_place) {
+        WriteCompacted(reader, output, options);
+        return;
+    }
+
+    // Written next to the input and renamed over it, so the input stays intact until the new file is complete.
+    std::filesystem::path staged = output;
+    staged += ".compact";
+    try {
+        WriteCompacted(reader, staged, options);
+        // Durable before it replaces the only other copy of the rows.
+        SyncFile(staged);
+    } catch (...) {
+        std::filesystem::remove(staged, error);
+        throw;
+    }
+
+    std::filesystem::rename(staged, output, error);
+    if (error) {
+        throw Error::PathIo("convert", output, "replace with compacted file");
+    }
+    SyncParentDirectory(output);
+}
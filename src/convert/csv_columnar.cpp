@@ -1,31 +1,80 @@
 #include "convert/csv_columnar.h"
 
+#include <memory>
 #include <utility>
 
 #include "common/error.h"
+#include "convert/external_sort.h"
 #include "io/columnar_batch.h"
 #include "io/csv_batch.h"
 #include "model/schema_csv.h"
 
 void ConvertCsvToColumnar(const std::filesystem::path& schema_path, const std::filesystem::path& data_path,
                           const std::filesystem::path& output_path, const size_t max_rows_per_group,
-                          const Compression compression) {
+                          const Compression compression, const int compression_level) {
+    ConvertCsvToColumnar(schema_path, data_path, output_path, max_rows_per_group,
+                         ColumnarWriteOptions{.compression = compression, .compression_level = compression_level});
+}
+
+void ConvertCsvToColumnar(const std::filesystem::path& schema_path, const std::filesystem::path& data_path,
+                          const std::filesystem::path& output_path, const size_t max_rows_per_group,
+                          const ColumnarWriteOptions& options) {
+    ConvertCsvToColumnar(schema_path, data_path, output_path, max_rows_per_group, options, SortOptions{});
+}
+
+void ConvertCsvToColumnar(const std::filesystem::path& schema_path, const std::filesystem::path& data_path,
+                          const std::filesystem::path& output_path, const size_t max_rows_per_group,
+                          const ColumnarWriteOptions& options, const SortOptions& sort) {
+    ConvertCsvToColumnar(schema_path, data_path, output_path, max_rows_per_group, options, sort, PipelineOptions{});
+}
+
+void ConvertCsvToColumnar(const std::filesystem::path& schema_path, const std::filesystem::path& data_path,
+                          const std::filesystem::path& output_path, const size_t max_rows_per_group,
+                          const ColumnarWriteOptions& options, const SortOptions& sort,
+                          const PipelineOptions& pipeline) {
     if (max_rows_per_group == 0) {
         throw Error::InvalidArgument("convert", "row group size must be > 0");
     }
+    if (!sort.columns.empty() && sort.run_rows == 0) {
+        throw Error::InvalidArgument("convert", "sort run size must be > 0");
+    }
 
     const Schema schema = ReadSchemaCsv(schema_path);
+    const std::vector<size_t> sort_columns = ResolveSortColumns(schema, sort.columns);
 
     BatchSizing sizing;
-    sizing.max_rows = max_rows_per_group;
+    sizing.max_rows = sort_columns.empty() ? max_rows_per_group : sort.run_rows;
 
-    CsvBatchReader batch_reader(data_path, schema, sizing);
-    ColumnarBatchWriter batch_writer(output_path, schema, compression);
+    ColumnarWriteOptions write_options = options;
+    if (pipeline.encode_workers != 1) {
+        write_options.encode_threads = 1;
+    }
 
-    while (auto batch = batch_reader.ReadNext()) {
-        batch_writer.Write(*batch);
+    const size_t parse_workers =
+        pipeline.parse_workers == 0 ? ThreadPool::DefaultThreadCount() : pipeline.parse_workers;
+    std::unique_ptr<BatchReader> batch_reader;
+    if (parse_workers == 1) {
+        batch_reader = std::make_unique<CsvBatchReader>(data_path, schema, sizing);
+    } else {
+        batch_reader = std::make_unique<ParallelCsvBatchReader>(data_path, schema, sizing,
+                                                                CsvParallelOptions{.threads = parse_workers});
+    }
+    ColumnarBatchWriter batch_writer(output_path, schema, write_options);
+    ConvertPipeline encoder(batch_writer, pipeline);
+
+    if (sort_columns.empty()) {
+        while (auto batch = batch_reader->ReadNext()) {
+            encoder.Submit(std::move(*batch));
+        }
+    } else {
+        ExternalSorter sorter(schema, sort_columns, output_path);
+        while (auto batch = batch_reader->ReadNext()) {
+            sorter.Add(*batch);
+        }
+        sorter.Merge(encoder, max_rows_per_group);
     }
 
+    encoder.Flush();
     batch_writer.Finalize();
 }
 
@@ -41,5 +90,5 @@ void ConvertColumnarToCsv(const std::filesystem::path& columnar_path, const std:
         batch_writer.Write(*batch);
     }
 
-    batch_writer.Flush();
+    batch_writer.Finalize();
 }
@@ -0,0 +1,241 @@
+#include "convert/external_sort.h"
+
+#include <algorithm>
+#include <compare>
+#include <numeric>
+#include <queue>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+#include "common/error.h"
+#include "common/int128.h"
+#include "io/columnar_batch.h"
+#include "model/column_dictionary_string.h"
+#include "model/column_string.h"
+
+static constexpr size_t SpillRowGroupRows = 1 << 12;
+
+std::vector<size_t> ResolveSortColumns(const Schema& schema, const std::vector<std::string>& names) {
+    std::vector<size_t> columns;
+    columns.reserve(names.size());
+
+    for (const auto& name : names) {
+        const auto column = std::ranges::find(schema.columns, name, &ColumnSchema::name);
+        if (column == schema.columns.end()) {
+            throw Error::NotFound("convert", "sort column is not in the schema: " + name);
+        }
+        columns.push_back(static_cast<size_t>(column - schema.columns.begin()));
+    }
+
+    return columns;
+}
+
+// Key values of one batch, pulled out once so the comparisons of sorting and merging neither dispatch nor allocate.
+class BatchSortKeys {
+   public:
+    BatchSortKeys(const Batch& batch, const std::span<const size_t> key_columns) {
+        keys_.reserve(key_columns.size());
+
+        for (const size_t column_index : key_columns) {
+            const Column& column = batch.ColumnAt(column_index);
+            Key& key = keys_.emplace_back();
+            key.is_string = batch.GetSchema().columns[column_index].type == ColumnType::String;
+
+            if (!key.is_string) {
+                key.typed.reserve(column.Size());
+                for (size_t row = 0; row < column.Size(); ++row) {
+                    key.typed.push_back(column.ValueAsInt128(row));
+                }
+            } else if (const auto* dictionary_column = dynamic_cast<const DictionaryStringColumn*>(&column)) {
+                key.strings.reserve(column.Size());
+                for (size_t row = 0; row < column.Size(); ++row) {
+                    key.strings.push_back(dictionary_column->ValueAt(row));
+                }
+            } else if (const auto* string_column = dynamic_cast<const StringColumn*>(&column)) {
+                key.strings.reserve(column.Size());
+                for (size_t row = 0; row < column.Size(); ++row) {
+                    key.strings.push_back(string_column->ValueAt(row));
+                }
+            } else {
+                throw Error::InvalidState("convert", "unsupported string column representation");
+            }
+        }
+    }
+
+    std::strong_ordering Compare(const size_t row, const BatchSortKeys& other, const size_t other_row) const {
+        for (size_t i = 0; i < keys_.size(); ++i) {
+            const Key& lhs = keys_[i];
+            const Key& rhs = other.keys_[i];
+            const std::strong_ordering order =
+                lhs.is_string ? lhs.strings[row] <=> rhs.strings[other_row] : lhs.typed[row] <=> rhs.typed[other_row];
+            if (order != 0) {
+                return order;
+            }
+        }
+        return std::strong_ordering::equal;
+    }
+
+   private:
+    struct Key {
+        bool is_string = false;
+        std::vector<Int128> typed;
+        std::vector<std::string_view> strings;
+    };
+
+    std::vector<Key> keys_;
+};
+
+static Batch SortRun(const Batch& batch, const std::span<const size_t> key_columns) {
+    const BatchSortKeys keys(batch, key_columns);
+
+    std::vector<size_t> order(batch.RowsCount());
+    std::iota(order.begin(), order.end(), size_t{0});
+    std::ranges::stable_sort(order,
+                             [&](const size_t lhs, const size_t rhs) { return keys.Compare(lhs, keys, rhs) < 0; });
+
+    Batch sorted(batch.GetSchema(), order.size());
+    sorted.AppendRowsSelectedFromBatch(batch, order);
+    return sorted;
+}
+
+// One spilled run being merged: the row group currently loaded from it and the next row to emit.
+struct RunCursor {
+    ColumnarBatchReader reader;
+    Batch batch;
+    std::optional<BatchSortKeys> keys;
+    size_t row = 0;
+
+    bool Load(const std::span<const size_t> key_columns) {
+        while (auto next = reader.ReadNext()) {
+            if (next->RowsCount() == 0) {
+                continue;
+            }
+            batch = std::move(*next);
+            keys.emplace(batch, key_columns);
+            row = 0;
+            return true;
+        }
+        return false;
+    }
+
+    std::strong_ordering Compare(const RunCursor& other) const { return keys->Compare(row, *other.keys, other.row); }
+};
+
+ExternalSorter::ExternalSorter(Schema schema, std::vector<size_t> key_columns, std::filesystem::path spill_prefix)
+    : schema_(std::move(schema)), key_columns_(std::move(key_columns)), spill_prefix_(std::move(spill_prefix)) {
+    for (const size_t column_index : key_columns_) {
+        if (column_index >= schema_.columns.size()) {
+            throw Error::OutOfRange("convert", "sort key column index out of range");
+        }
+    }
+}
+
+ExternalSorter::~ExternalSorter() {
+    for (const auto& run : spilled_runs_) {
+        std::error_code ignored;
+        std::filesystem::remove(run, ignored);
+    }
+}
+
+void ExternalSorter::Add(const Batch& batch) {
+    if (batch.RowsCount() == 0) {
+        return;
+    }
+
+    // Dropped before the next run is sorted, so at most one sorted run is held alongside the input batch.
+    if (pending_run_) {
+        Spill(*pending_run_);
+        pending_run_.reset();
+    }
+    pending_run_ = SortRun(batch, key_columns_);
+}
+
+void ExternalSorter::Spill(const Batch& run) {
+    std::filesystem::path path = spill_prefix_;
+    path += ".run" + std::to_string(spilled_runs_.size());
+    spilled_runs_.push_back(path);
+
+    // Encoded on this thread: a spill file is written once and read back once, not worth a pool of its own.
+    ColumnarBatchWriter writer(path, schema_, ColumnarWriteOptions{.page_rows = 0, .encode_threads = 1});
+    for (size_t begin = 0; begin < run.RowsCount(); begin += SpillRowGroupRows) {
+        const size_t count = std::min(SpillRowGroupRows, run.RowsCount() - begin);
+        Batch slice(schema_, count);
+        slice.AppendRowsRangeFromBatch(run, begin, count);
+        writer.Write(slice);
+    }
+    writer.Finalize();
+}
+
+void ExternalSorter::Merge(BatchWriter& writer, const size_t rows_per_batch) {
+    if (rows_per_batch == 0) {
+        throw Error::InvalidArgument("convert", "merge batch size must be > 0");
+    }
+
+    if (spilled_runs_.empty()) {
+        if (pending_run_) {
+            const Batch& run = *pending_run_;
+            for (size_t begin = 0; begin < run.RowsCount(); begin += rows_per_batch) {
+                const size_t count = std::min(rows_per_batch, run.RowsCount() - begin);
+                Batch slice(schema_, count);
+                slice.AppendRowsRangeFromBatch(run, begin, count);
+                writer.Write(slice);
+            }
+            pending_run_.reset();
+        }
+        return;
+    }
+
+    if (pending_run_) {
+        Spill(*pending_run_);
+        pending_run_.reset();
+    }
+
+    std::vector<RunCursor> cursors;
+    cursors.reserve(spilled_runs_.size());
+    for (const auto& run : spilled_runs_) {
+        cursors.push_back(RunCursor{.reader = ColumnarBatchReader(run), .batch = Batch(schema_), .keys = {}, .row = 0});
+    }
+
+    // Ties go to the earlier run, which keeps the sort stable across runs.
+    const auto after = [&](const size_t lhs, const size_t rhs) {
+        const std::strong_ordering order = cursors[lhs].Compare(cursors[rhs]);
+        return order != 0 ? order > 0 : lhs > rhs;
+    };
+    std::priority_queue<size_t, std::vector<size_t>, decltype(after)> heap(after);
+    for (size_t i = 0; i < cursors.size(); ++i) {
+        if (cursors[i].Load(key_columns_)) {
+            heap.push(i);
+        }
+    }
+
+    Batch output(schema_, rows_per_batch);
+    while (!heap.empty()) {
+        const size_t current = heap.top();
+        heap.pop();
+        RunCursor& cursor = cursors[current];
+
+        // Emit the longest stretch of this run that still sorts before every other run's next row.
+        const size_t begin = cursor.row;
+        const size_t limit = std::min(cursor.batch.RowsCount(), begin + rows_per_batch - output.RowsCount());
+        do {
+            ++cursor.row;
+        } while (cursor.row < limit && (heap.empty() || !after(current, heap.top())));
+        output.AppendRowsRangeFromBatch(cursor.batch, begin, cursor.row - begin);
+
+        if (output.RowsCount() == rows_per_batch) {
+            writer.Write(output);
+            output = Batch(schema_, rows_per_batch);
+        }
+
+        if (cursor.row < cursor.batch.RowsCount() || cursor.Load(key_columns_)) {
+            heap.push(current);
+        }
+    }
+
+    if (output.RowsCount() > 0) {
+        writer.Write(output);
+    }
+}
@@ -0,0 +1,138 @@
+#include "convert/pipeline.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "common/error.h"
+
+static size_t EncodeWorkers(const PipelineOptions& options) {
+    return options.encode_workers == 0 ? ThreadPool::DefaultThreadCount() : options.encode_workers;
+}
+
+ConvertPipeline::ConvertPipeline(ColumnarBatchWriter& writer, const PipelineOptions& options)
+    : writer_(writer),
+      reorder_window_(EncodeWorkers(options) + std::max<size_t>(options.queue_batches, 1)),
+      encode_queue_(options.queue_batches),
+      pool_(EncodeWorkers(options) + 1) {
+    const size_t encode_workers = pool_.ThreadCount() - 1;
+    stages_.reserve(encode_workers + 1);
+    stages_.push_back(pool_.Submit([this] { WriteStage(); }));
+    for (size_t i = 0; i < encode_workers; ++i) {
+        stages_.push_back(pool_.Submit([this] { EncodeStage(); }));
+    }
+}
+
+ConvertPipeline::~ConvertPipeline() {
+    {
+        const std::lock_guard lock(mutex_);
+        stopping_ = true;
+        changed_.notify_all();
+    }
+    Stop();
+}
+
+void ConvertPipeline::Submit(Batch batch) {
+    uint64_t sequence = 0;
+    {
+        const std::lock_guard lock(mutex_);
+        if (error_) {
+            std::rethrow_exception(error_);
+        }
+        if (closed_) {
+            throw Error::InvalidState("convert", "pipeline already flushed");
+        }
+        sequence = submitted_++;
+    }
+
+    if (!encode_queue_.Push(PendingBatch{.sequence = sequence, .batch = std::move(batch)})) {
+        RethrowFailure();
+    }
+}
+
+void ConvertPipeline::Flush() {
+    {
+        const std::lock_guard lock(mutex_);
+        closed_ = true;
+        changed_.notify_all();
+    }
+    Stop();
+    RethrowFailure();
+
+    writer_.Flush();
+}
+
+// A worker holds its batch back while it is too far ahead of the writer. The batch right after the last written one
+// is always inside the window, so the writer keeps moving.
+void ConvertPipeline::EncodeStage() {
+    try {
+        while (std::optional<PendingBatch> pending = encode_queue_.Pop()) {
+            {
+                std::unique_lock lock(mutex_);
+                changed_.wait(lock, [&] { return stopping_ || pending->sequence < written_ + reorder_window_; });
+                if (stopping_) {
+                    return;
+                }
+            }
+
+            EncodedRowGroup row_group = writer_.Encode(pending->batch);
+
+            const std::lock_guard lock(mutex_);
+            encoded_.emplace(pending->sequence, std::move(row_group));
+            changed_.notify_all();
+        }
+    } catch (...) {
+        Fail(std::current_exception());
+    }
+}
+
+void ConvertPipeline::WriteStage() {
+    try {
+        while (true) {
+            std::map<uint64_t, EncodedRowGroup>::node_type next;
+            {
+                std::unique_lock lock(mutex_);
+                changed_.wait(lock, [&] {
+                    return stopping_ || encoded_.contains(written_) || (closed_ && written_ == submitted_);
+                });
+                if (stopping_ || !encoded_.contains(written_)) {
+                    return;
+                }
+                next = encoded_.extract(written_);
+            }
+
+            writer_.WriteEncoded(std::move(next.mapped()));
+
+            const std::lock_guard lock(mutex_);
+            ++written_;
+            changed_.notify_all();
+        }
+    } catch (...) {
+        Fail(std::current_exception());
+    }
+}
+
+void ConvertPipeline::Fail(std::exception_ptr error) {
+    {
+        const std::lock_guard lock(mutex_);
+        if (!error_) {
+            error_ = std::move(error);
+        }
+        stopping_ = true;
+        changed_.notify_all();
+    }
+    encode_queue_.Close();
+}
+
+void ConvertPipeline::Stop() {
+    encode_queue_.Close();
+    for (const auto& stage : stages_) {
+        stage.wait();
+    }
+}
+
+void ConvertPipeline::RethrowFailure() {
+    const std::lock_guard lock(mutex_);
+    if (error_) {
+        std::rethrow_exception(error_);
+    }
+}
@@ -6,8 +6,10 @@
 
 #include "common/ascii.h"
 #include "common/error.h"
+#include "common/hyperloglog.h"
 #include "common/int128.h"
 #include "common/parsing.h"
+#include "common/stable_hash.h"
 #include "common/string_arena.h"
 #include "executor/aggregate_function.h"
 #include "executor/aggregate_state.h"
@@ -22,6 +24,10 @@ void AggState::ConsumeRows(const size_t count) {
     }
 }
 
+void AggState::ConsumeSketch(const HyperLogLog&) {
+    throw Error::InvalidState("executor", "aggregate cannot consume a distinct sketch");
+}
+
 static bool ShouldReplaceExtremum(const ColumnType type, const std::string_view candidate,
                                   const std::string_view current, const bool is_min) {
     return VisitColumnType(type, [&]<ColumnType TypeValue>() {
@@ -152,6 +158,28 @@ class DistinctAS final : public AggState {
     StringViewSet seen_;
 };
 
+// Hashes values exactly as the columnar writer does for chunk sketches, so the two can be merged.
+class ApproxCountDistinctAS final : public AggState {
+   public:
+    explicit ApproxCountDistinctAS(const ColumnType type) : type_(type) {}
+
+    void ConsumeValue(const std::string_view value) override {
+        sketch_.Insert(type_ == ColumnType::String ? StableHash(value)
+                                                   : StableHash(ParseColumnValueAsInt128(type_, value)));
+    }
+
+    void ConsumeInt128(const Int128 value) override { sketch_.Insert(StableHash(value)); }
+    void ConsumeRow() override { throw Error::InvalidState("executor", "APPROX_COUNT_DISTINCT requires a value"); }
+    void ConsumeSketch(const HyperLogLog& sketch) override { sketch_.Merge(sketch); }
+
+    std::string Finalize() const override { return std::to_string(sketch_.Estimate()); }
+
+   private:
+    ColumnType type_;
+
+    HyperLogLog sketch_;
+};
+
 static bool SupportsAnyType(const ColumnType) { return true; }
 
 static std::unique_ptr<AggState> CreateCountState(const PlannedAgg&) { return std::make_unique<CountAS>(); }
@@ -172,6 +200,10 @@ static std::unique_ptr<AggState> CreateMaxState(const PlannedAgg& aggregate) {
     return std::make_unique<ExtremumAS>(aggregate.input_type, false);
 }
 
+static std::unique_ptr<AggState> CreateApproxCountDistinctState(const PlannedAgg& aggregate) {
+    return std::make_unique<ApproxCountDistinctAS>(aggregate.input_type);
+}
+
 AggRegistry& AggRegistry::Instance() {
     static AggRegistry instance;
     return instance;
@@ -220,6 +252,12 @@ AggRegistrar::AggRegistrar(const AggFuncDefinition& def) { AggRegistry::Instance
     .factory = &CreateMaxState,
 });
 
+[[maybe_unused]] static AggRegistrar register_approx_count_distinct({
+    .canonical_name = "APPROX_COUNT_DISTINCT",
+    .supports_type = &SupportsAnyType,
+    .factory = &CreateApproxCountDistinctState,
+});
+
 const AggFuncDefinition& ResolveAggFunc(const std::string_view name) {
     const AggFuncDefinition* definition = AggRegistry::Instance().Find(name);
     if (definition == nullptr) {
@@ -54,7 +54,7 @@ bool MatchesComparison(const ColumnType type, const std::string_view lhs, const
 ColumnType AggregateOutputType(const PlannedAgg& aggregate) {
     const std::string name = ToUpperAscii(aggregate.function->canonical_name);
 
-    if (name == "COUNT") {
+    if (name == "COUNT" || name == "APPROX_COUNT_DISTINCT") {
         return ColumnType::Int64;
     }
 
@@ -14,7 +14,13 @@ void Executor::RegisterTable(const std::string& name, std::filesystem::path path
 
 void Executor::SetUnsupportedFallbackEnabled(const bool enabled) { unsupported_fallback_enabled_ = enabled; }
 
-PlannedQuery Executor::Plan(const Query& query) const { return PlanQuery(query, tables_); }
+void Executor::SetScanOptions(const ScanOptions options) { scan_options_ = options; }
+
+PlannedQuery Executor::Plan(const Query& query) const {
+    PlannedQuery planned = PlanQuery(query, tables_);
+    planned.scan_options = scan_options_;
+    return planned;
+}
 
 ExecuteExpected Executor::Execute(const std::string_view query) const {
     try {
@@ -3,14 +3,16 @@
 
 std::unique_ptr<Operator> BuildPlan(const PlannedQuery& planned) {
     if (planned.metadata_count_only) {
-        return CreateMetadataCountOperator(planned.table_path, planned.aggregates.front().output_name);
+        return CreateMetadataCountOperator(planned.table_files, planned.aggregates.front().output_name);
     }
 
     if (planned.metadata_extrema_only) {
-        return CreateMetadataExtremaOperator(planned.table_path, planned.aggregates);
+        return CreateMetadataExtremaOperator(planned.table_files, planned.aggregates);
     }
 
-    std::unique_ptr<Operator> root = CreateScanOperator(planned.table_path, planned.projection_indexes, planned.filter);
+    std::unique_ptr<Operator> root = CreateTableScanOperator(planned.table_files, planned.table_schema,
+                                                             planned.projection_indexes, planned.filter,
+                                                             planned.scan_options);
 
     if (planned.filter && planned.plain_select) {
         root = CreateFilterOperator(std::move(root), planned.filter);
@@ -16,6 +16,7 @@
 #include "executor/comparison_utils.h"
 #include "executor/operators_internal.h"
 #include "executor/typed_value_utils.h"
+#include "model/column_dictionary_string.h"
 
 constexpr std::string_view ExtractMinutePart = "MINUTE";
 constexpr std::string_view ExtractHourPart = "HOUR";
@@ -442,13 +443,15 @@ struct TypedGroupKeyEqual {
 
 class GroupKeyMaterializer {
    public:
-    explicit GroupKeyMaterializer(std::vector<PlannedGroupKey> group_keys) : group_keys_(std::move(group_keys)) {}
+    explicit GroupKeyMaterializer(std::vector<PlannedGroupKey> group_keys)
+        : group_keys_(std::move(group_keys)), dictionary_keys_(group_keys_.size()) {}
 
     TypedGroupKey Materialize(const Batch& batch, const size_t row, StringArena& arena) const {
         TypedGroupKey key;
         key.values.reserve(group_keys_.size());
 
-        for (const auto& group_key : group_keys_) {
+        for (size_t key_index = 0; key_index < group_keys_.size(); ++key_index) {
+            const auto& group_key = group_keys_[key_index];
             if (group_key.column_type != ColumnType::String) {
                 if (const auto typed_value = TryEvalTypedGroupKeyInt(group_key.expression, batch, row);
                     typed_value.has_value()) {
@@ -465,7 +468,8 @@ class GroupKeyMaterializer {
                 key.values.push_back(GroupKeyComponent{
                     .type = group_key.column_type,
                     .int_value = 0,
-                    .string_value = arena.Store(batch.ColumnAt(group_key.expression->column_index).ValueAsString(row)),
+                    .string_value = StoreStringKey(batch.ColumnAt(group_key.expression->column_index), row,
+                                                   dictionary_keys_[key_index], arena),
                 });
                 continue;
             }
@@ -490,7 +494,34 @@ class GroupKeyMaterializer {
     }
 
    private:
+    // Arena copies of the dictionary entries seen so far, so each distinct value is stored once per dictionary.
+    struct DictionaryKeys {
+        std::shared_ptr<const DictionaryStringColumn::Dictionary> dictionary;
+        std::vector<std::optional<std::string_view>> stored;
+    };
+
+    static std::string_view StoreStringKey(const Column& column, const size_t row, DictionaryKeys& keys,
+                                           StringArena& arena) {
+        const auto* dictionary_column = dynamic_cast<const DictionaryStringColumn*>(&column);
+        if (dictionary_column == nullptr) {
+            return arena.Store(column.ValueAsString(row));
+        }
+
+        if (keys.dictionary != dictionary_column->GetDictionary()) {
+            keys.dictionary = dictionary_column->GetDictionary();
+            keys.stored.assign(keys.dictionary->size(), std::nullopt);
+        }
+
+        const uint32_t code = dictionary_column->Codes()[row];
+        auto& stored = keys.stored[code];
+        if (!stored) {
+            stored = arena.Store((*keys.dictionary)[code]);
+        }
+        return *stored;
+    }
+
     std::vector<PlannedGroupKey> group_keys_;
+    mutable std::vector<DictionaryKeys> dictionary_keys_;
 };
 
 class AggOperator final : public Operator {
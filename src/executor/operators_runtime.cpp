@@ -10,6 +10,7 @@
 #include "common/error.h"
 #include "common/parsing.h"
 #include "common/string_pattern_utils.h"
+#include "executor/aggregate_function.h"
 #include "executor/comparison_utils.h"
 #include "executor/operators_internal.h"
 #include "executor/query_utils.h"
@@ -31,9 +32,7 @@ constexpr std::string_view RegexBackrefReplacement = "$1";
 
 Int128 EvalInt(const std::string& value) { return ParseInt128(value); }
 
-bool IsAggregateLookupFunction(const std::string_view name) {
-    return name == "COUNT" || name == "SUM" || name == "AVG" || name == "MIN" || name == "MAX";
-}
+bool IsAggregateLookupFunction(const std::string_view name) { return AggRegistry::Instance().Find(name) != nullptr; }
 
 std::string FormatAggregateExprName(const ExprSpec& expr) {
     const std::string name = ToUpperAscii(expr.function_name);
@@ -1,18 +1,32 @@
 #include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string_view>
 #include <utility>
+#include <vector>
 
 #include "common/ascii.h"
 #include "common/error.h"
+#include "common/stable_hash.h"
+#include "common/thread_pool.h"
 #include "executor/aggregate_state.h"
 #include "executor/comparison_utils.h"
 #include "executor/operators_internal.h"
+#include "executor/typed_value_utils.h"
 #include "io/columnar_batch.h"
 #include "io/file.h"
+#include "io/io_scheduler.h"
+#include "io/metadata_cache.h"
 
 class MetadataCountOperator final : public Operator {
    public:
-    MetadataCountOperator(std::filesystem::path path, std::string output_name)
-        : path_(std::move(path)), output_name_(std::move(output_name)) {}
+    MetadataCountOperator(std::vector<std::filesystem::path> paths, std::string output_name)
+        : paths_(std::move(paths)), output_name_(std::move(output_name)) {}
 
     std::optional<Batch> Next() override {
         if (returned_) {
@@ -23,9 +37,11 @@ class MetadataCountOperator final : public Operator {
 
         uint64_t rows = 0;
 
-        const ColumnarBatchReader reader(path_);
-        for (const auto& row_group : reader.GetMetadata().row_groups) {
-            rows += row_group.row_count;
+        for (const auto& path : paths_) {
+            const std::shared_ptr<const MetadataView> metadata = MetadataCache::Instance().Get(path);
+            for (size_t row_group = 0; row_group < metadata->RowGroupCount(); ++row_group) {
+                rows += metadata->RowCount(row_group);
+            }
         }
 
         Batch result(Schema{{ColumnSchema(output_name_, ColumnType::Int64)}}, 1);
@@ -35,7 +51,7 @@ class MetadataCountOperator final : public Operator {
     }
 
    private:
-    std::filesystem::path path_;
+    std::vector<std::filesystem::path> paths_;
     std::string output_name_;
 
     bool returned_ = false;
@@ -43,8 +59,8 @@ class MetadataCountOperator final : public Operator {
 
 class MetadataExtremaOperator final : public Operator {
    public:
-    MetadataExtremaOperator(std::filesystem::path path, std::vector<PlannedAgg> aggregates)
-        : path_(std::move(path)), aggregates_(std::move(aggregates)) {}
+    MetadataExtremaOperator(std::vector<std::filesystem::path> paths, std::vector<PlannedAgg> aggregates)
+        : paths_(std::move(paths)), aggregates_(std::move(aggregates)) {}
 
     std::optional<Batch> Next() override {
         if (returned_) {
@@ -53,9 +69,6 @@ class MetadataExtremaOperator final : public Operator {
 
         returned_ = true;
 
-        const ColumnarBatchReader reader(path_);
-        const ColumnarMetadata& metadata = reader.GetMetadata();
-
         Schema schema;
         schema.columns.reserve(aggregates_.size());
 
@@ -67,18 +80,8 @@ class MetadataExtremaOperator final : public Operator {
             states.push_back(CreateAggState(aggregate));
         }
 
-        for (const auto& row_group : metadata.row_groups) {
-            for (size_t i = 0; i < aggregates_.size(); ++i) {
-                const PlannedAgg& aggregate = aggregates_[i];
-                const auto& chunk = row_group.columns[aggregate.column_index];
-
-                if (!chunk.has_min_max) {
-                    throw Error::InvalidState("executor", "metadata min/max statistics are missing", path_.string());
-                }
-
-                const std::string name = ToUpperAscii(aggregate.function->canonical_name);
-                states[i]->ConsumeInt128(name == "MIN" ? chunk.min_value : chunk.max_value);
-            }
+        for (const auto& path : paths_) {
+            ConsumeFile(path, states);
         }
 
         Batch result(schema);
@@ -90,61 +93,145 @@ class MetadataExtremaOperator final : public Operator {
     }
 
    private:
-    std::filesystem::path path_;
+    void ConsumeFile(const std::filesystem::path& path, std::vector<std::unique_ptr<AggState>>& states) const {
+        const std::shared_ptr<const MetadataView> metadata = MetadataCache::Instance().Get(path);
+
+        for (size_t row_group = 0; row_group < metadata->RowGroupCount(); ++row_group) {
+            for (size_t i = 0; i < aggregates_.size(); ++i) {
+                const PlannedAgg& aggregate = aggregates_[i];
+
+                const std::string name = ToUpperAscii(aggregate.function->canonical_name);
+                if (name == "APPROX_COUNT_DISTINCT") {
+                    const auto sketch = metadata->DistinctSketch(row_group, aggregate.column_index);
+                    if (!sketch) {
+                        throw Error::InvalidState("executor", "metadata distinct sketch is missing", path.string());
+                    }
+                    states[i]->ConsumeSketch(*sketch);
+                    continue;
+                }
+
+                const ColumnChunkMetadata chunk = metadata->Chunk(row_group, aggregate.column_index);
+                if (!chunk.has_min_max) {
+                    throw Error::InvalidState("executor", "metadata min/max statistics are missing", path.string());
+                }
+
+                states[i]->ConsumeInt128(name == "MIN" ? chunk.min_value : chunk.max_value);
+            }
+        }
+    }
+
+    std::vector<std::filesystem::path> paths_;
     std::vector<PlannedAgg> aggregates_;
 
     bool returned_ = false;
 };
 
-bool MatchesRowGroupComparison(const ColumnChunkMetadata& chunk, const Int128 value, const ComparisonKind comparison) {
-    if (!chunk.has_min_max) {
+bool MatchesZoneComparison(const std::optional<ZoneMap>& zone, const Int128 value, const ComparisonKind comparison) {
+    if (!zone) {
         return true;
     }
 
     switch (comparison) {
         case ComparisonKind::Equal:
-            return chunk.min_value <= value && value <= chunk.max_value;
+            return zone->min_value <= value && value <= zone->max_value;
         case ComparisonKind::NotEqual:
-            return chunk.min_value != value || chunk.max_value != value;
+            return zone->min_value != value || zone->max_value != value;
         case ComparisonKind::Less:
-            return chunk.min_value < value;
+            return zone->min_value < value;
         case ComparisonKind::LessOrEqual:
-            return chunk.min_value <= value;
+            return zone->min_value <= value;
         case ComparisonKind::Greater:
-            return chunk.max_value > value;
+            return zone->max_value > value;
         case ComparisonKind::GreaterOrEqual:
-            return chunk.max_value >= value;
+            return zone->max_value >= value;
     }
 
     return true;
 }
 
-bool MayMatchRowGroup(const PredicatePtr& predicate, const RowGroupMetadata& row_group) {
+// zone_of(chunk) returns the min/max to test for that chunk, or nullopt when it may hold anything.
+template <class ZoneOf>
+bool MayMatchZones(const PredicatePtr& predicate, const RowGroupMetadata& row_group, const ZoneOf& zone_of) {
     if (!predicate) {
         return true;
     }
 
     switch (predicate->kind) {
         case PredicateKind::And:
-            return MayMatchRowGroup(predicate->lhs, row_group) && MayMatchRowGroup(predicate->rhs, row_group);
+            return MayMatchZones(predicate->lhs, row_group, zone_of) &&
+                   MayMatchZones(predicate->rhs, row_group, zone_of);
         case PredicateKind::Comparison:
             if (!predicate->metadata_typed_literal_comparison_bound ||
                 predicate->metadata_typed_column_index >= row_group.columns.size()) {
                 return true;
             }
-            return MatchesRowGroupComparison(row_group.columns[predicate->metadata_typed_column_index],
-                                             predicate->metadata_typed_literal_value,
-                                             predicate->metadata_typed_comparison);
-        case PredicateKind::In:
+            return MatchesZoneComparison(zone_of(row_group.columns[predicate->metadata_typed_column_index]),
+                                         predicate->metadata_typed_literal_value,
+                                         predicate->metadata_typed_comparison);
+        case PredicateKind::In: {
             if (!predicate->metadata_typed_in_set_bound ||
                 predicate->metadata_typed_in_column_index >= row_group.columns.size()) {
                 return true;
             }
 
+            const auto zone = zone_of(row_group.columns[predicate->metadata_typed_in_column_index]);
             return std::ranges::any_of(predicate->metadata_typed_in_values, [&](const Int128 value) {
-                return MatchesRowGroupComparison(row_group.columns[predicate->metadata_typed_in_column_index], value,
-                                                 ComparisonKind::Equal);
+                return MatchesZoneComparison(zone, value, ComparisonKind::Equal);
             });
+        }
+        case PredicateKind::Like:
+        case PredicateKind::NotLike:
+            return true;
+    }
+
+    return true;
+}
+
+std::optional<ZoneMap> ChunkZone(const ColumnChunkMetadata& chunk) {
+    if (!chunk.has_min_max) {
+        return std::nullopt;
+    }
+    return ZoneMap{chunk.min_value, chunk.max_value};
+}
+
+bool MayContainValue(const RowGroupMetadata& row_group, const size_t column_index, const uint64_t hash) {
+    return column_index >= row_group.columns.size() || row_group.columns[column_index].bloom_filter.MayContain(hash);
+}
+
+// Equality and IN only; the rest of the predicate is left to the zone maps.
+bool MayPassBloomFilters(const PredicatePtr& predicate, const RowGroupMetadata& row_group) {
+    if (!predicate) {
+        return true;
+    }
+
+    switch (predicate->kind) {
+        case PredicateKind::And:
+            return MayPassBloomFilters(predicate->lhs, row_group) && MayPassBloomFilters(predicate->rhs, row_group);
+        case PredicateKind::Comparison:
+            if (predicate->metadata_typed_literal_comparison_bound &&
+                predicate->metadata_typed_comparison == ComparisonKind::Equal) {
+                return MayContainValue(row_group, predicate->metadata_typed_column_index,
+                                       StableHash(predicate->metadata_typed_literal_value));
+            }
+            if (predicate->metadata_string_comparison_bound &&
+                predicate->metadata_string_comparison == ComparisonKind::Equal) {
+                return MayContainValue(row_group, predicate->metadata_string_column_index,
+                                       StableHash(std::string_view(predicate->metadata_string_value)));
+            }
+            return true;
+        case PredicateKind::In:
+            if (predicate->metadata_typed_in_set_bound) {
+                return std::ranges::any_of(predicate->metadata_typed_in_values, [&](const Int128 value) {
+                    return MayContainValue(row_group, predicate->metadata_typed_in_column_index, StableHash(value));
+                });
+            }
+            if (predicate->metadata_string_in_set_bound) {
+                return std::ranges::any_of(predicate->literal_in_values, [&](const std::string& value) {
+                    return MayContainValue(row_group, predicate->metadata_string_in_column_index,
+                                           StableHash(std::string_view(value)));
+                });
+            }
+            return true;
         case PredicateKind::Like:
         case PredicateKind::NotLike:
             return true;
@@ -153,14 +240,242 @@ bool MayMatchRowGroup(const PredicatePtr& predicate, const RowGroupMetadata& row
     return true;
 }
 
+bool MatchesStringComparison(const ColumnChunkMetadata& chunk, const uint32_t row_count, const std::string_view value,
+                             const ComparisonKind comparison) {
+    if (!chunk.has_string_stats) {
+        return true;
+    }
+
+    const std::string_view min_value = chunk.string_min;
+    const std::string_view max_value = chunk.string_max;
+
+    switch (comparison) {
+        case ComparisonKind::Equal:
+            if (value.empty()) {
+                return chunk.empty_count > 0;
+            }
+            return chunk.empty_count < row_count && value.size() <= chunk.max_length && min_value <= value &&
+                   value <= max_value;
+        case ComparisonKind::NotEqual:
+            if (value.empty()) {
+                return chunk.empty_count < row_count;
+            }
+            return min_value != value || max_value != value;
+        case ComparisonKind::Less:
+            return min_value < value;
+        case ComparisonKind::LessOrEqual:
+            return min_value <= value;
+        case ComparisonKind::Greater:
+            return max_value > value;
+        case ComparisonKind::GreaterOrEqual:
+            return max_value >= value;
+    }
+
+    return true;
+}
+
+bool MatchesStringLike(const ColumnChunkMetadata& chunk, const std::string_view pattern, const bool negated) {
+    if (!chunk.has_string_stats) {
+        return true;
+    }
+
+    const size_t wildcard = pattern.find_first_of("%_");
+    const std::string_view prefix = pattern.substr(0, wildcard);
+    const std::string_view min_value = chunk.string_min;
+    const std::string_view max_value = chunk.string_max;
+
+    if (negated) {
+        // Only 'prefix%' is ruled out, when the bounds show every value starts with the prefix.
+        if (prefix.empty() || wildcard == std::string_view::npos || pattern.substr(wildcard) != "%") {
+            return true;
+        }
+        return !min_value.starts_with(prefix) || !max_value.starts_with(prefix);
+    }
+
+    const auto required_length = static_cast<size_t>(std::ranges::count_if(pattern, [](const char c) {
+        return c != '%';
+    }));
+    if (required_length > chunk.max_length) {
+        return false;
+    }
+
+    return prefix.empty() || (max_value >= prefix && (min_value < prefix || min_value.starts_with(prefix)));
+}
+
+bool MayMatchStringStats(const PredicatePtr& predicate, const RowGroupMetadata& row_group) {
+    if (!predicate) {
+        return true;
+    }
+
+    const auto chunk_at = [&](const size_t column_index) -> const ColumnChunkMetadata* {
+        return column_index < row_group.columns.size() ? &row_group.columns[column_index] : nullptr;
+    };
+
+    switch (predicate->kind) {
+        case PredicateKind::And:
+            return MayMatchStringStats(predicate->lhs, row_group) && MayMatchStringStats(predicate->rhs, row_group);
+        case PredicateKind::Comparison: {
+            const ColumnChunkMetadata* chunk = chunk_at(predicate->metadata_string_column_index);
+            if (!predicate->metadata_string_comparison_bound || chunk == nullptr) {
+                return true;
+            }
+            return MatchesStringComparison(*chunk, row_group.row_count, predicate->metadata_string_value,
+                                           predicate->metadata_string_comparison);
+        }
+        case PredicateKind::In: {
+            const ColumnChunkMetadata* chunk = chunk_at(predicate->metadata_string_in_column_index);
+            if (!predicate->metadata_string_in_set_bound || chunk == nullptr) {
+                return true;
+            }
+            return std::ranges::any_of(predicate->literal_in_values, [&](const std::string& value) {
+                return MatchesStringComparison(*chunk, row_group.row_count, value, ComparisonKind::Equal);
+            });
+        }
+        case PredicateKind::Like:
+        case PredicateKind::NotLike: {
+            const ColumnChunkMetadata* chunk = chunk_at(predicate->metadata_like_column_index);
+            if (!predicate->literal_like_pattern_bound || chunk == nullptr) {
+                return true;
+            }
+            return MatchesStringLike(*chunk, predicate->like_pattern, predicate->like_negated);
+        }
+    }
+
+    return true;
+}
+
+// Source columns whose chunk statistics the pruning functions above may look at.
+void CollectMetadataColumns(const PredicatePtr& predicate, std::vector<size_t>& columns) {
+    if (!predicate) {
+        return;
+    }
+
+    switch (predicate->kind) {
+        case PredicateKind::And:
+            CollectMetadataColumns(predicate->lhs, columns);
+            CollectMetadataColumns(predicate->rhs, columns);
+            return;
+        case PredicateKind::Comparison:
+            if (predicate->metadata_typed_literal_comparison_bound) {
+                columns.push_back(predicate->metadata_typed_column_index);
+            }
+            if (predicate->metadata_string_comparison_bound) {
+                columns.push_back(predicate->metadata_string_column_index);
+            }
+            return;
+        case PredicateKind::In:
+            if (predicate->metadata_typed_in_set_bound) {
+                columns.push_back(predicate->metadata_typed_in_column_index);
+            }
+            if (predicate->metadata_string_in_set_bound) {
+                columns.push_back(predicate->metadata_string_in_column_index);
+            }
+            return;
+        case PredicateKind::Like:
+        case PredicateKind::NotLike:
+            if (predicate->literal_like_pattern_bound) {
+                columns.push_back(predicate->metadata_like_column_index);
+            }
+            return;
+    }
+}
+
+bool MayMatchRowGroup(const PredicatePtr& predicate, const RowGroupMetadata& row_group) {
+    return MayMatchZones(predicate, row_group, ChunkZone) && MayPassBloomFilters(predicate, row_group) &&
+           MayMatchStringStats(predicate, row_group);
+}
+
+bool MayMatchPartition(const PredicatePtr& predicate, const Schema& schema,
+                       const std::vector<std::pair<std::string, std::string>>& partition_values) {
+    if (!predicate || partition_values.empty()) {
+        return true;
+    }
+
+    // Every partition column becomes a one-value chunk; the other columns carry no statistics. Keys that name no
+    // column of the schema exist only in the path: queries cannot refer to them, so they never prune.
+    RowGroupMetadata partition;
+    partition.row_count = 1;
+    partition.columns.resize(schema.columns.size());
+
+    for (const auto& [key, value] : partition_values) {
+        const std::string name = ToLowerAscii(key);
+        const auto column = std::ranges::find_if(schema.columns, [&](const ColumnSchema& candidate) {
+            return ToLowerAscii(candidate.name) == name;
+        });
+        if (column == schema.columns.end()) {
+            continue;
+        }
+
+        ColumnChunkMetadata& chunk = partition.columns[static_cast<size_t>(column - schema.columns.begin())];
+        if (column->type == ColumnType::String) {
+            chunk.has_string_stats = true;
+            chunk.string_min = value;
+            chunk.string_max = value;
+            chunk.empty_count = value.empty() ? 1 : 0;
+            chunk.max_length = static_cast<uint32_t>(value.size());
+            continue;
+        }
+
+        // Values that do not parse, such as Hive's __HIVE_DEFAULT_PARTITION__, keep the file.
+        try {
+            chunk.min_value = chunk.max_value = ParseColumnValueAsInt128(column->type, value);
+            chunk.has_min_max = true;
+        } catch (const Error&) {
+        }
+    }
+
+    return MayMatchZones(predicate, partition, ChunkZone) && MayMatchStringStats(predicate, partition);
+}
+
+// Rows of the row group whose pages may satisfy the predicate, with adjacent pages merged. Chunks without page zone
+// maps of the same page size fall back to their chunk statistics.
+std::vector<RowRange> MatchingPageRanges(const PredicatePtr& predicate, const RowGroupMetadata& row_group) {
+    const size_t row_count = row_group.row_count;
+
+    const auto paged = std::ranges::find_if(row_group.columns, [](const auto& chunk) { return !chunk.pages.empty(); });
+    if (!predicate || paged == row_group.columns.end()) {
+        return {{0, row_count}};
+    }
+
+    const uint32_t page_rows = paged->page_rows;
+    const size_t page_count = paged->pages.size();
+
+    std::vector<RowRange> ranges;
+    for (size_t page = 0; page < page_count; ++page) {
+        const bool may_match = MayMatchZones(predicate, row_group, [&](const ColumnChunkMetadata& chunk) {
+            if (chunk.page_rows == page_rows && chunk.pages.size() == page_count) {
+                return std::optional<ZoneMap>(chunk.pages[page]);
+            }
+            return ChunkZone(chunk);
+        });
+        if (!may_match) {
+            continue;
+        }
+
+        const size_t begin = page * page_rows;
+        const size_t count = std::min<size_t>(page_rows, row_count - begin);
+        if (!ranges.empty() && ranges.back().begin + ranges.back().count == begin) {
+            ranges.back().count += count;
+        } else {
+            ranges.push_back({begin, count});
+        }
+    }
+
+    return ranges;
+}
+
 class ScanOperator final : public Operator {
    public:
-    ScanOperator(std::filesystem::path path, std::vector<size_t> projection_indexes, PredicatePtr filter)
+    // Row groups are decoded on workers when given, and otherwise on a pool of the scan's own.
+    ScanOperator(std::filesystem::path path, std::vector<size_t> projection_indexes, PredicatePtr filter,
+                 const ScanOptions& options, ThreadPool* workers = nullptr)
         : path_(std::move(path)),
-          input_(path_),
-          metadata_(ColumnarBatchReader(path_).GetMetadata()),
-          filter_(std::move(filter)) {
-        if (metadata_.schema.columns.empty()) {
+          input_(ColumnarBatchReader::OpenFile(path_)),
+          metadata_(MetadataCache::Instance().Get(path_)),
+          filter_(std::move(filter)),
+          read_ahead_(options.read_ahead_row_groups) {
+        const Schema& schema = metadata_->GetSchema();
+        if (schema.columns.empty()) {
             throw Error::MalformedData("executor", "columnar schema is empty", path_.string());
         }
 
@@ -168,67 +483,359 @@ class ScanOperator final : public Operator {
         projected_schema_.columns.reserve(projection_indexes_.size());
 
         for (const size_t source_index : projection_indexes_) {
-            if (source_index >= metadata_.schema.columns.size()) {
+            if (source_index >= schema.columns.size()) {
                 throw Error::OutOfRange("executor", "projection index out of range", path_.string());
             }
 
-            projected_schema_.columns.push_back(metadata_.schema.columns[source_index]);
+            projected_schema_.columns.push_back(schema.columns[source_index]);
+        }
+
+        // Only these chunks are decoded from the footer; the others are never looked at by this scan.
+        decoded_columns_ = projection_indexes_;
+        CollectMetadataColumns(filter_, decoded_columns_);
+        std::erase_if(decoded_columns_, [&](const size_t column) { return column >= schema.columns.size(); });
+        std::ranges::sort(decoded_columns_);
+        decoded_columns_.erase(std::ranges::unique(decoded_columns_).begin(), decoded_columns_.end());
+
+        if (read_ahead_ > 0) {
+            pool_ = workers;
+            if (pool_ == nullptr) {
+                owned_pool_ = std::make_unique<ThreadPool>(
+                    options.worker_threads == 0 ? ThreadPool::DefaultThreadCount() : options.worker_threads);
+                pool_ = owned_pool_.get();
+            }
+            if (options.io == ScanIo::Scheduled) {
+                io_ = CreateIoScheduler(path_, options.io_backend,
+                                        std::max(DefaultIoQueueDepth, read_ahead_ * projection_indexes_.size()));
+            }
+        }
+    }
+
+    ScanOperator(const ScanOperator&) = delete;
+    ScanOperator& operator=(const ScanOperator&) = delete;
+
+    ~ScanOperator() override {
+        for (auto& pending : pending_) {
+            WaitTasks(pending);
         }
     }
 
     std::optional<Batch> Next() override {
-        if (next_group_ >= metadata_.row_groups.size()) {
+        if (!pool_) {
+            RowGroupMetadata row_group;
+            std::vector<RowRange> ranges;
+            if (!NextMatchingRowGroup(row_group, ranges)) {
+                return std::nullopt;
+            }
+
+            Batch batch(projected_schema_, RangeRows(ranges));
+            for (size_t projected_index = 0; projected_index < projection_indexes_.size(); ++projected_index) {
+                ReadProjectedChunk(row_group, ranges, batch, projected_index);
+            }
+            return batch;
+        }
+
+        FillReadAhead();
+        if (pending_.empty()) {
             return std::nullopt;
         }
 
-        const RowGroupMetadata* row_group = nullptr;
-        while (next_group_ < metadata_.row_groups.size()) {
-            const RowGroupMetadata& candidate = metadata_.row_groups[next_group_++];
-            if (MayMatchRowGroup(filter_, candidate)) {
-                row_group = &candidate;
-                break;
+        PendingRowGroup pending = std::move(pending_.front());
+        pending_.pop_front();
+        FillReadAhead();
+
+        WaitTasks(pending);
+        for (const auto& task : pending.tasks) {
+            task.get();
+        }
+
+        return std::move(*pending.batch);
+    }
+
+   private:
+    struct PendingRowGroup {
+        // Heap allocated so the read tasks can keep referring to it while the pending entry is moved around.
+        std::unique_ptr<RowGroupMetadata> row_group;
+        std::unique_ptr<Batch> batch;
+        std::vector<std::vector<uint8_t>> buffers;
+        std::vector<std::shared_future<void>> tasks;
+        // Only these rows of the row group are read; moving the vector keeps the storage the tasks refer to.
+        std::vector<RowRange> ranges;
+    };
+
+    bool NextMatchingRowGroup(RowGroupMetadata& row_group, std::vector<RowRange>& ranges) {
+        while (next_group_ < metadata_->RowGroupCount()) {
+            metadata_->DecodeRowGroup(next_group_++, decoded_columns_, row_group);
+            if (!MayMatchRowGroup(filter_, row_group)) {
+                continue;
+            }
+
+            ranges = MatchingPageRanges(filter_, row_group);
+            if (!ranges.empty()) {
+                return true;
             }
         }
+        return false;
+    }
 
-        if (row_group == nullptr) {
-            return std::nullopt;
+    void ReadProjectedChunk(const RowGroupMetadata& row_group, const std::span<const RowRange> ranges, Batch& batch,
+                            const size_t projected_index) const {
+        const auto& chunk = row_group.columns[projection_indexes_[projected_index]];
+        ReadBatchColumnChunkRanges(input_, chunk, row_group.row_count, ranges, batch, projected_index);
+    }
+
+    void FillReadAhead() {
+        while (pending_.size() < read_ahead_) {
+            PendingRowGroup pending;
+            pending.row_group = std::make_unique<RowGroupMetadata>();
+            if (!NextMatchingRowGroup(*pending.row_group, pending.ranges)) {
+                return;
+            }
+
+            const RowGroupMetadata* row_group = pending.row_group.get();
+
+            pending.batch = std::make_unique<Batch>(projected_schema_, RangeRows(pending.ranges));
+
+            if (io_) {
+                ScheduleRowGroupReads(*row_group, pending);
+            } else {
+                Batch* batch = pending.batch.get();
+                const std::span<const RowRange> ranges = pending.ranges;
+                for (size_t projected_index = 0; projected_index < projection_indexes_.size(); ++projected_index) {
+                    pending.tasks.push_back(pool_->Submit([this, row_group, ranges, batch, projected_index] {
+                        ReadProjectedChunk(*row_group, ranges, *batch, projected_index);
+                    }).share());
+                }
+            }
+
+            pending_.push_back(std::move(pending));
         }
+    }
 
-        Batch batch(projected_schema_, row_group->row_count);
+    // Uncompressed fixed-width chunks are read straight into the column storage, one read per selected range; the
+    // rest go through a buffer that is decoded once the whole batch of reads has completed.
+    void ScheduleRowGroupReads(const RowGroupMetadata& row_group, PendingRowGroup& pending) {
+        Batch& batch = *pending.batch;
+        const uint32_t row_count = row_group.row_count;
+        const std::span<const RowRange> ranges = pending.ranges;
+        const size_t selected_rows = RangeRows(pending.ranges);
+
+        std::vector<IoReadRequest> reads;
+        std::vector<size_t> decoded_indexes;
+        reads.reserve(projection_indexes_.size());
+        pending.buffers.resize(projection_indexes_.size());
 
         for (size_t projected_index = 0; projected_index < projection_indexes_.size(); ++projected_index) {
-            const size_t source_index = projection_indexes_[projected_index];
-            const auto& chunk = row_group->columns[source_index];
+            const auto& chunk = row_group.columns[projection_indexes_[projected_index]];
+            if (MaterializeFromStatistics(chunk, row_count, selected_rows, batch, projected_index)) {
+                continue;
+            }
+
+            const std::optional<uint64_t> width = PlainRowWidth(chunk, row_count);
+            if (width && chunk.compression == Compression::None && chunk.compressed_size == chunk.uncompressed_size) {
+                const auto target = batch.PrepareColumnRawRead(projected_index, static_cast<uint32_t>(selected_rows),
+                                                               selected_rows * *width);
+                if (target) {
+                    size_t written = 0;
+                    for (const auto& [begin, count] : ranges) {
+                        reads.push_back({chunk.offset + begin * *width, target->subspan(written, count * *width)});
+                        written += count * *width;
+                    }
+                    continue;
+                }
+            }
 
-            ReadBatchColumnChunk(path_, input_, chunk, row_group->row_count, batch, projected_index);
+            auto& buffer = pending.buffers[projected_index];
+            buffer.resize(chunk.compressed_size);
+            reads.push_back({chunk.offset, buffer});
+            decoded_indexes.push_back(projected_index);
         }
 
-        return batch;
+        const IoScheduler::Ticket ticket = io_->Submit(std::move(reads));
+        const std::shared_future<void> loaded = pool_->Submit([this, ticket] { io_->Wait(ticket); }).share();
+        pending.tasks.push_back(loaded);
+
+        for (const size_t projected_index : decoded_indexes) {
+            const auto& chunk = row_group.columns[projection_indexes_[projected_index]];
+            const std::span<const uint8_t> raw = pending.buffers[projected_index];
+            pending.tasks.push_back(pool_->Submit([&chunk, &batch, raw, ranges, loaded, row_count, projected_index] {
+                loaded.get();
+                DecodeBatchColumnChunkRanges(raw, chunk, row_count, ranges, batch, projected_index);
+            }).share());
+        }
+    }
+
+    static void WaitTasks(const PendingRowGroup& pending) {
+        for (const auto& task : pending.tasks) {
+            task.wait();
+        }
     }
 
-   private:
     std::filesystem::path path_;
-    InputFile input_;
+    MappedFile input_;
 
-    ColumnarMetadata metadata_;
+    std::shared_ptr<const MetadataView> metadata_;
     std::vector<size_t> projection_indexes_;
+    std::vector<size_t> decoded_columns_;
     Schema projected_schema_;
 
     PredicatePtr filter_;
 
     size_t next_group_ = 0;
+
+    size_t read_ahead_ = 0;
+    std::unique_ptr<IoScheduler> io_;
+    std::deque<PendingRowGroup> pending_;
+    std::unique_ptr<ThreadPool> owned_pool_;
+    ThreadPool* pool_ = nullptr;
+};
+
+// Scans up to concurrent_files files at once, each on its own thread filling a bounded queue, and hands the batches
+// out in file order so results do not depend on timing. Partition keys are not turned into columns: a key prunes
+// files only when the files also store it as a column, and path-only keys cannot be queried.
+class TableScanOperator final : public Operator {
+   public:
+    TableScanOperator(std::vector<std::filesystem::path> paths, Schema schema, std::vector<size_t> projection_indexes,
+                      PredicatePtr filter, const ScanOptions& options)
+        : paths_(std::move(paths)),
+          schema_(std::move(schema)),
+          projection_indexes_(std::move(projection_indexes)),
+          filter_(std::move(filter)),
+          options_(options),
+          queue_batches_(std::max<size_t>(options.read_ahead_row_groups, 1)),
+          workers_(options.worker_threads == 0 ? ThreadPool::DefaultThreadCount() : options.worker_threads),
+          pool_(std::clamp<size_t>(options.concurrent_files, 1, std::max<size_t>(paths_.size(), 1))) {
+        StartScans();
+    }
+
+    TableScanOperator(const TableScanOperator&) = delete;
+    TableScanOperator& operator=(const TableScanOperator&) = delete;
+
+    ~TableScanOperator() override {
+        for (const auto& scan : scans_) {
+            const std::lock_guard lock(scan->mutex);
+            scan->cancelled = true;
+            scan->changed.notify_all();
+        }
+        for (const auto& scan : scans_) {
+            scan->task.wait();
+        }
+    }
+
+    std::optional<Batch> Next() override {
+        while (!scans_.empty()) {
+            std::optional<Batch> batch = Pop(*scans_.front());
+            if (batch) {
+                return batch;
+            }
+
+            scans_.front()->task.get();
+            scans_.pop_front();
+            StartScans();
+        }
+        return std::nullopt;
+    }
+
+   private:
+    struct FileScan {
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::deque<Batch> batches;
+        std::exception_ptr error;
+        bool finished = false;
+        bool cancelled = false;
+        std::future<void> task;
+    };
+
+    void StartScans() {
+        while (next_file_ < paths_.size() && scans_.size() < pool_.ThreadCount()) {
+            auto scan = std::make_unique<FileScan>();
+            scan->task = pool_.Submit([this, file = scan.get(), path = paths_[next_file_]] { Produce(*file, path); });
+            scans_.push_back(std::move(scan));
+            ++next_file_;
+        }
+    }
+
+    void Produce(FileScan& scan, const std::filesystem::path& path) {
+        try {
+            if (MetadataCache::Instance().Get(path)->GetSchema() != schema_) {
+                throw Error::InconsistentData("executor", "file schema differs from the table schema", path.string());
+            }
+
+            ScanOperator input(path, projection_indexes_, filter_, options_, &workers_);
+            while (std::optional<Batch> batch = input.Next()) {
+                std::unique_lock lock(scan.mutex);
+                scan.changed.wait(lock, [&] { return scan.cancelled || scan.batches.size() < queue_batches_; });
+                if (scan.cancelled) {
+                    break;
+                }
+                scan.batches.push_back(std::move(*batch));
+                scan.changed.notify_all();
+            }
+        } catch (...) {
+            const std::lock_guard lock(scan.mutex);
+            scan.error = std::current_exception();
+        }
+
+        const std::lock_guard lock(scan.mutex);
+        scan.finished = true;
+        scan.changed.notify_all();
+    }
+
+    // Batches of a file come before its error, so a failure surfaces where it happened in the stream.
+    static std::optional<Batch> Pop(FileScan& scan) {
+        std::unique_lock lock(scan.mutex);
+        scan.changed.wait(lock, [&] { return !scan.batches.empty() || scan.finished; });
+
+        if (!scan.batches.empty()) {
+            Batch batch = std::move(scan.batches.front());
+            scan.batches.pop_front();
+            scan.changed.notify_all();
+            return batch;
+        }
+
+        if (scan.error) {
+            std::rethrow_exception(scan.error);
+        }
+        return std::nullopt;
+    }
+
+    std::vector<std::filesystem::path> paths_;
+    Schema schema_;
+    std::vector<size_t> projection_indexes_;
+    PredicatePtr filter_;
+    ScanOptions options_;
+    size_t queue_batches_ = 1;
+
+    size_t next_file_ = 0;
+    std::deque<std::unique_ptr<FileScan>> scans_;
+    // The file scans decode their row groups on one shared pool rather than each starting its own.
+    ThreadPool workers_;
+    ThreadPool pool_;
 };
 
-std::unique_ptr<Operator> CreateMetadataCountOperator(std::filesystem::path path, std::string output_name) {
-    return std::make_unique<MetadataCountOperator>(std::move(path), std::move(output_name));
+std::unique_ptr<Operator> CreateMetadataCountOperator(std::vector<std::filesystem::path> paths,
+                                                      std::string output_name) {
+    return std::make_unique<MetadataCountOperator>(std::move(paths), std::move(output_name));
 }
 
-std::unique_ptr<Operator> CreateMetadataExtremaOperator(std::filesystem::path path,
+std::unique_ptr<Operator> CreateMetadataExtremaOperator(std::vector<std::filesystem::path> paths,
                                                         std::vector<PlannedAgg> aggregates) {
-    return std::make_unique<MetadataExtremaOperator>(std::move(path), std::move(aggregates));
+    return std::make_unique<MetadataExtremaOperator>(std::move(paths), std::move(aggregates));
 }
 
 std::unique_ptr<Operator> CreateScanOperator(std::filesystem::path path, std::vector<size_t> projection_indexes,
-                                             PredicatePtr filter) {
-    return std::make_unique<ScanOperator>(std::move(path), std::move(projection_indexes), std::move(filter));
+                                             PredicatePtr filter, const ScanOptions options) {
+    return std::make_unique<ScanOperator>(std::move(path), std::move(projection_indexes), std::move(filter), options);
+}
+
+std::unique_ptr<Operator> CreateTableScanOperator(std::vector<std::filesystem::path> paths, Schema schema,
+                                                  std::vector<size_t> projection_indexes, PredicatePtr filter,
+                                                  const ScanOptions options) {
+    // The planner read the schema from a lone file itself, so it needs neither the check nor a scan thread.
+    if (paths.size() == 1) {
+        return CreateScanOperator(std::move(paths.front()), std::move(projection_indexes), std::move(filter), options);
+    }
+    return std::make_unique<TableScanOperator>(std::move(paths), std::move(schema), std::move(projection_indexes),
+                                               std::move(filter), options);
 }
@@ -6,6 +6,7 @@
 
 #include "common/ascii.h"
 #include "common/error.h"
+#include "executor/aggregate_function.h"
 #include "sql_parser/tokenizer.h"
 
 class TokenCursor {
@@ -72,10 +73,7 @@ class TokenCursor {
     size_t pos_ = 0;
 };
 
-static bool IsAggregateName(const std::string_view name) {
-    const std::string upper = ToUpperAscii(name);
-    return upper == "COUNT" || upper == "SUM" || upper == "AVG" || upper == "MIN" || upper == "MAX";
-}
+static bool IsAggregateName(const std::string_view name) { return AggRegistry::Instance().Find(name) != nullptr; }
 
 static ComparisonKind ComparisonKindFromToken(const Tokens type) {
     switch (type) {
@@ -9,7 +9,8 @@
 #include "executor/operators_internal.h"
 #include "executor/query_utils.h"
 #include "executor/typed_value_utils.h"
-#include "io/columnar_batch.h"
+#include "io/metadata_cache.h"
+#include "io/table_files.h"
 
 constexpr size_t SqlOrdinalBase = 1;
 
@@ -43,7 +44,7 @@ static ColumnType ColumnTypeOf(const Query& query, const Schema& schema, const E
             if (name == "REGEXP_REPLACE") {
                 return ColumnType::String;
             }
-            if (name == "COUNT") {
+            if (name == "COUNT" || name == "APPROX_COUNT_DISTINCT") {
                 return ColumnType::Int64;
             }
             if (name == "SUM" || name == "AVG") {
@@ -365,6 +366,8 @@ static void BindLiteralInSet(const Query& query_ast, const Schema& schema,
     predicate->literal_in_values = std::move(values);
 
     if (schema.columns[source_index].type == ColumnType::String) {
+        predicate->metadata_string_in_set_bound = true;
+        predicate->metadata_string_in_column_index = source_index;
         return;
     }
 
@@ -406,6 +409,7 @@ static void BindLiteralLikePattern(const Query& query_ast, const Schema& schema,
 
     predicate->literal_like_pattern_bound = true;
     predicate->like_column_index = *projected_index;
+    predicate->metadata_like_column_index = source_index;
     predicate->like_pattern = NormalizeLiteralForEval(predicate->right->literal);
     predicate->like_negated = predicate->kind == PredicateKind::NotLike;
 }
@@ -439,6 +443,16 @@ static void BindTypedLiteralComparison(const Query& query_ast, const Schema& sch
     }
 
     const ColumnType type = schema.columns[source_index].type;
+    if (type == ColumnType::String && (*literal_expr)->literal.kind == LiteralKind::String) {
+        std::string value = NormalizeLiteralForEval((*literal_expr)->literal);
+        if (!TryParseInt128(value) && !TryParseDate(value) && !TryParseTimestamp(value)) {
+            predicate->metadata_string_comparison_bound = true;
+            predicate->metadata_string_column_index = source_index;
+            predicate->metadata_string_value = std::move(value);
+            predicate->metadata_string_comparison = comparison;
+        }
+    }
+
     const std::optional<Int128> literal = TryParseLiteralValueAsInt128((*literal_expr)->literal, type);
     if (!literal.has_value()) {
         return;
@@ -449,6 +463,10 @@ static void BindTypedLiteralComparison(const Query& query_ast, const Schema& sch
     predicate->typed_literal_value = *literal;
     predicate->typed_comparison = comparison;
 
+    if (type == ColumnType::String) {
+        return;
+    }
+
     predicate->metadata_typed_literal_comparison_bound = true;
     predicate->metadata_typed_column_index = source_index;
     predicate->metadata_typed_literal_value = *literal;
@@ -486,7 +504,7 @@ static bool SupportsDirectTypedAggInput(const AggFuncDefinition& function, const
     return (name == "MIN" || name == "MAX") && (type == ColumnType::Date || type == ColumnType::Timestamp);
 }
 
-static bool IsSimpleMetadataExtrema(const Query& query, const PlannedQuery& planned, const ColumnarMetadata& metadata) {
+static bool IsSimpleMetadataExtrema(const Query& query, const PlannedQuery& planned, const MetadataView& metadata) {
     if (planned.plain_select || query.filter || query.having || !query.group_by.empty() || !query.order_by.empty() ||
         query.limit.has_value() || query.offset != 0 || planned.aggregates.empty()) {
         return false;
@@ -494,15 +512,29 @@ static bool IsSimpleMetadataExtrema(const Query& query, const PlannedQuery& plan
 
     for (const PlannedAgg& aggregate : planned.aggregates) {
         const std::string name = ToUpperAscii(aggregate.function->canonical_name);
+        if (name == "APPROX_COUNT_DISTINCT") {
+            if (!aggregate.argument || aggregate.argument->kind != ExprKind::Column) {
+                return false;
+            }
+
+            for (size_t row_group = 0; row_group < metadata.RowGroupCount(); ++row_group) {
+                if (aggregate.column_index >= metadata.GetSchema().columns.size() ||
+                    !metadata.HasDistinctSketch(row_group, aggregate.column_index)) {
+                    return false;
+                }
+            }
+            continue;
+        }
+
         if ((name != "MIN" && name != "MAX") || aggregate.distinct ||
             aggregate.argument_kind != AggArgumentKind::Column || !aggregate.direct_numeric_argument ||
             aggregate.direct_numeric_offset != 0) {
             return false;
         }
 
-        for (const auto& row_group : metadata.row_groups) {
-            if (aggregate.column_index >= row_group.columns.size() ||
-                !row_group.columns[aggregate.column_index].has_min_max) {
+        for (size_t row_group = 0; row_group < metadata.RowGroupCount(); ++row_group) {
+            if (aggregate.column_index >= metadata.GetSchema().columns.size() ||
+                !metadata.Chunk(row_group, aggregate.column_index).has_min_max) {
                 return false;
             }
         }
@@ -519,9 +551,8 @@ PlannedQuery PlanQuery(const Query& query, const std::unordered_map<std::string,
         throw Error::NotFound("executor", "unknown table", query.table_name);
     }
 
-    planned.table_path = table_it->second;
-    const ColumnarBatchReader reader(planned.table_path);
-    planned.table_schema = reader.GetSchema();
+    std::vector<TableFile> table_files = ListTableFiles(table_it->second);
+    planned.table_schema = MetadataCache::Instance().Get(table_files.front().path)->GetSchema();
     const Schema& schema = planned.table_schema;
 
     std::vector<size_t> projection_indexes;
@@ -727,7 +758,9 @@ PlannedQuery PlanQuery(const Query& query, const std::unordered_map<std::string,
     planned.offset = 0;
     planned.metadata_count_only = IsSimpleCountStar(query, planned);
     planned.metadata_extrema_only =
-        !planned.metadata_count_only && IsSimpleMetadataExtrema(query, planned, reader.GetMetadata());
+        !planned.metadata_count_only && std::ranges::all_of(table_files, [&](const TableFile& file) {
+            return IsSimpleMetadataExtrema(query, planned, *MetadataCache::Instance().Get(file.path));
+        });
 
     if (!planned.metadata_count_only && !planned.metadata_extrema_only) {
         if (projection_indexes.empty() && !schema.columns.empty()) {
@@ -761,6 +794,16 @@ PlannedQuery PlanQuery(const Query& query, const std::unordered_map<std::string,
         for (SelectItemSpec& item : planned.plain_select_items) {
             BindExprColumnIndexes(query, schema, planned.projection_indexes, item.expression);
         }
+
+        // Decided from the directory names alone; only the first file, read for the schema, is opened regardless.
+        std::erase_if(table_files, [&](const TableFile& file) {
+            return !MayMatchPartition(planned.filter, schema, file.partition_values);
+        });
+    }
+
+    planned.table_files.reserve(table_files.size());
+    for (TableFile& file : table_files) {
+        planned.table_files.push_back(std::move(file.path));
     }
 
     return planned;
@@ -0,0 +1,422 @@
+#include "io/chunk_encoding.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "common/bit_packing.h"
+#include "common/error.h"
+#include "model/column_dictionary_string.h"
+#include "model/column_traits.h"
+
+// Integer types narrow enough for the 64-bit frame of reference used by the lightweight encodings.
+template <class T>
+inline constexpr bool IsPackableInteger = std::is_integral_v<T> && sizeof(T) <= sizeof(int64_t);
+
+struct RunLengths {
+    std::vector<int64_t> values;
+    std::vector<uint32_t> lengths;
+};
+
+const char* ChunkEncodingName(const ChunkEncoding encoding) {
+    switch (encoding) {
+        case ChunkEncoding::Plain:
+            return "plain";
+        case ChunkEncoding::Dictionary:
+            return "dictionary";
+        case ChunkEncoding::BitPacked:
+            return "bitpacked";
+        case ChunkEncoding::RunLength:
+            return "rle";
+        case ChunkEncoding::Delta:
+            return "delta";
+        case ChunkEncoding::DeltaOfDelta:
+            return "delta-of-delta";
+    }
+
+    throw Error::InvalidArgument("encoding", "unknown chunk encoding");
+}
+
+std::vector<uint8_t> SerializeColumn(const Column& column) {
+    std::ostringstream buffer(std::ios::binary);
+    column.WriteTo(buffer);
+    const std::string bytes = std::move(buffer).str();
+    return std::vector<uint8_t>(bytes.begin(), bytes.end());
+}
+
+template <class T>
+static void AppendRaw(std::vector<uint8_t>& out, const T value) {
+    const size_t offset = out.size();
+    out.resize(offset + sizeof(value));
+    std::memcpy(out.data() + offset, &value, sizeof(value));
+}
+
+template <class T>
+static T ReadRaw(const std::span<const uint8_t> bytes, size_t& consumed) {
+    T value{};
+    if (bytes.size() - consumed < sizeof(value)) {
+        throw Error::MalformedData("encoding", "encoded chunk is truncated");
+    }
+    std::memcpy(&value, bytes.data() + consumed, sizeof(value));
+    consumed += sizeof(value);
+    return value;
+}
+
+static std::span<const uint8_t> ReadPacked(const std::span<const uint8_t> bytes, size_t& consumed, const size_t count,
+                                           const uint8_t width) {
+    const size_t size = PackedByteCount(count, width);
+    if (bytes.size() - consumed < size) {
+        throw Error::MalformedData("encoding", "encoded chunk is truncated");
+    }
+    const std::span<const uint8_t> packed = bytes.subspan(consumed, size);
+    consumed += size;
+    return packed;
+}
+
+static uint8_t FrameOfReferenceWidth(const std::span<const int64_t> values) {
+    if (values.empty()) {
+        return 0;
+    }
+    const auto [min, max] = std::ranges::minmax_element(values);
+    return BitWidthFor(static_cast<uint64_t>(*max) - static_cast<uint64_t>(*min));
+}
+
+static size_t FrameOfReferenceSize(const std::span<const int64_t> values) {
+    return sizeof(int64_t) + 1 + PackedByteCount(values.size(), FrameOfReferenceWidth(values));
+}
+
+static void AppendFrameOfReference(const std::span<const int64_t> values, std::vector<uint8_t>& out) {
+    const int64_t reference = values.empty() ? 0 : *std::ranges::min_element(values);
+    const uint8_t width = FrameOfReferenceWidth(values);
+
+    std::vector<uint64_t> offsets(values.size());
+    for (size_t i = 0; i < values.size(); ++i) {
+        offsets[i] = static_cast<uint64_t>(values[i]) - static_cast<uint64_t>(reference);
+    }
+
+    AppendRaw(out, reference);
+    out.push_back(width);
+    PackBits<uint64_t>(offsets, width, out);
+}
+
+// Calls store(index, value) in index order; values are returned modulo 2^64.
+template <class Store>
+static void ForEachFrameOfReference(const std::span<const uint8_t> bytes, size_t& consumed, const size_t count,
+                                    Store&& store) {
+    const auto reference = static_cast<uint64_t>(ReadRaw<int64_t>(bytes, consumed));
+    const uint8_t width = ReadRaw<uint8_t>(bytes, consumed);
+    if (width > 64) {
+        throw Error::MalformedData("encoding", "bit width out of range");
+    }
+
+    const std::span<const uint8_t> packed = ReadPacked(bytes, consumed, count, width);
+    ForEachUnpacked(packed, width, count,
+                    [&](const size_t i, const uint64_t offset) { store(i, reference + offset); });
+}
+
+template <class T>
+static void ReadFrameOfReference(const std::span<const uint8_t> bytes, size_t& consumed, const std::span<T> out) {
+    ForEachFrameOfReference(bytes, consumed, out.size(),
+                            [&](const size_t i, const uint64_t value) { out[i] = static_cast<T>(value); });
+}
+
+// Differences of order `order` (1 or 2), computed modulo 2^64 so any int64 sequence round-trips.
+static std::vector<int64_t> Differences(const std::span<const int64_t> values, const int order) {
+    std::vector<int64_t> differences(values.begin(), values.end());
+    for (int pass = 0; pass < order; ++pass) {
+        for (size_t i = differences.size(); i-- > static_cast<size_t>(pass) + 1;) {
+            differences[i] =
+                static_cast<int64_t>(static_cast<uint64_t>(differences[i]) - static_cast<uint64_t>(differences[i - 1]));
+        }
+    }
+    return differences;
+}
+
+static size_t DeltaSize(const std::span<const int64_t> differences, const int order) {
+    return static_cast<size_t>(order) * sizeof(int64_t) + FrameOfReferenceSize(differences.subspan(order));
+}
+
+static void AppendDelta(const std::span<const int64_t> differences, const int order, std::vector<uint8_t>& out) {
+    for (int i = 0; i < order; ++i) {
+        AppendRaw(out, differences[static_cast<size_t>(i)]);
+    }
+    AppendFrameOfReference(differences.subspan(order), out);
+}
+
+// Prefix sums the stored differences back into values, `order` times folded into a single pass.
+template <class T>
+static void ReadDelta(const std::span<const uint8_t> bytes, size_t& consumed, const int order, const std::span<T> out) {
+    if (out.size() < static_cast<size_t>(order)) {
+        throw Error::MalformedData("encoding", "delta chunk has too few rows");
+    }
+
+    auto value = static_cast<uint64_t>(ReadRaw<int64_t>(bytes, consumed));
+    uint64_t delta = order == 2 ? static_cast<uint64_t>(ReadRaw<int64_t>(bytes, consumed)) : 0;
+
+    out[0] = static_cast<T>(value);
+    if (order == 2) {
+        value += delta;
+        out[1] = static_cast<T>(value);
+    }
+
+    const std::span<T> rest = out.subspan(static_cast<size_t>(order));
+    if (order == 1) {
+        ForEachFrameOfReference(bytes, consumed, rest.size(), [&](const size_t i, const uint64_t difference) {
+            value += difference;
+            rest[i] = static_cast<T>(value);
+        });
+        return;
+    }
+
+    ForEachFrameOfReference(bytes, consumed, rest.size(), [&](const size_t i, const uint64_t difference) {
+        delta += difference;
+        value += delta;
+        rest[i] = static_cast<T>(value);
+    });
+}
+
+static RunLengths CollectRuns(const std::span<const int64_t> values) {
+    RunLengths runs;
+    for (size_t row = 0; row < values.size();) {
+        size_t end = row + 1;
+        while (end < values.size() && values[end] == values[row]) {
+            ++end;
+        }
+        runs.values.push_back(values[row]);
+        runs.lengths.push_back(static_cast<uint32_t>(end - row));
+        row = end;
+    }
+    return runs;
+}
+
+static uint8_t RunLengthWidth(const RunLengths& runs) {
+    return BitWidthFor(*std::ranges::max_element(runs.lengths) - 1);
+}
+
+static size_t RunLengthSize(const RunLengths& runs) {
+    return sizeof(uint32_t) + FrameOfReferenceSize(runs.values) + 1 +
+           PackedByteCount(runs.lengths.size(), RunLengthWidth(runs));
+}
+
+static void AppendRunLength(const RunLengths& runs, std::vector<uint8_t>& out) {
+    const uint8_t width = RunLengthWidth(runs);
+
+    std::vector<uint32_t> lengths(runs.lengths.size());
+    std::ranges::transform(runs.lengths, lengths.begin(), [](const uint32_t length) { return length - 1; });
+
+    AppendRaw(out, static_cast<uint32_t>(runs.values.size()));
+    AppendFrameOfReference(runs.values, out);
+    out.push_back(width);
+    PackBits<uint32_t>(lengths, width, out);
+}
+
+template <class T>
+static std::vector<uint32_t> ReadRunLength(const std::span<const uint8_t> bytes, size_t& consumed,
+                                           const std::span<T> out) {
+    const uint32_t run_count = ReadRaw<uint32_t>(bytes, consumed);
+    if (run_count > out.size() || (run_count == 0 && !out.empty())) {
+        throw Error::MalformedData("encoding", "run count out of range");
+    }
+
+    std::vector<T> values(run_count);
+    ReadFrameOfReference<T>(bytes, consumed, values);
+
+    const uint8_t width = ReadRaw<uint8_t>(bytes, consumed);
+    if (width > 32) {
+        throw Error::MalformedData("encoding", "bit width out of range");
+    }
+
+    std::vector<uint32_t> run_ends(run_count);
+    const std::span<const uint8_t> packed = ReadPacked(bytes, consumed, run_count, width);
+    uint64_t row = 0;
+
+    ForEachUnpacked(packed, width, run_count, [&](const size_t run, const uint64_t length) {
+        const uint64_t end = row + length + 1;
+        if (end > out.size()) {
+            throw Error::MalformedData("encoding", "runs exceed the chunk row count");
+        }
+        std::fill(out.begin() + static_cast<std::ptrdiff_t>(row), out.begin() + static_cast<std::ptrdiff_t>(end),
+                  values[run]);
+        run_ends[run] = static_cast<uint32_t>(end);
+        row = end;
+    });
+
+    if (row != out.size()) {
+        throw Error::MalformedData("encoding", "runs do not cover the chunk row count");
+    }
+
+    return run_ends;
+}
+
+static std::optional<std::vector<uint8_t>> EncodeStringDictionary(const Column& column, const size_t plain_size) {
+    DictionaryStringColumn dictionary;
+    dictionary.AppendRangeFromColumn(column, 0, column.Size());
+
+    std::vector<uint8_t> encoded;
+    dictionary.WriteDictionaryTo(encoded);
+    if (encoded.size() >= plain_size) {
+        return std::nullopt;
+    }
+
+    return encoded;
+}
+
+template <class T>
+static std::optional<EncodedChunk> EncodeIntegers(const std::span<const uint8_t> plain, const bool temporal) {
+    std::vector<int64_t> values(plain.size() / sizeof(T));
+    for (size_t i = 0; i < values.size(); ++i) {
+        T value{};
+        std::memcpy(&value, plain.data() + i * sizeof(T), sizeof(T));
+        values[i] = static_cast<int64_t>(value);
+    }
+
+    const size_t packed_size = FrameOfReferenceSize(values);
+    const RunLengths runs = CollectRuns(values);
+    const size_t run_length_size = RunLengthSize(runs);
+
+    ChunkEncoding best = ChunkEncoding::Plain;
+    size_t best_size = plain.size();
+    const auto consider = [&](const ChunkEncoding encoding, const size_t size) {
+        if (size < best_size) {
+            best = encoding;
+            best_size = size;
+        }
+    };
+
+    consider(ChunkEncoding::BitPacked, packed_size);
+    consider(ChunkEncoding::RunLength, run_length_size);
+
+    // Near-monotonic dates and timestamps have small neighbour differences even when their range is wide.
+    std::vector<int64_t> deltas;
+    std::vector<int64_t> deltas_of_deltas;
+    if (temporal) {
+        deltas = Differences(values, 1);
+        consider(ChunkEncoding::Delta, DeltaSize(deltas, 1));
+        if (values.size() >= 2) {
+            deltas_of_deltas = Differences(values, 2);
+            consider(ChunkEncoding::DeltaOfDelta, DeltaSize(deltas_of_deltas, 2));
+        }
+    }
+
+    EncodedChunk encoded{.encoding = best, .bytes = {}};
+    switch (best) {
+        case ChunkEncoding::Plain:
+        case ChunkEncoding::Dictionary:
+            return std::nullopt;
+        case ChunkEncoding::BitPacked:
+            AppendFrameOfReference(values, encoded.bytes);
+            break;
+        case ChunkEncoding::RunLength:
+            AppendRunLength(runs, encoded.bytes);
+            break;
+        case ChunkEncoding::Delta:
+            AppendDelta(deltas, 1, encoded.bytes);
+            break;
+        case ChunkEncoding::DeltaOfDelta:
+            AppendDelta(deltas_of_deltas, 2, encoded.bytes);
+            break;
+    }
+
+    return encoded;
+}
+
+EncodedChunk EncodeColumnChunk(const Column& column, const bool lightweight) {
+    EncodedChunk plain{.encoding = ChunkEncoding::Plain, .bytes = SerializeColumn(column)};
+    if (!lightweight || column.Size() == 0 || column.Size() > std::numeric_limits<uint32_t>::max()) {
+        return plain;
+    }
+
+    if (column.Type() == ColumnType::String) {
+        if (auto encoded = EncodeStringDictionary(column, plain.bytes.size())) {
+            return {.encoding = ChunkEncoding::Dictionary, .bytes = std::move(*encoded)};
+        }
+        return plain;
+    }
+
+    std::optional<EncodedChunk> encoded = VisitColumnType(column.Type(), [&]<ColumnType Type>() {
+        using T = typename ColumnValueTraits<Type>::Type;
+        if constexpr (IsPackableInteger<T>) {
+            return EncodeIntegers<T>(plain.bytes,
+                                     Type == ColumnType::Date || Type == ColumnType::Timestamp);
+        } else {
+            return std::optional<EncodedChunk>();
+        }
+    });
+
+    return encoded ? std::move(*encoded) : std::move(plain);
+}
+
+template <class T>
+static void DecodeIntegers(const std::span<const uint8_t> bytes, const ChunkEncoding encoding,
+                           const uint32_t row_count, MutableColumn& column) {
+    const auto target = column.PrepareRawRead(row_count, static_cast<uint64_t>(row_count) * sizeof(T));
+    if (!target) {
+        throw Error::InvalidState("encoding", "column does not expose raw storage");
+    }
+    const std::span<T> values(reinterpret_cast<T*>(target->data()), row_count);
+
+    size_t consumed = 0;
+    switch (encoding) {
+        case ChunkEncoding::BitPacked:
+            ReadFrameOfReference<T>(bytes, consumed, values);
+            break;
+        case ChunkEncoding::RunLength:
+            column.SetRunEnds(ReadRunLength<T>(bytes, consumed, values));
+            break;
+        case ChunkEncoding::Delta:
+            ReadDelta<T>(bytes, consumed, 1, values);
+            break;
+        case ChunkEncoding::DeltaOfDelta:
+            ReadDelta<T>(bytes, consumed, 2, values);
+            break;
+        case ChunkEncoding::Plain:
+        case ChunkEncoding::Dictionary:
+            throw Error::InvalidArgument("encoding", "not an integer chunk encoding");
+    }
+
+    if (consumed != bytes.size()) {
+        throw Error::MalformedData("encoding", "unexpected trailing bytes in encoded chunk");
+    }
+}
+
+std::unique_ptr<MutableColumn> DecodeColumnChunk(const std::span<const uint8_t> bytes, const ChunkEncoding encoding,
+                                                 const ColumnType type, const uint32_t row_count) {
+    switch (encoding) {
+        case ChunkEncoding::Plain: {
+            auto column = CreateColumn(type);
+            column->ReadFrom(bytes, row_count);
+            return column;
+        }
+        case ChunkEncoding::Dictionary: {
+            if (type != ColumnType::String) {
+                throw Error::MalformedData("encoding", "dictionary encoding on a non-string chunk");
+            }
+            auto column = std::make_unique<DictionaryStringColumn>();
+            column->ReadDictionaryFrom(bytes, row_count);
+            return column;
+        }
+        case ChunkEncoding::BitPacked:
+        case ChunkEncoding::RunLength:
+        case ChunkEncoding::Delta:
+        case ChunkEncoding::DeltaOfDelta: {
+            auto column = CreateColumn(type);
+            VisitColumnType(type, [&]<ColumnType Type>() {
+                using T = typename ColumnValueTraits<Type>::Type;
+                if constexpr (IsPackableInteger<T>) {
+                    DecodeIntegers<T>(bytes, encoding, row_count, *column);
+                } else {
+                    throw Error::MalformedData("encoding", "integer encoding on a non-integer chunk");
+                }
+            });
+            return column;
+        }
+    }
+
+    throw Error::MalformedData("encoding", "unknown chunk encoding");
+}
@@ -0,0 +1,127 @@
+#include "io/codec_selection.h"
+
+#include <array>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "common/error.h"
+
+struct CandidateCodec {
+    CodecChoice choice;
+    // Uncompressed bytes per second; only the relative order matters. Uncompressed chunks are read in place from the
+    // mapping, so None is the fastest.
+    double decode_speed = 0;
+};
+
+static constexpr double StorageReadSpeed = 1.0e9;
+static constexpr size_t SampleSlices = 4;
+
+static constexpr std::array<CandidateCodec, 5> Candidates = {{
+    {{Compression::None, DefaultCompressionLevel}, 10.0e9},
+    {{Compression::Lz4, DefaultCompressionLevel}, 4.0e9},
+    {{Compression::Lz4Hc, DefaultCompressionLevel}, 4.0e9},
+    {{Compression::Zstd, DefaultCompressionLevel}, 1.2e9},
+    {{Compression::Zstd, 9}, 1.2e9},
+}};
+
+const char* CodecObjectiveName(const CodecObjective objective) {
+    switch (objective) {
+        case CodecObjective::SmallestSize:
+            return "size";
+        case CodecObjective::FastestDecode:
+            return "decode";
+        case CodecObjective::Balanced:
+            return "balanced";
+    }
+
+    throw Error::InvalidArgument("compression", "unknown codec objective");
+}
+
+CodecObjective CodecObjectiveFromName(const std::string_view name) {
+    if (name == "size") {
+        return CodecObjective::SmallestSize;
+    }
+    if (name == "decode") {
+        return CodecObjective::FastestDecode;
+    }
+    if (name == "balanced") {
+        return CodecObjective::Balanced;
+    }
+
+    throw Error::InvalidArgument("compression", "unsupported codec objective: " + std::string(name));
+}
+
+CodecSelectionScope CodecSelectionScopeFromName(const std::string_view name) {
+    if (name == "row-group") {
+        return CodecSelectionScope::RowGroup;
+    }
+    if (name == "file") {
+        return CodecSelectionScope::File;
+    }
+
+    throw Error::InvalidArgument("compression", "unsupported codec selection scope: " + std::string(name));
+}
+
+static std::vector<uint8_t> SampleChunk(const std::span<const uint8_t> chunk, const size_t sample_bytes) {
+    if (chunk.size() <= sample_bytes) {
+        return std::vector<uint8_t>(chunk.begin(), chunk.end());
+    }
+
+    const size_t slice = sample_bytes / SampleSlices;
+    const size_t stride = chunk.size() / SampleSlices;
+
+    std::vector<uint8_t> sample;
+    sample.reserve(slice * SampleSlices);
+    for (size_t i = 0; i < SampleSlices; ++i) {
+        const auto begin = chunk.begin() + static_cast<std::ptrdiff_t>(i * stride);
+        sample.insert(sample.end(), begin, begin + static_cast<std::ptrdiff_t>(slice));
+    }
+
+    return sample;
+}
+
+// Lower is better; codecs that score the same are ranked by their output size.
+static double Score(const CodecObjective objective, const CandidateCodec& candidate, const double compressed_size,
+                    const double uncompressed_size) {
+    switch (objective) {
+        case CodecObjective::SmallestSize:
+            return compressed_size;
+        case CodecObjective::FastestDecode:
+            return uncompressed_size / candidate.decode_speed;
+        case CodecObjective::Balanced:
+            return compressed_size / StorageReadSpeed + uncompressed_size / candidate.decode_speed;
+    }
+
+    throw Error::InvalidArgument("compression", "unknown codec objective");
+}
+
+CodecChoice ChooseCodec(const std::span<const uint8_t> chunk, const CodecSelection& selection) {
+    const std::vector<uint8_t> sample = SampleChunk(chunk, selection.sample_bytes);
+    if (sample.empty()) {
+        return {};
+    }
+
+    const auto uncompressed_size = static_cast<double>(chunk.size());
+
+    CodecChoice best;
+    double best_score = std::numeric_limits<double>::infinity();
+    double best_size = std::numeric_limits<double>::infinity();
+
+    for (const auto& candidate : Candidates) {
+        const auto& [compression, level] = candidate.choice;
+        const size_t sample_compressed =
+            compression == Compression::None ? sample.size() : Compress(sample, compression, level).size();
+        const double ratio = static_cast<double>(sample_compressed) / static_cast<double>(sample.size());
+
+        const double compressed_size = ratio * uncompressed_size;
+        const double score = Score(selection.objective, candidate, compressed_size, uncompressed_size);
+        if (score < best_score || (score == best_score && compressed_size < best_size)) {
+            best = candidate.choice;
+            best_score = score;
+            best_size = compressed_size;
+        }
+    }
+
+    return best;
+}
@@ -1,20 +1,32 @@
 #include "io/columnar_batch.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
 #include <fstream>
+#include <future>
 #include <limits>
+#include <memory>
+#include <optional>
 #include <span>
 #include <sstream>
 #include <string>
 #include <string_view>
+#include <system_error>
 #include <utility>
 #include <vector>
 
 #include "common/error.h"
+#include "common/hyperloglog.h"
+#include "common/stable_hash.h"
+#include "io/chunk_encoding.h"
 #include "io/compression.h"
 #include "io/stream.h"
+#include "model/column_dictionary_string.h"
+#include "model/column_string.h"
 
 static constexpr std::string_view ColumnarMagic = "CLMN";
+static constexpr uint64_t FooterSize = sizeof(uint64_t) + ColumnarMagic.size();
 
 static uint64_t TellWrite(const std::filesystem::path& path, std::ofstream& out) {
     const auto pos = out.tellp();
@@ -33,21 +45,41 @@ static void FlushWrite(const std::filesystem::path& path, std::ofstream& out) {
 
 static bool SupportsChunkMinMax(const ColumnType type) { return type != ColumnType::String; }
 
-static void PopulateChunkMinMax(const Column& column, ColumnChunkMetadata& chunk) {
+static void PopulateChunkMinMax(const Column& column, const uint32_t page_rows, ColumnChunkMetadata& chunk) {
     if (!SupportsChunkMinMax(column.Type()) || column.Size() == 0) {
         return;
     }
 
+    const size_t row_count = column.Size();
+    const bool paged = page_rows > 0 && row_count > page_rows;
+    const size_t step = paged ? page_rows : row_count;
+
     Int128 min_value = column.ValueAsInt128(0);
     Int128 max_value = min_value;
 
-    for (size_t row = 1; row < column.Size(); ++row) {
-        const Int128 value = column.ValueAsInt128(row);
-        if (value < min_value) {
-            min_value = value;
+    if (paged) {
+        chunk.page_rows = page_rows;
+        chunk.pages.reserve((row_count + step - 1) / step);
+    }
+
+    for (size_t begin = 0; begin < row_count; begin += step) {
+        const size_t end = std::min(row_count, begin + step);
+        ZoneMap page{column.ValueAsInt128(begin), column.ValueAsInt128(begin)};
+
+        for (size_t row = begin + 1; row < end; ++row) {
+            const Int128 value = column.ValueAsInt128(row);
+            if (value < page.min_value) {
+                page.min_value = value;
+            }
+            if (value > page.max_value) {
+                page.max_value = value;
+            }
         }
-        if (value > max_value) {
-            max_value = value;
+
+        min_value = std::min(min_value, page.min_value);
+        max_value = std::max(max_value, page.max_value);
+        if (paged) {
+            chunk.pages.push_back(page);
         }
     }
 
@@ -56,76 +88,239 @@ static void PopulateChunkMinMax(const Column& column, ColumnChunkMetadata& chunk
     chunk.max_value = max_value;
 }
 
-static std::vector<uint8_t> SerializeColumn(const Column& column) {
-    std::ostringstream buffer(std::ios::binary);
-    column.WriteTo(buffer);
-    const std::string bytes = std::move(buffer).str();
-    return std::vector<uint8_t>(bytes.begin(), bytes.end());
-}
+static constexpr size_t StringStatsPrefixBytes = 64;
 
-static ColumnChunkMetadata WriteColumnChunk(const std::filesystem::path& path, std::ofstream& out, const Column& column,
-                                            const Compression compression) {
-    const std::vector<uint8_t> uncompressed = SerializeColumn(column);
-    const std::vector<uint8_t> compressed = Compress(uncompressed, compression);
+template <class Visit>
+static void ForEachStringValue(const Column& column, Visit&& visit) {
+    if (const auto* dictionary_column = dynamic_cast<const DictionaryStringColumn*>(&column)) {
+        for (size_t row = 0; row < dictionary_column->Size(); ++row) {
+            visit(dictionary_column->ValueAt(row));
+        }
+        return;
+    }
 
-    const std::span<const uint8_t> payload = compressed.size() < uncompressed.size()
-                                                 ? std::span<const uint8_t>(compressed)
-                                                 : std::span<const uint8_t>(uncompressed);
-    const Compression stored_compression = compressed.size() < uncompressed.size() ? compression : Compression::None;
-    const uint64_t offset = TellWrite(path, out);
+    const auto* string_column = dynamic_cast<const StringColumn*>(&column);
+    if (string_column == nullptr) {
+        throw Error::InvalidState("io", "unsupported string column representation");
+    }
+    for (size_t row = 0; row < string_column->Size(); ++row) {
+        visit(string_column->ValueAt(row));
+    }
+}
+
+// Returns a bound >= every string that shares value's first StringStatsPrefixBytes bytes.
+static std::string RoundUpStringBound(const std::string_view value) {
+    if (value.size() <= StringStatsPrefixBytes) {
+        return std::string(value);
+    }
 
-    if (!payload.empty()) {
-        out.write(reinterpret_cast<const char*>(payload.data()), static_cast<std::streamsize>(payload.size()));
-        if (!out) {
-            throw Error::PathIo("io", path, "write file");
+    std::string bound(value.substr(0, StringStatsPrefixBytes));
+    while (!bound.empty()) {
+        const auto last = static_cast<unsigned char>(bound.back());
+        if (last != 0xff) {
+            bound.back() = static_cast<char>(last + 1);
+            return bound;
         }
+        bound.pop_back();
     }
 
-    ColumnChunkMetadata chunk;
-    chunk.offset = offset;
-    chunk.compressed_size = payload.size();
-    chunk.uncompressed_size = uncompressed.size();
-    chunk.compression = stored_compression;
+    return std::string(value);
+}
 
-    PopulateChunkMinMax(column, chunk);
+static void PopulateStringStats(const Column& column, ColumnChunkMetadata& chunk) {
+    if (column.Type() != ColumnType::String || column.Size() == 0) {
+        return;
+    }
 
-    return chunk;
+    std::optional<std::string_view> min_value;
+    std::string_view max_value;
+    uint32_t empty_count = 0;
+    size_t max_length = 0;
+
+    ForEachStringValue(column, [&](const std::string_view value) {
+        if (!min_value) {
+            min_value = value;
+            max_value = value;
+        } else if (value < *min_value) {
+            min_value = value;
+        } else if (value > max_value) {
+            max_value = value;
+        }
+
+        empty_count += value.empty() ? 1 : 0;
+        max_length = std::max(max_length, value.size());
+    });
+
+    chunk.has_string_stats = true;
+    chunk.string_min = std::string(min_value->substr(0, StringStatsPrefixBytes));
+    chunk.string_max = RoundUpStringBound(max_value);
+    chunk.empty_count = empty_count;
+    chunk.max_length = static_cast<uint32_t>(std::min<size_t>(max_length, std::numeric_limits<uint32_t>::max()));
 }
 
-ColumnarMetadata ColumnarBatchReader::ReadFileMetadata(const std::filesystem::path& path) {
-    const auto file_metadata = GetFileMetadata(path);
+static std::vector<uint64_t> HashColumnValues(const Column& column) {
+    std::vector<uint64_t> hashes(column.Size());
 
-    if (!file_metadata || !file_metadata->is_regular) {
-        throw Error::NotFound("io", "columnar file not found", path.string());
+    if (const auto* dictionary_column = dynamic_cast<const DictionaryStringColumn*>(&column)) {
+        std::vector<uint64_t> entry_hashes;
+        entry_hashes.reserve(dictionary_column->GetDictionary()->size());
+        for (const auto& entry : *dictionary_column->GetDictionary()) {
+            entry_hashes.push_back(StableHash(std::string_view(entry)));
+        }
+
+        const auto codes = dictionary_column->Codes();
+        for (size_t row = 0; row < codes.size(); ++row) {
+            hashes[row] = entry_hashes[codes[row]];
+        }
+    } else if (column.Type() == ColumnType::String) {
+        size_t row = 0;
+        ForEachStringValue(column, [&](const std::string_view value) { hashes[row++] = StableHash(value); });
+    } else {
+        for (size_t row = 0; row < hashes.size(); ++row) {
+            hashes[row] = StableHash(column.ValueAsInt128(row));
+        }
+    }
+
+    return hashes;
+}
+
+static void PopulateDistinctSketch(const std::span<const uint64_t> hashes, ColumnChunkMetadata& chunk) {
+    HyperLogLog sketch;
+    for (const uint64_t hash : hashes) {
+        sketch.Insert(hash);
+    }
+    chunk.distinct_sketch = std::move(sketch);
+}
+
+static void PopulateBloomFilter(std::vector<uint64_t> hashes, ColumnChunkMetadata& chunk) {
+    std::ranges::sort(hashes);
+    hashes.erase(std::ranges::unique(hashes).begin(), hashes.end());
+
+    chunk.bloom_filter = BloomFilter::ForDistinctCount(hashes.size());
+    for (const uint64_t hash : hashes) {
+        chunk.bloom_filter.Insert(hash);
     }
+}
+
+static ColumnChunkMetadata CompressColumnChunk(const Column& column, EncodedChunk encoded, const CodecChoice codec,
+                                               const uint32_t page_rows, std::vector<uint8_t>& payload) {
+    std::vector<uint8_t> compressed = Compress(encoded.bytes, codec.compression, codec.level);
+    const bool shrunk = compressed.size() < encoded.bytes.size();
+
+    ColumnChunkMetadata chunk;
+    chunk.compressed_size = shrunk ? compressed.size() : encoded.bytes.size();
+    chunk.uncompressed_size = encoded.bytes.size();
+    chunk.compression = shrunk ? codec.compression : Compression::None;
+    chunk.encoding = encoded.encoding;
+    payload = shrunk ? std::move(compressed) : std::move(encoded.bytes);
 
-    const uint64_t file_size = file_metadata->size;
-    constexpr uint64_t FooterSize = sizeof(uint64_t) + ColumnarMagic.size();
+    PopulateChunkMinMax(column, page_rows, chunk);
+    PopulateStringStats(column, chunk);
+
+    return chunk;
+}
 
-    if (file_size < FooterSize) {
+// The metadata blob of bytes that end in a footer, whether a whole file or the footer kept in an append journal.
+static std::span<const uint8_t> FooterMetadataBlob(const std::span<const uint8_t> bytes,
+                                                   const std::filesystem::path& path) {
+    if (bytes.size() < FooterSize) {
         throw Error::MalformedData("io", "columnar file is too small", path.string());
     }
 
-    InputFile file(path);
-    const uint64_t metadata_size = file.ReadAt<uint64_t>(file_size - FooterSize);
-    const std::string magic_read = file.ReadStringAt(file_size - ColumnarMagic.size(), ColumnarMagic.size());
+    uint64_t metadata_size = 0;
+    std::memcpy(&metadata_size, bytes.data() + bytes.size() - FooterSize, sizeof(metadata_size));
+    const std::span<const uint8_t> magic_read = bytes.last(ColumnarMagic.size());
 
-    if (magic_read != ColumnarMagic) {
+    if (std::string_view(reinterpret_cast<const char*>(magic_read.data()), magic_read.size()) != ColumnarMagic) {
         throw Error::MalformedData("io", "invalid columnar magic", path.string());
     }
 
-    if (metadata_size > file_size - FooterSize) {
+    if (metadata_size > bytes.size() - FooterSize) {
         throw Error::MalformedData("io", "metadata size exceeds file size", path.string());
     }
 
-    const std::string metadata_blob = file.ReadStringAt(file_size - FooterSize - metadata_size, metadata_size);
-    std::istringstream metadata_stream(metadata_blob);
+    return bytes.subspan(bytes.size() - FooterSize - metadata_size, metadata_size);
+}
+
+std::span<const uint8_t> ColumnarBatchReader::MetadataBlob(const MappedFile& input) {
+    return FooterMetadataBlob(input.ReadAt(0, input.Size()), input.Path());
+}
+
+static ColumnarMetadata DecodeMetadataBlob(const std::span<const uint8_t> metadata_blob) {
+    if (MetadataView::IsFlat(metadata_blob)) {
+        return MetadataView(metadata_blob).Decode();
+    }
+
+    std::istringstream metadata_stream(
+        std::string(reinterpret_cast<const char*>(metadata_blob.data()), metadata_blob.size()), std::ios::binary);
 
     return ReadMetadata(metadata_stream);
 }
 
+static std::filesystem::path AppendJournalPath(const std::filesystem::path& path) {
+    std::filesystem::path journal = path;
+    journal += ".append";
+    return journal;
+}
+
+// The size of the file before the append that left `<path>.append` behind, or nothing without a journal.
+static std::optional<uint64_t> ReadAppendJournal(const std::filesystem::path& path) {
+    const std::filesystem::path journal_path = AppendJournalPath(path);
+    if (!FileExists(journal_path)) {
+        return std::nullopt;
+    }
+
+    std::vector<uint8_t> journal;
+    try {
+        journal = ReadFileBytes(journal_path);
+    } catch (const Error&) {
+        // Removed by an append finishing in the meantime.
+        if (!FileExists(journal_path)) {
+            return std::nullopt;
+        }
+        throw;
+    }
+
+    uint64_t committed_size = 0;
+    if (journal.size() != sizeof(committed_size)) {
+        throw Error::MalformedData("io", "append journal is malformed", journal_path.string());
+    }
+    std::memcpy(&committed_size, journal.data(), sizeof(committed_size));
+    return committed_size;
+}
+
+MappedFile ColumnarBatchReader::OpenFile(const std::filesystem::path& path) {
+    const auto file_metadata = GetFileMetadata(path);
+
+    if (!file_metadata || !file_metadata->is_regular) {
+        throw Error::NotFound("io", "columnar file not found", path.string());
+    }
+
+    while (true) {
+        if (const std::optional<uint64_t> committed_size = ReadAppendJournal(path)) {
+            return MappedFile(path, *committed_size);
+        }
+
+        MappedFile input(path);
+        try {
+            MetadataBlob(input);
+            return input;
+        } catch (const Error&) {
+            // Mapped while an append that started after the journal check was writing: look again.
+            const auto current = GetFileMetadata(path);
+            if (!FileExists(AppendJournalPath(path)) && (!current || current->size == input.Size())) {
+                throw;
+            }
+        }
+    }
+}
+
+ColumnarMetadata ColumnarBatchReader::ReadFileMetadata(const MappedFile& input) {
+    return DecodeMetadataBlob(MetadataBlob(input));
+}
+
 ColumnarBatchReader::ColumnarBatchReader(const std::filesystem::path& path)
-    : path_(path), input_(path), metadata_(ReadFileMetadata(path)) {
+    : path_(path), input_(OpenFile(path)), metadata_(ReadFileMetadata(input_)) {
     if (metadata_.schema.columns.empty()) {
         throw Error::MalformedData("io", "columnar schema is empty", path.string());
     }
@@ -145,22 +340,206 @@ std::optional<Batch> ColumnarBatchReader::ReadNext() {
 
     for (size_t col = 0; col < batch.ColumnsCount(); ++col) {
         const auto& chunk = row_group_columns[col];
-        ReadBatchColumnChunk(path_, input_, chunk, row_count, batch, col);
+        ReadBatchColumnChunk(input_, chunk, row_count, batch, col);
     }
 
     return batch;
 }
 
 ColumnarBatchWriter::ColumnarBatchWriter(const std::filesystem::path& path, Schema schema,
-                                         const Compression compression)
-    : path_(path), out_(OpenOutputFile(path)), compression_(compression) {
+                                         const Compression compression, const int compression_level)
+    : ColumnarBatchWriter(path, std::move(schema),
+                          ColumnarWriteOptions{.compression = compression, .compression_level = compression_level}) {}
+
+static std::vector<bool> SelectColumns(const std::filesystem::path& path, const Schema& schema,
+                                       const std::vector<std::string>& names, const std::string_view purpose) {
+    std::vector<bool> selected(schema.columns.size(), false);
+    for (const auto& name : names) {
+        const auto column = std::ranges::find(schema.columns, name, &ColumnSchema::name);
+        if (column == schema.columns.end()) {
+            throw Error::NotFound("io", std::string(purpose) + " column is not in the schema: " + name, path.string());
+        }
+        selected[column - schema.columns.begin()] = true;
+    }
+    return selected;
+}
+
+ColumnarBatchWriter::ColumnarBatchWriter(const std::filesystem::path& path, Schema schema,
+                                         ColumnarWriteOptions options)
+    : path_(path), options_(std::move(options)) {
     if (schema.columns.empty()) {
         throw Error::InvalidArgument("io", "schema has no columns", path.string());
     }
+    ValidateCompressionLevel(options_.compression, options_.compression_level);
+    file_codecs_.resize(schema.columns.size());
+
+    bloom_filter_columns_ = SelectColumns(path, schema, options_.bloom_filter_columns, "bloom filter");
+    distinct_sketch_columns_ = SelectColumns(path, schema, options_.distinct_sketch_columns, "distinct sketch");
+
     metadata_.schema = std::move(schema);
+
+    const size_t encode_threads =
+        options_.encode_threads == 0 ? ThreadPool::DefaultThreadCount() : options_.encode_threads;
+    if (encode_threads > 1 && metadata_.schema.columns.size() > 1) {
+        encode_pool_ = std::make_unique<ThreadPool>(std::min(encode_threads, metadata_.schema.columns.size()));
+    }
+
+    if (options_.open_mode == FileOpenMode::Append && FileExists(path)) {
+        OpenForAppend();
+    } else {
+        out_ = OpenOutputFile(path);
+    }
+}
+
+static void ResizeFile(const std::filesystem::path& path, const uint64_t size) {
+    std::error_code error;
+    std::filesystem::resize_file(path, size, error);
+    if (error) {
+        throw Error::PathIo("io", path, "resize file");
+    }
+}
+
+static void RemoveJournal(const std::filesystem::path& journal_path) {
+    std::error_code error;
+    std::filesystem::remove(journal_path, error);
+    if (error) {
+        throw Error::PathIo("io", journal_path, "remove append journal");
+    }
+    SyncParentDirectory(journal_path);
+}
+
+// True when the file ends in a footer that starts after the committed bytes and still lists their row groups in
+// place, with every chunk before the footer. Torn writes of an unsynced footer fail these checks.
+static bool HasCommittedAppend(const std::filesystem::path& path, const uint64_t committed_size) {
+    try {
+        const MappedFile input(path);
+        const std::span<const uint8_t> blob = ColumnarBatchReader::MetadataBlob(input);
+        const uint64_t metadata_start = input.Size() - FooterSize - blob.size();
+        if (input.Size() <= committed_size || metadata_start < committed_size) {
+            return false;
+        }
+
+        const ColumnarMetadata current = DecodeMetadataBlob(blob);
+        const ColumnarMetadata previous = DecodeMetadataBlob(FooterMetadataBlob(input.ReadAt(0, committed_size), path));
+        if (current.schema != previous.schema || current.row_groups.size() < previous.row_groups.size()) {
+            return false;
+        }
+
+        for (size_t group = 0; group < current.row_groups.size(); ++group) {
+            const auto& columns = current.row_groups[group].columns;
+            if (columns.size() != current.schema.columns.size()) {
+                return false;
+            }
+            for (size_t column = 0; column < columns.size(); ++column) {
+                const ColumnChunkMetadata& chunk = columns[column];
+                if (chunk.offset > metadata_start || chunk.compressed_size > metadata_start - chunk.offset) {
+                    return false;
+                }
+                if (group < previous.row_groups.size() &&
+                    chunk.offset != previous.row_groups[group].columns.at(column).offset) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    } catch (const Error&) {
+        return false;
+    }
+}
+
+bool RollBackInterruptedAppend(const std::filesystem::path& path) {
+    const std::filesystem::path journal_path = AppendJournalPath(path);
+    if (!FileExists(journal_path)) {
+        return true;
+    }
+
+    // Held by the append itself while it runs, and by a concurrent roll back.
+    const std::unique_ptr<FileLock> lock = FileLock::TryAcquire(journal_path);
+    if (!lock) {
+        return !FileExists(journal_path);
+    }
+
+    const std::optional<uint64_t> committed_size = ReadAppendJournal(path);
+    if (!committed_size) {
+        return true;
+    }
+
+    // The append got as far as syncing its footer and only the journal removal was lost. Otherwise cutting the file
+    // back is idempotent, so an interrupted roll back is simply repeated.
+    if (!HasCommittedAppend(path, *committed_size)) {
+        ResizeFile(path, *committed_size);
+    }
+    SyncFile(path);
+    RemoveJournal(journal_path);
+    return true;
 }
 
-void ColumnarBatchWriter::Write(const Batch& batch) {
+// New row groups follow the old footer, which stays in place until the append is done: readers keep seeing the file
+// as it was, through the size kept in the journal, and a crashed append is undone by cutting the file back to it.
+void ColumnarBatchWriter::OpenForAppend() {
+    if (!RollBackInterruptedAppend(path_)) {
+        throw Error::InvalidState("io", "another append is in progress", path_.string());
+    }
+
+    uint64_t committed_size = 0;
+    {
+        const MappedFile input(path_);
+        ColumnarMetadata existing = DecodeMetadataBlob(ColumnarBatchReader::MetadataBlob(input));
+        if (existing.schema != metadata_.schema) {
+            throw Error::InconsistentData("io", "appended schema differs from the file schema", path_.string());
+        }
+        metadata_.row_groups = std::move(existing.row_groups);
+        committed_size = input.Size();
+    }
+
+    // Published by rename, so a journal that exists is always complete, and locked before it is published, so a roll
+    // back never mistakes this append for an interrupted one.
+    const std::filesystem::path journal_path = AppendJournalPath(path_);
+    std::filesystem::path staged_journal = journal_path;
+    staged_journal += ".tmp";
+    std::vector<uint8_t> journal(sizeof(committed_size));
+    std::memcpy(journal.data(), &committed_size, sizeof(committed_size));
+    WriteFileBytes(staged_journal, journal);
+    journal_lock_ = FileLock::TryAcquire(staged_journal);
+    if (!journal_lock_) {
+        throw Error::InvalidState("io", "another append is in progress", path_.string());
+    }
+    SyncFile(staged_journal);
+    std::error_code error;
+    std::filesystem::rename(staged_journal, journal_path, error);
+    if (error) {
+        throw Error::PathIo("io", journal_path, "publish append journal");
+    }
+    SyncParentDirectory(journal_path);
+    journal_path_ = journal_path;
+
+    out_ = OpenOutputFile(path_, FileOpenMode::Append);
+    // Chunk offsets come from tellp, which only reports the end of the file after a seek in append mode.
+    out_.seekp(0, std::ios::end);
+}
+
+CodecChoice ColumnarBatchWriter::ChooseChunkCodec(const size_t column_index,
+                                                  const std::span<const uint8_t> serialized) {
+    if (!options_.adaptive_codec) {
+        return {options_.compression, options_.compression_level};
+    }
+
+    const CodecSelection& selection = *options_.adaptive_codec;
+    if (selection.scope == CodecSelectionScope::RowGroup) {
+        return ChooseCodec(serialized, selection);
+    }
+
+    const std::lock_guard lock(*file_codecs_mutex_);
+    auto& chosen = file_codecs_[column_index];
+    if (!chosen) {
+        chosen = ChooseCodec(serialized, selection);
+    }
+    return *chosen;
+}
+
+void ColumnarBatchWriter::Write(const Batch& batch) { WriteEncoded(Encode(batch)); }
+
+EncodedRowGroup ColumnarBatchWriter::Encode(const Batch& batch) {
     if (finalized_) {
         throw Error::InvalidState("io", "writer already finalized", path_.string());
     }
@@ -172,24 +551,92 @@ void ColumnarBatchWriter::Write(const Batch& batch) {
 
     const size_t row_count = batch.RowsCount();
 
-    if (row_count == 0) {
-        return;
-    }
-
     if (row_count > std::numeric_limits<uint32_t>::max()) {
         throw Error::Overflow("io", "row group exceeds supported size", path_.string());
     }
 
-    RowGroupMetadata group;
+    EncodedRowGroup encoded_group;
+    if (row_count == 0) {
+        return encoded_group;
+    }
+
+    RowGroupMetadata& group = encoded_group.metadata;
     group.row_count = row_count;
-    group.columns.reserve(batch.ColumnsCount());
+    group.columns.resize(batch.ColumnsCount());
+    encoded_group.payloads.resize(batch.ColumnsCount());
+
+    const auto encode_column = [&](const size_t column_index) {
+        group.columns[column_index] =
+            EncodeChunk(batch.ColumnAt(column_index), column_index, encoded_group.payloads[column_index]);
+    };
 
+    if (!encode_pool_ || batch.ColumnsCount() == 1) {
+        for (size_t column_index = 0; column_index < batch.ColumnsCount(); ++column_index) {
+            encode_column(column_index);
+        }
+        return encoded_group;
+    }
+
+    std::vector<std::future<void>> tasks;
+    tasks.reserve(batch.ColumnsCount());
     for (size_t column_index = 0; column_index < batch.ColumnsCount(); ++column_index) {
-        const Column& column = batch.ColumnAt(column_index);
-        group.columns.push_back(WriteColumnChunk(path_, out_, column, compression_));
+        tasks.push_back(encode_pool_->Submit([&encode_column, column_index] { encode_column(column_index); }));
+    }
+    // Every task refers to the batch, so all of them finish before the first failure is rethrown.
+    for (const auto& task : tasks) {
+        task.wait();
+    }
+    for (auto& task : tasks) {
+        task.get();
+    }
+
+    return encoded_group;
+}
+
+ColumnChunkMetadata ColumnarBatchWriter::EncodeChunk(const Column& column, const size_t column_index,
+                                                     std::vector<uint8_t>& payload) {
+    EncodedChunk encoded = EncodeColumnChunk(column, options_.lightweight_encoding);
+    const CodecChoice codec = ChooseChunkCodec(column_index, encoded.bytes);
+    ColumnChunkMetadata chunk = CompressColumnChunk(column, std::move(encoded), codec, options_.page_rows, payload);
+
+    if (bloom_filter_columns_[column_index] || distinct_sketch_columns_[column_index]) {
+        std::vector<uint64_t> hashes = HashColumnValues(column);
+        if (distinct_sketch_columns_[column_index]) {
+            PopulateDistinctSketch(hashes, chunk);
+        }
+        if (bloom_filter_columns_[column_index]) {
+            PopulateBloomFilter(std::move(hashes), chunk);
+        }
+    }
+
+    return chunk;
+}
+
+void ColumnarBatchWriter::WriteEncoded(EncodedRowGroup row_group) {
+    if (finalized_) {
+        throw Error::InvalidState("io", "writer already finalized", path_.string());
+    }
+    if (row_group.metadata.row_count == 0) {
+        return;
+    }
+    if (row_group.payloads.size() != row_group.metadata.columns.size() ||
+        row_group.metadata.columns.size() != metadata_.schema.columns.size()) {
+        throw Error::InconsistentData("io", "encoded row group column count mismatch", path_.string());
     }
 
-    metadata_.row_groups.push_back(std::move(group));
+    for (size_t column_index = 0; column_index < row_group.payloads.size(); ++column_index) {
+        const std::vector<uint8_t>& payload = row_group.payloads[column_index];
+        row_group.metadata.columns[column_index].offset = TellWrite(path_, out_);
+
+        if (!payload.empty()) {
+            out_.write(reinterpret_cast<const char*>(payload.data()), static_cast<std::streamsize>(payload.size()));
+            if (!out_) {
+                throw Error::PathIo("io", path_, "write file");
+            }
+        }
+    }
+
+    metadata_.row_groups.push_back(std::move(row_group.metadata));
 }
 
 void ColumnarBatchWriter::Flush() { FlushWrite(path_, out_); }
@@ -211,28 +658,175 @@ void ColumnarBatchWriter::Finalize() && {
 
     FlushWrite(path_, out_);
 
+    if (!journal_path_.empty()) {
+        SyncFile(path_);
+        RemoveJournal(journal_path_);
+        journal_lock_.reset();
+        journal_path_.clear();
+    }
+
     finalized_ = true;
 }
 
-std::vector<uint8_t> ReadColumnChunk(const std::filesystem::path& path, InputFile& input,
-                                     const ColumnChunkMetadata& chunk) {
-    const std::string raw = input.ReadStringAt(chunk.offset, chunk.compressed_size);
-    const std::span<const uint8_t> raw_bytes(reinterpret_cast<const uint8_t*>(raw.data()), raw.size());
+ColumnarBatchWriter::~ColumnarBatchWriter() {
+    // A moved-from writer holds no journal lock.
+    if (finalized_ || !journal_lock_) {
+        return;
+    }
+
+    try {
+        out_.close();
+        journal_lock_.reset();
+        RollBackInterruptedAppend(path_);
+    } catch (...) {
+        // The journal stays behind: readers keep to the committed bytes, and the next append rolls this one back.
+    }
+}
+
+std::vector<uint8_t> ReadColumnChunk(const MappedFile& input, const ColumnChunkMetadata& chunk) {
+    const std::span<const uint8_t> raw = input.ReadAt(chunk.offset, chunk.compressed_size);
 
     if (chunk.compression == Compression::None) {
         if (chunk.compressed_size != chunk.uncompressed_size) {
-            throw Error::MalformedData("io", "uncompressed chunk size mismatch", path.string());
+            throw Error::MalformedData("io", "uncompressed chunk size mismatch", input.Path().string());
+        }
+        return std::vector<uint8_t>(raw.begin(), raw.end());
+    }
+
+    return Decompress(raw, chunk.compression, chunk.uncompressed_size);
+}
+
+void DecodeBatchColumnChunk(const std::span<const uint8_t> raw, const ColumnChunkMetadata& chunk,
+                            const uint32_t row_count, Batch& batch, const size_t column_index) {
+    if (raw.size() != chunk.compressed_size) {
+        throw Error::MalformedData("io", "column chunk size mismatch");
+    }
+
+    if (chunk.compression == Compression::None && chunk.compressed_size != chunk.uncompressed_size) {
+        throw Error::MalformedData("io", "uncompressed chunk size mismatch");
+    }
+
+    if (chunk.encoding != ChunkEncoding::Plain) {
+        const ColumnType type = batch.GetSchema().columns.at(column_index).type;
+        if (chunk.compression == Compression::None) {
+            batch.SetColumn(column_index, DecodeColumnChunk(raw, chunk.encoding, type, row_count));
+            return;
+        }
+        const std::vector<uint8_t> payload = Decompress(raw, chunk.compression, chunk.uncompressed_size);
+        batch.SetColumn(column_index, DecodeColumnChunk(payload, chunk.encoding, type, row_count));
+        return;
+    }
+
+    if (chunk.compression == Compression::None) {
+        batch.ReadColumnFrom(column_index, raw, row_count);
+        return;
+    }
+
+    if (const auto target = batch.PrepareColumnRawRead(column_index, row_count, chunk.uncompressed_size)) {
+        DecompressInto(raw, chunk.compression, *target);
+        return;
+    }
+
+    const std::vector<uint8_t> payload = Decompress(raw, chunk.compression, chunk.uncompressed_size);
+    batch.ReadColumnFrom(column_index, payload, row_count);
+}
+
+bool MaterializeFromStatistics(const ColumnChunkMetadata& chunk, const uint32_t row_count, const size_t output_rows,
+                               Batch& batch, const size_t column_index) {
+    if (!chunk.has_string_stats || chunk.empty_count != row_count) {
+        return false;
+    }
+
+    auto column = std::make_unique<DictionaryStringColumn>();
+    column->AppendRepeated("", output_rows);
+    batch.SetColumn(column_index, std::move(column));
+    return true;
+}
+
+bool MaterializeFromStatistics(const ColumnChunkMetadata& chunk, const uint32_t row_count, Batch& batch,
+                               const size_t column_index) {
+    return MaterializeFromStatistics(chunk, row_count, row_count, batch, column_index);
+}
+
+void ReadBatchColumnChunk(const MappedFile& input, const ColumnChunkMetadata& chunk, const uint32_t row_count,
+                          Batch& batch, const size_t column_index) {
+    if (MaterializeFromStatistics(chunk, row_count, batch, column_index)) {
+        return;
+    }
+    DecodeBatchColumnChunk(input.ReadAt(chunk.offset, chunk.compressed_size), chunk, row_count, batch, column_index);
+}
+
+std::optional<uint64_t> PlainRowWidth(const ColumnChunkMetadata& chunk, const uint32_t row_count) {
+    if (chunk.encoding != ChunkEncoding::Plain || row_count == 0 || chunk.uncompressed_size % row_count != 0) {
+        return std::nullopt;
+    }
+    return chunk.uncompressed_size / row_count;
+}
+
+size_t RangeRows(const std::span<const RowRange> ranges) {
+    size_t rows = 0;
+    for (const auto& range : ranges) {
+        rows += range.count;
+    }
+    return rows;
+}
+
+void DecodeBatchColumnChunkRanges(const std::span<const uint8_t> raw, const ColumnChunkMetadata& chunk,
+                                  const uint32_t row_count, const std::span<const RowRange> ranges, Batch& batch,
+                                  const size_t column_index) {
+    const size_t selected_rows = RangeRows(ranges);
+    if (selected_rows == row_count) {
+        DecodeBatchColumnChunk(raw, chunk, row_count, batch, column_index);
+        return;
+    }
+
+    if (raw.size() != chunk.compressed_size) {
+        throw Error::MalformedData("io", "column chunk size mismatch");
+    }
+    if (!ranges.empty() && ranges.back().begin + ranges.back().count > row_count) {
+        throw Error::OutOfRange("io", "row range outside the column chunk");
+    }
+
+    // String columns have no raw layout and decline, whatever the chunk size.
+    const std::optional<uint64_t> width = PlainRowWidth(chunk, row_count);
+    const auto target = width ? batch.PrepareColumnRawRead(column_index, static_cast<uint32_t>(selected_rows),
+                                                           selected_rows * *width)
+                              : std::nullopt;
+    if (target) {
+        std::vector<uint8_t> payload;
+        std::span<const uint8_t> plain = raw;
+        if (chunk.compression != Compression::None) {
+            payload = Decompress(raw, chunk.compression, chunk.uncompressed_size);
+            plain = payload;
+        } else if (chunk.compressed_size != chunk.uncompressed_size) {
+            throw Error::MalformedData("io", "uncompressed chunk size mismatch");
+        }
+
+        uint8_t* out = target->data();
+        for (const auto& [begin, count] : ranges) {
+            const std::span<const uint8_t> rows = plain.subspan(begin * *width, count * *width);
+            if (!rows.empty()) {
+                std::memcpy(out, rows.data(), rows.size());
+                out += rows.size();
+            }
         }
-        return std::vector<uint8_t>(raw_bytes.begin(), raw_bytes.end());
+        return;
     }
 
-    return Decompress(raw_bytes, chunk.compression, chunk.uncompressed_size);
+    Schema chunk_schema;
+    chunk_schema.columns.push_back(batch.GetSchema().columns.at(column_index));
+    Batch whole(std::move(chunk_schema), row_count);
+    DecodeBatchColumnChunk(raw, chunk, row_count, whole, 0);
+    for (const auto& [begin, count] : ranges) {
+        batch.AppendColumnRange(column_index, whole.ColumnAt(0), begin, count);
+    }
 }
 
-void ReadBatchColumnChunk(const std::filesystem::path& path, InputFile& input, const ColumnChunkMetadata& chunk,
-                          const uint32_t row_count, const Batch& batch, const size_t column_index) {
-    const std::vector<uint8_t> payload = ReadColumnChunk(path, input, chunk);
-    const std::string bytes(payload.begin(), payload.end());
-    std::istringstream stream(bytes, std::ios::binary);
-    batch.ReadColumnFrom(column_index, stream, row_count, chunk.uncompressed_size);
+void ReadBatchColumnChunkRanges(const MappedFile& input, const ColumnChunkMetadata& chunk, const uint32_t row_count,
+                                const std::span<const RowRange> ranges, Batch& batch, const size_t column_index) {
+    if (MaterializeFromStatistics(chunk, row_count, RangeRows(ranges), batch, column_index)) {
+        return;
+    }
+    DecodeBatchColumnChunkRanges(input.ReadAt(chunk.offset, chunk.compressed_size), chunk, row_count, ranges, batch,
+                                 column_index);
 }
@@ -1,6 +1,8 @@
 #include "io/compression.h"
 
 #include <lz4.h>
+#include <lz4hc.h>
+#include <zstd.h>
 
 #include <algorithm>
 #include <limits>
@@ -14,6 +16,10 @@ const char* CompressionName(const Compression compression) {
             return "none";
         case Compression::Lz4:
             return "lz4";
+        case Compression::Zstd:
+            return "zstd";
+        case Compression::Lz4Hc:
+            return "lz4hc";
     }
 
     throw Error::InvalidArgument("compression", "unknown compression codec");
@@ -26,18 +32,42 @@ Compression CompressionFromName(const std::string_view name) {
     if (name == "lz4") {
         return Compression::Lz4;
     }
+    if (name == "zstd") {
+        return Compression::Zstd;
+    }
+    if (name == "lz4hc") {
+        return Compression::Lz4Hc;
+    }
 
     throw Error::InvalidArgument("compression", "unsupported compression codec: " + std::string(name));
 }
 
-std::vector<uint8_t> Compress(const std::span<const uint8_t> input, const Compression compression) {
+void ValidateCompressionLevel(const Compression compression, const int level) {
+    if (level == DefaultCompressionLevel) {
+        return;
+    }
+
     switch (compression) {
         case Compression::None:
-            return std::vector<uint8_t>(input.begin(), input.end());
         case Compression::Lz4:
-            break;
+            return;
+        case Compression::Zstd:
+            if (level < ZSTD_minCLevel() || level > ZSTD_maxCLevel()) {
+                throw Error::InvalidArgument("compression", "zstd level out of range: " + std::to_string(level));
+            }
+            return;
+        case Compression::Lz4Hc:
+            if (level < 1 || level > LZ4HC_CLEVEL_MAX) {
+                throw Error::InvalidArgument("compression", "lz4hc level out of range: " + std::to_string(level));
+            }
+            return;
     }
 
+    throw Error::InvalidArgument("compression", "unknown compression codec");
+}
+
+static std::vector<uint8_t> CompressLz4(const std::span<const uint8_t> input, const Compression compression,
+                                        const int level) {
     if (input.size() > static_cast<size_t>(std::numeric_limits<int>::max())) {
         throw Error::Overflow("compression", "input too large for lz4");
     }
@@ -48,9 +78,14 @@ std::vector<uint8_t> Compress(const std::span<const uint8_t> input, const Compre
     }
 
     std::vector<uint8_t> output(static_cast<size_t>(upper_bound));
+    const auto* src = reinterpret_cast<const char*>(input.data());
+    auto* dst = reinterpret_cast<char*>(output.data());
+
     const int compressed_size =
-        LZ4_compress_default(reinterpret_cast<const char*>(input.data()), reinterpret_cast<char*>(output.data()),
-                             static_cast<int>(input.size()), upper_bound);
+        compression == Compression::Lz4Hc
+            ? LZ4_compress_HC(src, dst, static_cast<int>(input.size()), upper_bound,
+                              level == DefaultCompressionLevel ? LZ4HC_CLEVEL_DEFAULT : level)
+            : LZ4_compress_default(src, dst, static_cast<int>(input.size()), upper_bound);
 
     if (compressed_size <= 0) {
         throw Error::Io("compression", "lz4 compression failed");
@@ -61,37 +96,91 @@ std::vector<uint8_t> Compress(const std::span<const uint8_t> input, const Compre
     return output;
 }
 
-std::vector<uint8_t> Decompress(const std::span<const uint8_t> input, const Compression compression,
-                                const uint64_t uncompressed_size) {
+static std::vector<uint8_t> CompressZstd(const std::span<const uint8_t> input, const int level) {
+    std::vector<uint8_t> output(ZSTD_compressBound(input.size()));
+    const size_t compressed_size = ZSTD_compress(output.data(), output.size(), input.data(), input.size(),
+                                                 level == DefaultCompressionLevel ? ZSTD_CLEVEL_DEFAULT : level);
+
+    if (ZSTD_isError(compressed_size)) {
+        throw Error::Io("compression", std::string("zstd compression failed: ") + ZSTD_getErrorName(compressed_size));
+    }
+
+    output.resize(compressed_size);
+
+    return output;
+}
+
+std::vector<uint8_t> Compress(const std::span<const uint8_t> input, const Compression compression, const int level) {
+    ValidateCompressionLevel(compression, level);
+
     switch (compression) {
         case Compression::None:
-            if (input.size() != uncompressed_size) {
+            return std::vector<uint8_t>(input.begin(), input.end());
+        case Compression::Lz4:
+        case Compression::Lz4Hc:
+            return CompressLz4(input, compression, level);
+        case Compression::Zstd:
+            return CompressZstd(input, level);
+    }
+
+    throw Error::InvalidArgument("compression", "unknown compression codec");
+}
+
+void DecompressInto(const std::span<const uint8_t> input, const Compression compression,
+                    const std::span<uint8_t> output) {
+    switch (compression) {
+        case Compression::None:
+            if (input.size() != output.size()) {
                 throw Error::MalformedData("compression", "uncompressed chunk size mismatch");
             }
-            return std::vector<uint8_t>(input.begin(), input.end());
+            std::ranges::copy(input, output.begin());
+            return;
+        case Compression::Zstd: {
+            const size_t decompressed_size = ZSTD_decompress(output.data(), output.size(), input.data(), input.size());
+            if (ZSTD_isError(decompressed_size)) {
+                throw Error::MalformedData("compression", "zstd decompression failed");
+            }
+            if (decompressed_size != output.size()) {
+                throw Error::MalformedData("compression", "zstd decompressed size mismatch");
+            }
+            return;
+        }
         case Compression::Lz4:
+        case Compression::Lz4Hc:
             break;
     }
 
     if (input.size() > static_cast<size_t>(std::numeric_limits<int>::max())) {
         throw Error::Overflow("compression", "compressed input too large for lz4");
     }
-    if (uncompressed_size > static_cast<uint64_t>(std::numeric_limits<int>::max())) {
+    if (output.size() > static_cast<size_t>(std::numeric_limits<int>::max())) {
         throw Error::Overflow("compression", "uncompressed output too large for lz4");
     }
 
-    std::vector<uint8_t> output(uncompressed_size);
     const int decompressed_size =
         LZ4_decompress_safe(reinterpret_cast<const char*>(input.data()), reinterpret_cast<char*>(output.data()),
-                            static_cast<int>(input.size()), static_cast<int>(uncompressed_size));
+                            static_cast<int>(input.size()), static_cast<int>(output.size()));
 
     if (decompressed_size < 0) {
         throw Error::MalformedData("compression", "lz4 decompression failed");
     }
 
-    if (static_cast<uint64_t>(decompressed_size) != uncompressed_size) {
+    if (static_cast<size_t>(decompressed_size) != output.size()) {
         throw Error::MalformedData("compression", "lz4 decompressed size mismatch");
     }
+}
+
+std::vector<uint8_t> Decompress(const std::span<const uint8_t> input, const Compression compression,
+                                const uint64_t uncompressed_size) {
+    if (compression == Compression::None && input.size() != uncompressed_size) {
+        throw Error::MalformedData("compression", "uncompressed chunk size mismatch");
+    }
+    if ((compression == Compression::Lz4 || compression == Compression::Lz4Hc) &&
+        uncompressed_size > static_cast<uint64_t>(std::numeric_limits<int>::max())) {
+        throw Error::Overflow("compression", "uncompressed output too large for lz4");
+    }
 
+    std::vector<uint8_t> output(uncompressed_size);
+    DecompressInto(input, compression, output);
     return output;
 }
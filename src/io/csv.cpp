@@ -1,50 +1,47 @@
 #include "io/csv.h"
 
+#include <algorithm>
+#include <cstddef>
 #include <utility>
 
 #include "common/error.h"
 #include "io/file.h"
 
-constexpr char CsvDelimiter = ',';
-constexpr char CsvQuote = '"';
-constexpr char CsvLf = '\n';
-constexpr char CsvCr = '\r';
-constexpr std::string_view CsvQuotedChars = ",\"\n\r";
+constexpr size_t CsvReadBufferBytes = 1 << 20;
 
-class CsvCharReader {
-   public:
-    explicit CsvCharReader(const std::istream& in) : buffer_(in.rdbuf()) {}
-
-   private:
-    using Traits = std::streambuf::traits_type;
-
-   public:
-    Traits::int_type Read() const { return buffer_->sbumpc(); }
-
-    Traits::int_type Peek() const { return buffer_->sgetc(); }
-
-    static bool IsEof(const Traits::int_type value) { return Traits::eq_int_type(value, Traits::eof()); }
-
-    static char ToChar(const Traits::int_type value) { return Traits::to_char_type(value); }
-
-    void Discard() const {
-        if (!IsEof(Peek())) {
-            buffer_->sbumpc();
-        }
+void AppendCsvField(std::string& out, const std::string_view value) {
+    if (!NeedsCsvQuotes(value)) {
+        out.append(value);
+        return;
     }
 
-    std::streambuf* buffer_;
-};
-
-static bool NeedsCsvQuotes(const std::string_view value) {
-    return value.find_first_of(CsvQuotedChars) != std::string_view::npos;
+    out.push_back(CsvQuote);
+    size_t begin = 0;
+    for (size_t quote = value.find(CsvQuote); quote != std::string_view::npos; quote = value.find(CsvQuote, begin)) {
+        out.append(value.substr(begin, quote + 1 - begin));
+        out.push_back(CsvQuote);
+        begin = quote + 1;
+    }
+    out.append(value.substr(begin));
+    out.push_back(CsvQuote);
 }
 
 CsvReader::CsvReader(std::istream& in) : in_(&in) {}
 
 CsvReader::CsvReader(const std::filesystem::path& path) : owned_in_(OpenInputFile(path)), in_(&owned_in_) {}
 
-CsvReader::CsvReader(CsvReader&& other) noexcept : owned_in_(std::move(other.owned_in_)) {
+CsvReader::CsvReader(const std::filesystem::path& path, const uint64_t begin, const uint64_t end)
+    : owned_in_(OpenInputFile(path)), in_(&owned_in_), remaining_(end - std::min(begin, end)) {
+    SeekInputFile(owned_in_, path, begin);
+}
+
+CsvReader::CsvReader(CsvReader&& other) noexcept
+    : owned_in_(std::move(other.owned_in_)),
+      buffer_(std::move(other.buffer_)),
+      begin_(std::exchange(other.begin_, 0)),
+      end_(std::exchange(other.end_, 0)),
+      remaining_(other.remaining_),
+      stray_quotes_(other.stray_quotes_) {
     RebindAfterMove(other.in_ == &other.owned_in_, other.in_);
     other.in_ = nullptr;
 }
@@ -52,6 +49,11 @@ CsvReader::CsvReader(CsvReader&& other) noexcept : owned_in_(std::move(other.own
 CsvReader& CsvReader::operator=(CsvReader&& other) noexcept {
     if (this != &other) {
         owned_in_ = std::move(other.owned_in_);
+        buffer_ = std::move(other.buffer_);
+        begin_ = std::exchange(other.begin_, 0);
+        end_ = std::exchange(other.end_, 0);
+        remaining_ = other.remaining_;
+        stray_quotes_ = other.stray_quotes_;
         RebindAfterMove(other.in_ == &other.owned_in_, other.in_);
         other.in_ = nullptr;
     }
@@ -66,74 +68,213 @@ void CsvReader::RebindAfterMove(const bool uses_owned_stream, std::istream* sour
     in_ = source_stream;
 }
 
-bool CsvReader::ReadRow(std::vector<std::string>& row) const {
+bool CsvReader::ReadRow(std::vector<std::string>& row) {
     row.clear();
-    row.emplace_back();
+    if (!ReadRow(views_)) {
+        return false;
+    }
 
-    const CsvCharReader input(*in_);
+    row.resize(views_.size());
+    for (size_t i = 0; i < views_.size(); ++i) {
+        row[i].assign(views_[i]);
+    }
+    return true;
+}
 
-    bool in_quotes = false;
-    bool saw_data = false;
+bool CsvReader::ReadRow(std::vector<std::string_view>& row) {
+    row.clear();
 
+    bool at_eof = false;
     while (true) {
-        const auto next = input.Read();
+        if (begin_ == end_ && at_eof) {
+            return false;
+        }
+        fields_.clear();
+        unescaped_.clear();
+        if (begin_ < end_ && ParseRow(at_eof)) {
+            break;
+        }
+        at_eof = !Refill();
+    }
+
+    AppendFieldViews(row);
+    return true;
+}
+
+size_t CsvReader::ReadRows(std::vector<std::string_view>& fields, const size_t columns, const size_t max_rows) {
+    fields.clear();
+    fields_.clear();
+    unescaped_.clear();
+
+    bool at_eof = false;
+    size_t rows = 0;
+    while (rows < max_rows) {
+        if (begin_ == end_ && at_eof) {
+            break;
+        }
+
+        const size_t row_fields = fields_.size();
+        if (begin_ < end_ && ParseRow(at_eof)) {
+            if (fields_.size() - row_fields != columns) {
+                throw Error::InconsistentData("io", "data csv column count mismatch");
+            }
+            ++rows;
+            continue;
+        }
+
+        fields_.resize(row_fields);
+        // Refilling moves the buffer under the rows parsed so far.
+        if (rows > 0) {
+            break;
+        }
+        at_eof = !Refill();
+    }
+
+    AppendFieldViews(fields);
+    return rows;
+}
+
+void CsvReader::AppendFieldViews(std::vector<std::string_view>& views) const {
+    views.reserve(views.size() + fields_.size());
+    for (const auto& field : fields_) {
+        const char* data = field.unescaped ? unescaped_.data() : buffer_.data();
+        views.emplace_back(data + field.offset, field.size);
+    }
+}
+
+// Keeps the unparsed tail and reads after it, growing the buffer when a single row fills all of it.
+bool CsvReader::Refill() {
+    if (begin_ > 0) {
+        std::copy(buffer_.begin() + static_cast<std::ptrdiff_t>(begin_),
+                  buffer_.begin() + static_cast<std::ptrdiff_t>(end_), buffer_.begin());
+        end_ -= begin_;
+        begin_ = 0;
+    }
+    if (end_ == buffer_.size()) {
+        buffer_.resize(std::max(buffer_.size() * 2, CsvReadBufferBytes));
+    }
+
+    const uint64_t wanted = std::min<uint64_t>(buffer_.size() - end_, remaining_);
+    if (wanted == 0) {
+        return false;
+    }
+    const std::streamsize read = in_->rdbuf()->sgetn(buffer_.data() + end_, static_cast<std::streamsize>(wanted));
+    if (read <= 0) {
+        return false;
+    }
+    end_ += static_cast<size_t>(read);
+    remaining_ -= static_cast<uint64_t>(read);
+    return true;
+}
 
-        if (input.IsEof(next)) {
-            if (!saw_data) {
+// Parses the row at begin_ and appends its fields to fields_. Returns false, with begin_ unchanged, when the row may
+// continue past the buffered input.
+bool CsvReader::ParseRow(const bool at_eof) {
+    CsvStructureScanner scanner(buffer_.data(), begin_, end_);
+    size_t pos = begin_;
+
+    while (true) {
+        const std::optional<size_t> separator = ParseField(scanner, pos, at_eof);
+        if (!separator) {
+            return false;
+        }
+        if (*separator == end_) {
+            begin_ = end_;
+            return true;
+        }
+
+        const char ch = buffer_[*separator];
+        if (ch == CsvDelimiter) {
+            pos = *separator + 1;
+            continue;
+        }
+
+        size_t row_end = *separator + 1;
+        if (ch == CsvCr) {
+            if (row_end == end_ && !at_eof) {
                 return false;
             }
-            if (in_quotes) {
-                throw Error::MalformedData("io", "unexpected EOF inside quoted field");
+            if (row_end < end_ && buffer_[row_end] == CsvLf) {
+                ++row_end;
             }
-            return true;
         }
+        begin_ = row_end;
+        return true;
+    }
+}
 
-        saw_data = true;
-        const char ch = input.ToChar(next);
+// Parses the field at `pos` and returns the position of the separator after it (end_ at the end of input), or nothing
+// when it may continue past the buffered input. A quote opens a quoted section only at the start of a value, and
+// anything after the closing quote is kept as is.
+std::optional<size_t> CsvReader::ParseField(CsvStructureScanner& scanner, size_t pos, const bool at_eof) {
+    const char* data = buffer_.data();
+
+    // A value is usually one span of the buffer; it is copied only when escaped quotes split it into several.
+    FieldSpan field;
+    size_t spans = 0;
+    const auto append = [&](const size_t begin, const size_t end) {
+        if (begin == end) {
+            return;
+        }
+        if (spans == 0) {
+            field = {.offset = begin, .size = end - begin, .unescaped = false};
+        } else {
+            if (!field.unescaped) {
+                const size_t offset = unescaped_.size();
+                unescaped_.append(data + field.offset, field.size);
+                field = {.offset = offset, .size = field.size, .unescaped = true};
+            }
+            unescaped_.append(data + begin, end - begin);
+            field.size += end - begin;
+        }
+        ++spans;
+    };
 
+    bool in_quotes = false;
+    while (true) {
         if (in_quotes) {
-            if (ch == CsvQuote) {
-                const auto peek = input.Peek();
-                if (!input.IsEof(peek) && input.ToChar(peek) == CsvQuote) {
-                    input.Discard();
-                    row.back().push_back(CsvQuote);
-                } else {
-                    in_quotes = false;
+            const size_t quote = scanner.Next(pos, true);
+            append(pos, quote);
+            if (quote == end_) {
+                if (!at_eof) {
+                    return std::nullopt;
                 }
-            } else {
-                row.back().push_back(ch);
+                throw Error::MalformedData("io", "unexpected EOF inside quoted field");
             }
-            continue;
-        }
-
-        if (ch == CsvQuote) {
-            if (row.back().empty()) {
-                in_quotes = true;
+            if (quote + 1 == end_ && !at_eof) {
+                return std::nullopt;
+            }
+            if (quote + 1 < end_ && data[quote + 1] == CsvQuote) {
+                append(quote, quote + 1);
+                pos = quote + 2;
             } else {
-                row.back().push_back(CsvQuote);
+                in_quotes = false;
+                pos = quote + 1;
             }
             continue;
         }
 
-        if (ch == CsvDelimiter) {
-            row.emplace_back();
-            continue;
+        const size_t next = scanner.Next(pos, false);
+        append(pos, next);
+        if (next == end_ && !at_eof) {
+            return std::nullopt;
         }
-
-        if (ch == CsvLf) {
-            return true;
+        if (next == end_ || data[next] != CsvQuote) {
+            pos = next;
+            break;
         }
 
-        if (ch == CsvCr) {
-            const auto peek = input.Peek();
-            if (!input.IsEof(peek) && input.ToChar(peek) == CsvLf) {
-                input.Discard();
-            }
-            return true;
+        if (spans == 0) {
+            in_quotes = true;
+        } else {
+            append(next, next + 1);
+            stray_quotes_ = true;
         }
-
-        row.back().push_back(ch);
+        pos = next + 1;
     }
+
+    fields_.push_back(field);
+    return pos;
 }
 
 CsvWriter::CsvWriter(std::ostream& out) : out_(&out) {}
@@ -163,31 +304,16 @@ void CsvWriter::RebindAfterMove(const bool uses_owned_stream, std::ostream* sour
 }
 
 void CsvWriter::WriteRow(const std::vector<std::string>& row) const {
+    std::string line;
     for (size_t i = 0; i < row.size(); ++i) {
         if (i > 0) {
-            *out_ << CsvDelimiter;
-        }
-
-        const std::string& value = row[i];
-        if (!NeedsCsvQuotes(value)) {
-            *out_ << value;
-            continue;
+            line.push_back(CsvDelimiter);
         }
-
-        *out_ << CsvQuote;
-        for (const char ch : value) {
-            if (ch == CsvQuote) {
-                *out_ << "\"\"";
-            } else {
-                *out_ << ch;
-            }
-        }
-
-        *out_ << CsvQuote;
+        AppendCsvField(line, row[i]);
     }
+    line.push_back(CsvLf);
 
-    *out_ << CsvLf;
-
+    out_->write(line.data(), static_cast<std::streamsize>(line.size()));
     if (!*out_) {
         throw Error::Io("io", "failed to write csv row");
     }
@@ -201,7 +327,7 @@ void CsvWriter::Flush() const {
 }
 
 std::vector<std::vector<std::string>> ReadRows(const std::filesystem::path& path) {
-    const CsvReader reader(path);
+    CsvReader reader(path);
 
     std::vector<std::vector<std::string>> rows;
     std::vector<std::string> row;
@@ -2,11 +2,31 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <iterator>
 #include <limits>
+#include <memory>
+#include <span>
+#include <string_view>
 #include <utility>
 
 #include "common/error.h"
 #include "common/int128.h"
+#include "model/column_boolean.h"
+#include "model/column_character.h"
+#include "model/column_date.h"
+#include "model/column_int128.h"
+#include "model/column_int16.h"
+#include "model/column_int32.h"
+#include "model/column_int64.h"
+#include "model/column_string.h"
+#include "model/column_timestamp.h"
+
+// Rows formatted a column at a time when writing, and the output gathered before each write to the file.
+constexpr size_t CsvFormatBlockRows = 4096;
+constexpr size_t CsvWriteBufferBytes = 1 << 20;
+
+// Rows decoded a column at a time, few enough for their fields to stay in cache from one column to the next.
+constexpr size_t CsvDecodeBlockRows = 1024;
 
 static uint64_t AddChecked(const uint64_t current, const uint64_t add) {
     if (add > std::numeric_limits<uint64_t>::max() - current) {
@@ -37,7 +57,7 @@ static uint64_t EstimateValueBytes(const ColumnType type, const std::string_view
     throw Error::Unsupported("io", "unsupported column type");
 }
 
-static uint64_t EstimateRowBytes(const Schema& schema, const std::vector<std::string>& row) {
+static uint64_t EstimateRowBytes(const Schema& schema, const std::vector<std::string_view>& row) {
     uint64_t bytes = 0;
     for (size_t i = 0; i < schema.columns.size(); ++i) {
         bytes = AddChecked(bytes, EstimateValueBytes(schema.columns[i].type, row[i]));
@@ -59,6 +79,21 @@ static void ValidateSizing(const BatchSizing& sizing) {
     }
 }
 
+// How many more rows a batch holding `rows` takes under the row and value limits; an empty batch takes at least one.
+static size_t RowsThatFit(const BatchSizing& sizing, const size_t rows, const size_t column_count) {
+    size_t limit = std::numeric_limits<size_t>::max();
+    if (sizing.max_rows) {
+        limit = *sizing.max_rows;
+    }
+    if (sizing.max_values && column_count > 0) {
+        limit = std::min<size_t>(limit, *sizing.max_values / column_count);
+    }
+    if (rows == 0) {
+        return std::max<size_t>(limit, 1);
+    }
+    return limit > rows ? limit - rows : 0;
+}
+
 static void ReserveForSizing(Batch& batch, const BatchSizing& sizing, const size_t column_count) {
     if (sizing.max_rows) {
         batch.Reserve(*sizing.max_rows);
@@ -70,8 +105,72 @@ static void ReserveForSizing(Batch& batch, const BatchSizing& sizing, const size
     }
 }
 
+template <class ColumnImpl>
+static void AppendFields(MutableColumn& column, const std::span<const std::string_view> values) {
+    static_cast<ColumnImpl&>(column).ColumnImpl::AppendFromStrings(values);
+}
+
+template <class ColumnImpl, class Decoder>
+static Decoder AttachTypedDecoder(Batch& batch, const size_t index) {
+    auto column = std::make_unique<ColumnImpl>();
+    const Decoder decoder{.column = column.get(), .append = &AppendFields<ColumnImpl>};
+    batch.SetColumn(index, std::move(column));
+    return decoder;
+}
+
+// Gives column `index` of `batch` a column of its concrete type and returns the decoder that appends to it.
+template <class Decoder>
+static Decoder AttachDecoder(Batch& batch, const size_t index) {
+    switch (batch.GetSchema().columns[index].type) {
+        case ColumnType::Boolean:
+            return AttachTypedDecoder<BooleanColumn, Decoder>(batch, index);
+        case ColumnType::Int16:
+            return AttachTypedDecoder<Int16Column, Decoder>(batch, index);
+        case ColumnType::Int32:
+            return AttachTypedDecoder<Int32Column, Decoder>(batch, index);
+        case ColumnType::Int64:
+            return AttachTypedDecoder<Int64Column, Decoder>(batch, index);
+        case ColumnType::Int128:
+            return AttachTypedDecoder<Int128Column, Decoder>(batch, index);
+        case ColumnType::String:
+            return AttachTypedDecoder<StringColumn, Decoder>(batch, index);
+        case ColumnType::Date:
+            return AttachTypedDecoder<DateColumn, Decoder>(batch, index);
+        case ColumnType::Timestamp:
+            return AttachTypedDecoder<TimestampColumn, Decoder>(batch, index);
+        case ColumnType::Character:
+            return AttachTypedDecoder<CharacterColumn, Decoder>(batch, index);
+    }
+    throw Error::Unsupported("io", "unsupported column type");
+}
+
+// Appends `rows` rows of fields, stored row after row, a column at a time.
+template <class Decoder>
+static void DecodeRows(const std::vector<Decoder>& decoders, const std::vector<std::string_view>& fields,
+                       const size_t rows, std::vector<std::string_view>& column_fields) {
+    const size_t column_count = decoders.size();
+    for (size_t col = 0; col < column_count; ++col) {
+        column_fields.clear();
+        for (size_t row = 0; row < rows; ++row) {
+            column_fields.push_back(fields[row * column_count + col]);
+        }
+        decoders[col].append(*decoders[col].column, column_fields);
+    }
+}
+
 CsvBatchReader::CsvBatchReader(const std::filesystem::path& path, Schema schema, BatchSizing sizing)
-    : csv_reader_(path), schema_(std::move(schema)), sizing_(std::move(sizing)) {
+    : owned_reader_(std::make_unique<CsvReader>(path)),
+      csv_reader_(owned_reader_.get()),
+      schema_(std::move(schema)),
+      sizing_(std::move(sizing)) {
+    if (schema_.columns.empty()) {
+        throw Error::InvalidArgument("io", "schema has no columns");
+    }
+    ValidateSizing(sizing_);
+}
+
+CsvBatchReader::CsvBatchReader(CsvReader& reader, Schema schema, BatchSizing sizing)
+    : csv_reader_(&reader), schema_(std::move(schema)), sizing_(std::move(sizing)) {
     if (schema_.columns.empty()) {
         throw Error::InvalidArgument("io", "schema has no columns");
     }
@@ -79,68 +178,202 @@ CsvBatchReader::CsvBatchReader(const std::filesystem::path& path, Schema schema,
 }
 
 std::optional<Batch> CsvBatchReader::ReadNext() {
-    if (reached_eof_ && !pending_row_) {
+    if (reached_eof_ && !next_batch_) {
         return std::nullopt;
     }
 
-    Batch batch(schema_);
+    Batch batch;
+    std::vector<FieldDecoder> decoders;
+    uint64_t bytes = 0;
+    if (next_batch_) {
+        batch = std::move(*next_batch_);
+        decoders = std::move(next_decoders_);
+        bytes = next_bytes_;
+        next_batch_.reset();
+    } else {
+        batch = StartBatch(decoders);
+    }
 
     const size_t column_count = schema_.columns.size();
-    ReserveForSizing(batch, sizing_, column_count);
-
-    std::vector<std::string> row;
-    row.reserve(column_count);
-
-    size_t rows = 0;
-    uint64_t bytes = 0;
+    size_t rows = batch.RowsCount();
 
     while (true) {
-        if (pending_row_) {
-            row = std::move(*pending_row_);
-            pending_row_.reset();
-        } else {
-            if (!csv_reader_.ReadRow(row)) {
-                reached_eof_ = true;
-                break;
-            }
+        // A byte limit needs each row measured before it is added, so rows are then read one at a time.
+        const size_t wanted =
+            sizing_.max_bytes ? 1 : std::min(CsvDecodeBlockRows, RowsThatFit(sizing_, rows, column_count));
+        if (wanted == 0) {
+            return batch;
+        }
+        const size_t read = csv_reader_->ReadRows(fields_, column_count, wanted);
+        if (read == 0) {
+            break;
         }
 
-        if (row.size() != column_count) {
-            throw Error::InconsistentData("io", "data csv column count mismatch");
+        if (sizing_.max_bytes) {
+            const uint64_t row_bytes = EstimateRowBytes(schema_, fields_);
+            const uint64_t next_bytes = AddChecked(bytes, row_bytes);
+            if (rows > 0 && sizing_.WouldExceed(rows + 1, column_count, next_bytes)) {
+                next_batch_ = StartBatch(next_decoders_);
+                DecodeRows(next_decoders_, fields_, 1, column_fields_);
+                next_bytes_ = row_bytes;
+                return batch;
+            }
+            bytes = next_bytes;
         }
 
-        const size_t next_rows = rows + 1;
-        uint64_t next_bytes = bytes;
+        DecodeRows(decoders, fields_, read, column_fields_);
+        rows += read;
+    }
 
-        if (sizing_.max_bytes) {
-            next_bytes = AddChecked(bytes, EstimateRowBytes(schema_, row));
+    reached_eof_ = true;
+    if (rows == 0) {
+        return std::nullopt;
+    }
+    return batch;
+}
+
+Batch CsvBatchReader::StartBatch(std::vector<FieldDecoder>& decoders) const {
+    Batch batch(schema_);
+    decoders.clear();
+    for (size_t col = 0; col < schema_.columns.size(); ++col) {
+        decoders.push_back(AttachDecoder<FieldDecoder>(batch, col));
+    }
+    ReserveForSizing(batch, sizing_, schema_.columns.size());
+    return batch;
+}
+
+ParallelCsvBatchReader::ParallelCsvBatchReader(const std::filesystem::path& path, Schema schema, BatchSizing sizing,
+                                               const CsvParallelOptions& options)
+    : schema_(std::move(schema)),
+      sizing_(std::move(sizing)),
+      chunks_(path, options, [this](CsvReader& reader) {
+          CsvBatchReader batch_reader(reader, schema_, sizing_);
+          std::vector<Batch> batches;
+          while (auto batch = batch_reader.ReadNext()) {
+              batches.push_back(std::move(*batch));
+          }
+          return batches;
+      }) {
+    if (schema_.columns.empty()) {
+        throw Error::InvalidArgument("io", "schema has no columns");
+    }
+    ValidateSizing(sizing_);
+}
+
+std::optional<Batch> ParallelCsvBatchReader::ReadNext() {
+    while (FillReady()) {
+        ParsedBatch& next = ready_.front();
+        if (!carry_) {
+            if (!next.ends_chunk) {
+                Batch batch = std::move(next.batch);
+                ready_.pop_front();
+                return batch;
+            }
+            carry_ = std::move(next.batch);
+            carry_bytes_ = RowsBytes(*carry_, 0, carry_->RowsCount());
+            ready_.pop_front();
+            continue;
         }
 
-        if (rows > 0 && sizing_.WouldExceed(next_rows, column_count, next_bytes)) {
-            pending_row_ = std::move(row);
-            break;
+        // Only the first batch of the next chunk tops the carried one up; the batches after it are passed on as they
+        // are, so rows are copied a second time at chunk boundaries only.
+        const size_t rows = next.batch.RowsCount();
+        const size_t taken = TopUpCarry(next.batch);
+        if (taken == rows) {
+            const bool ends_chunk = next.ends_chunk;
+            ready_.pop_front();
+            if (ends_chunk) {
+                continue;
+            }
+        } else if (taken > 0) {
+            Batch rest(schema_);
+            rest.AppendRowsRangeFromBatch(next.batch, taken, rows - taken);
+            next.batch = std::move(rest);
         }
+        return std::exchange(carry_, std::nullopt);
+    }
+    return std::exchange(carry_, std::nullopt);
+}
 
-        for (size_t col = 0; col < column_count; ++col) {
-            batch.AppendValueFromString(col, row[col]);
+bool ParallelCsvBatchReader::FillReady() {
+    while (ready_.empty()) {
+        if (remainder_batches_) {
+            std::optional<Batch> batch = remainder_batches_->ReadNext();
+            if (!batch) {
+                return false;
+            }
+            ready_.push_back({.batch = std::move(*batch)});
+            break;
         }
 
-        rows = next_rows;
-        bytes = next_bytes;
+        std::optional<std::vector<Batch>> batches = chunks_.Next();
+        if (!batches) {
+            remainder_ = chunks_.TakeRemainder();
+            if (!remainder_) {
+                return false;
+            }
+            remainder_batches_.emplace(*remainder_, schema_, sizing_);
+            continue;
+        }
+        for (size_t i = 0; i < batches->size(); ++i) {
+            ready_.push_back({.batch = std::move((*batches)[i]), .ends_chunk = i + 1 == batches->size()});
+        }
     }
+    return true;
+}
 
-    if (rows == 0 && reached_eof_ && !pending_row_) {
-        return std::nullopt;
+// Appends as many leading rows of `next` to the carried batch as CsvBatchReader would have put in it.
+size_t ParallelCsvBatchReader::TopUpCarry(const Batch& next) {
+    const size_t column_count = schema_.columns.size();
+    const size_t rows = carry_->RowsCount();
+    size_t taken = std::min(next.RowsCount(), RowsThatFit(sizing_, rows, column_count));
+    if (sizing_.max_bytes) {
+        const size_t limit = taken;
+        for (taken = 0; taken < limit; ++taken) {
+            const uint64_t next_bytes = AddChecked(carry_bytes_, RowsBytes(next, taken, taken + 1));
+            if (sizing_.WouldExceed(rows + taken + 1, column_count, next_bytes)) {
+                break;
+            }
+            carry_bytes_ = next_bytes;
+        }
     }
-
-    return batch;
+    carry_->AppendRowsRangeFromBatch(next, 0, taken);
+    return taken;
 }
 
+// The byte estimate CsvBatchReader made for rows [begin, end) when it parsed them; 0 without a byte limit.
+uint64_t ParallelCsvBatchReader::RowsBytes(const Batch& batch, const size_t begin, const size_t end) const {
+    uint64_t bytes = 0;
+    if (!sizing_.max_bytes) {
+        return bytes;
+    }
+    for (size_t col = 0; col < schema_.columns.size(); ++col) {
+        const ColumnType type = schema_.columns[col].type;
+        if (type != ColumnType::String) {
+            bytes = AddChecked(bytes, (end - begin) * EstimateValueBytes(type, {}));
+            continue;
+        }
+        const auto& column = static_cast<const StringColumn&>(batch.ColumnAt(col));
+        for (size_t row = begin; row < end; ++row) {
+            bytes = AddChecked(bytes, column.ValueAt(row).size());
+        }
+    }
+    return bytes;
+}
 CsvBatchWriter::CsvBatchWriter(const std::filesystem::path& path, Schema schema)
-    : csv_writer_(path), schema_(std::move(schema)) {
+    : out_(path), schema_(std::move(schema)) {
     if (schema_.columns.empty()) {
         throw Error::InvalidArgument("io", "schema has no columns");
     }
+    buffer_.reserve(CsvWriteBufferBytes);
+}
+
+// Buffered rows are still written when Finalize was skipped, but a failure can then only be reported by Finalize.
+CsvBatchWriter::~CsvBatchWriter() {
+    try {
+        Flush();
+    } catch (...) {
+    }
 }
 
 void CsvBatchWriter::Write(const Batch& batch) {
@@ -151,19 +384,40 @@ void CsvBatchWriter::Write(const Batch& batch) {
 
     const size_t column_count = schema_.columns.size();
     const size_t row_count = batch.RowsCount();
+    columns_.resize(column_count);
 
-    std::vector<std::string> row(column_count);
-
-    for (size_t row_index = 0; row_index < row_count; ++row_index) {
+    for (size_t begin = 0; begin < row_count; begin += CsvFormatBlockRows) {
+        const size_t count = std::min(CsvFormatBlockRows, row_count - begin);
         for (size_t col = 0; col < column_count; ++col) {
-            row[col] = batch.ColumnAt(col).ValueAsString(row_index);
+            FormatCsvColumn(batch.ColumnAt(col), begin, count, columns_[col]);
+        }
+
+        for (size_t row = 0; row < count; ++row) {
+            for (size_t col = 0; col < column_count; ++col) {
+                const CsvColumnText& column = columns_[col];
+                const size_t field_begin = row == 0 ? 0 : column.ends[row - 1];
+                buffer_.append(column.text, field_begin, column.ends[row] - field_begin);
+                buffer_.push_back(col + 1 == column_count ? CsvLf : CsvDelimiter);
+            }
+            if (buffer_.size() >= CsvWriteBufferBytes) {
+                out_.Write(buffer_);
+                buffer_.clear();
+            }
         }
+    }
+}
 
-        csv_writer_.WriteRow(row);
+void CsvBatchWriter::Flush() {
+    if (!buffer_.empty()) {
+        out_.Write(buffer_);
+        buffer_.clear();
     }
 }
 
-void CsvBatchWriter::Flush() { csv_writer_.Flush(); }
+void CsvBatchWriter::Finalize() {
+    Flush();
+    out_.Close();
+}
 
 void AppendBatchRows(const Batch& batch, std::vector<std::vector<std::string>>& rows) {
     const size_t row_count = batch.RowsCount();
@@ -185,5 +439,5 @@ void WriteBatchCsv(const std::filesystem::path& path, const Batch& batch) {
     CsvBatchWriter writer(path, batch.GetSchema());
 
     writer.Write(batch);
-    writer.Flush();
+    writer.Finalize();
 }
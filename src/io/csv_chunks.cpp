@@ -0,0 +1,93 @@
+#include "io/csv_chunks.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <span>
+
+#include "common/error.h"
+#include "io/csv_scan.h"
+#include "io/file.h"
+
+struct ChunkScan {
+    uint64_t quotes = 0;
+    // The first row start after the range begins, for a range starting outside ([0]) or inside ([1]) a quoted value.
+    // Every quote flips between the two readings, so one pass finds both.
+    std::array<std::optional<uint64_t>, 2> row_start;
+};
+
+static ChunkScan ScanChunk(const MappedFile& file, const uint64_t begin, const uint64_t end, const uint64_t file_size) {
+    // One byte past the range tells a CR that ends a row from the CR of a CR LF.
+    const std::span<const uint8_t> bytes = file.ReadAt(begin, std::min(end + 1, file_size) - begin);
+    const char* data = reinterpret_cast<const char*>(bytes.data());
+    const size_t size = end - begin;
+
+    ChunkScan scan;
+    bool quoted = false;
+    for (size_t block = 0; block < size; block += CsvBlockBytes) {
+        const CsvBlockMasks masks = ScanCsvBlock(data + block, size - block);
+        scan.quotes += static_cast<uint64_t>(std::popcount(masks.quotes));
+        if (scan.row_start[0] && scan.row_start[1]) {
+            continue;
+        }
+
+        for (uint64_t bits = masks.quotes | masks.separators; bits != 0; bits &= bits - 1) {
+            const size_t pos = block + static_cast<size_t>(std::countr_zero(bits));
+            const char ch = data[pos];
+            if (ch == CsvQuote) {
+                quoted = !quoted;
+                continue;
+            }
+            if (ch == CsvDelimiter || (ch == CsvCr && pos + 1 < bytes.size() && data[pos + 1] == CsvLf)) {
+                continue;
+            }
+
+            auto& row_start = scan.row_start[quoted ? 1 : 0];
+            if (!row_start) {
+                row_start = begin + pos + 1;
+            }
+        }
+    }
+
+    return scan;
+}
+
+std::vector<CsvChunk> SplitCsvFile(const std::filesystem::path& path, const uint64_t chunk_bytes, ThreadPool& pool) {
+    if (chunk_bytes == 0) {
+        throw Error::InvalidArgument("io", "csv chunk size must be > 0");
+    }
+
+    const auto metadata = GetFileMetadata(path);
+    if (!metadata || !metadata->is_regular) {
+        throw Error::PathIo("io", path, "open csv file");
+    }
+    const uint64_t size = metadata->size;
+    if (size <= chunk_bytes) {
+        return {CsvChunk{.begin = 0, .end = size}};
+    }
+
+    const MappedFile file(path);
+    std::vector<std::future<ChunkScan>> scans;
+    for (uint64_t begin = 0; begin < size; begin += chunk_bytes) {
+        const uint64_t end = std::min(begin + chunk_bytes, size);
+        scans.push_back(pool.Submit([&file, begin, end, size] { return ScanChunk(file, begin, end, size); }));
+    }
+
+    for (const auto& scan : scans) {
+        scan.wait();
+    }
+
+    std::vector<CsvChunk> chunks{CsvChunk{.begin = 0, .end = size}};
+    uint64_t quotes = 0;
+    for (size_t i = 0; i < scans.size(); ++i) {
+        const ChunkScan scan = scans[i].get();
+        const std::optional<uint64_t> row_start = scan.row_start[quotes % 2];
+        if (i > 0 && row_start && *row_start < size) {
+            chunks.back().end = *row_start;
+            chunks.push_back(CsvChunk{.begin = *row_start, .end = size});
+        }
+        quotes += scan.quotes;
+    }
+
+    return chunks;
+}
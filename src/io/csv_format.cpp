@@ -0,0 +1,133 @@
+#include "io/csv_format.h"
+
+#include <array>
+#include <charconv>
+#include <string_view>
+
+#include "common/error.h"
+#include "common/parsing.h"
+#include "io/csv.h"
+#include "model/column_boolean.h"
+#include "model/column_character.h"
+#include "model/column_date.h"
+#include "model/column_dictionary_string.h"
+#include "model/column_int128.h"
+#include "model/column_int16.h"
+#include "model/column_int32.h"
+#include "model/column_int64.h"
+#include "model/column_string.h"
+#include "model/column_timestamp.h"
+
+constexpr size_t MaxInt128Digits = 40;
+
+static void AppendInt128(std::string& out, const Int128 value) {
+    std::array<char, MaxInt128Digits> digits{};
+    size_t begin = digits.size();
+
+    UInt128 magnitude = value < 0 ? UInt128{0} - static_cast<UInt128>(value) : static_cast<UInt128>(value);
+    do {
+        digits[--begin] = static_cast<char>('0' + static_cast<unsigned>(magnitude % 10));
+        magnitude /= 10;
+    } while (magnitude != 0);
+    if (value < 0) {
+        digits[--begin] = '-';
+    }
+    out.append(digits.data() + begin, digits.size() - begin);
+}
+
+// Local to this file: io/columnar_batch.h has a RowRange of its own.
+namespace {
+
+struct RowRange {
+    size_t begin = 0;
+    size_t count = 0;
+};
+
+}  // namespace
+
+template <class ColumnImpl, class Append>
+static bool FormatFixedColumn(const Column& column, const RowRange rows, CsvColumnText& out, Append&& append) {
+    const auto* typed = dynamic_cast<const ColumnImpl*>(&column);
+    if (typed == nullptr) {
+        return false;
+    }
+    for (const auto value : typed->Values().subspan(rows.begin, rows.count)) {
+        append(value);
+        out.ends.push_back(out.text.size());
+    }
+    return true;
+}
+
+template <class ColumnImpl>
+static bool FormatIntegerColumn(const Column& column, const RowRange rows, CsvColumnText& out) {
+    return FormatFixedColumn<ColumnImpl>(column, rows, out, [&](const auto value) {
+        std::array<char, 24> digits{};
+        const auto result = std::to_chars(digits.data(), digits.data() + digits.size(), value);
+        out.text.append(digits.data(), result.ptr);
+    });
+}
+
+static bool FormatStringColumn(const Column& column, const RowRange rows, CsvColumnText& out) {
+    const auto* strings = dynamic_cast<const StringColumn*>(&column);
+    const auto* dictionary_strings = dynamic_cast<const DictionaryStringColumn*>(&column);
+    if (strings == nullptr && dictionary_strings == nullptr) {
+        return false;
+    }
+    for (size_t row = rows.begin; row < rows.begin + rows.count; ++row) {
+        AppendCsvField(out.text, strings != nullptr ? strings->ValueAt(row) : dictionary_strings->ValueAt(row));
+        out.ends.push_back(out.text.size());
+    }
+    return true;
+}
+
+static bool FormatTypedColumn(const Column& column, const RowRange rows, CsvColumnText& out) {
+    switch (column.Type()) {
+        case ColumnType::Boolean:
+            return FormatFixedColumn<BooleanColumn>(column, rows, out, [&](const uint8_t value) {
+                out.text.append(BooleanToString(value != 0));
+            });
+        case ColumnType::Int16:
+            return FormatIntegerColumn<Int16Column>(column, rows, out);
+        case ColumnType::Int32:
+            return FormatIntegerColumn<Int32Column>(column, rows, out);
+        case ColumnType::Int64:
+            return FormatIntegerColumn<Int64Column>(column, rows, out);
+        case ColumnType::Int128:
+            return FormatFixedColumn<Int128Column>(column, rows, out, [&](const Int128 value) {
+                AppendInt128(out.text, value);
+            });
+        case ColumnType::Date:
+            return FormatFixedColumn<DateColumn>(column, rows, out, [&](const int32_t value) {
+                AppendDate(out.text, value);
+            });
+        case ColumnType::Timestamp:
+            return FormatFixedColumn<TimestampColumn>(column, rows, out, [&](const int64_t value) {
+                AppendTimestamp(out.text, value);
+            });
+        case ColumnType::Character:
+            return FormatFixedColumn<CharacterColumn>(column, rows, out, [&](const char value) {
+                AppendCsvField(out.text, std::string_view(&value, 1));
+            });
+        case ColumnType::String:
+            return FormatStringColumn(column, rows, out);
+    }
+    return false;
+}
+
+void FormatCsvColumn(const Column& column, const size_t begin, const size_t count, CsvColumnText& out) {
+    if (begin > column.Size() || count > column.Size() - begin) {
+        throw Error::OutOfRange("io", "row range out of range");
+    }
+
+    out.text.clear();
+    out.ends.clear();
+    out.ends.reserve(count);
+    if (FormatTypedColumn(column, RowRange{.begin = begin, .count = count}, out)) {
+        return;
+    }
+
+    for (size_t row = begin; row < begin + count; ++row) {
+        AppendCsvField(out.text, column.ValueAsString(row));
+        out.ends.push_back(out.text.size());
+    }
+}
@@ -0,0 +1,102 @@
+#include "io/csv_scan.h"
+
+#include <algorithm>
+#include <bit>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define COLUMNAR_CSV_SCAN_X86 1
+#endif
+
+static CsvBlockMasks ScanScalar(const char* data, const size_t size) {
+    CsvBlockMasks masks;
+    for (size_t i = 0; i < size; ++i) {
+        const char ch = data[i];
+        if (ch == CsvQuote) {
+            masks.quotes |= uint64_t{1} << i;
+        } else if (ch == CsvDelimiter || ch == CsvLf || ch == CsvCr) {
+            masks.separators |= uint64_t{1} << i;
+        }
+    }
+    return masks;
+}
+
+#ifdef COLUMNAR_CSV_SCAN_X86
+static uint64_t MoveMask(const __m128i bytes) { return static_cast<uint16_t>(_mm_movemask_epi8(bytes)); }
+
+static CsvBlockMasks ScanSse2(const char* data) {
+    const __m128i quote = _mm_set1_epi8(CsvQuote);
+    const __m128i delimiter = _mm_set1_epi8(CsvDelimiter);
+    const __m128i lf = _mm_set1_epi8(CsvLf);
+    const __m128i cr = _mm_set1_epi8(CsvCr);
+
+    CsvBlockMasks masks;
+    for (size_t i = 0; i < CsvBlockBytes; i += 16) {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        const __m128i line_ends = _mm_or_si128(_mm_cmpeq_epi8(bytes, lf), _mm_cmpeq_epi8(bytes, cr));
+        const __m128i separators = _mm_or_si128(_mm_cmpeq_epi8(bytes, delimiter), line_ends);
+        masks.quotes |= MoveMask(_mm_cmpeq_epi8(bytes, quote)) << i;
+        masks.separators |= MoveMask(separators) << i;
+    }
+    return masks;
+}
+
+__attribute__((target("avx2"))) static CsvBlockMasks ScanAvx2(const char* data) {
+    const __m256i quote = _mm256_set1_epi8(CsvQuote);
+    const __m256i delimiter = _mm256_set1_epi8(CsvDelimiter);
+    const __m256i lf = _mm256_set1_epi8(CsvLf);
+    const __m256i cr = _mm256_set1_epi8(CsvCr);
+
+    CsvBlockMasks masks;
+    for (size_t i = 0; i < CsvBlockBytes; i += 32) {
+        const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        const __m256i line_ends = _mm256_or_si256(_mm256_cmpeq_epi8(bytes, lf), _mm256_cmpeq_epi8(bytes, cr));
+        const __m256i separators = _mm256_or_si256(_mm256_cmpeq_epi8(bytes, delimiter), line_ends);
+        masks.quotes |= uint64_t{static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, quote)))} << i;
+        masks.separators |= uint64_t{static_cast<uint32_t>(_mm256_movemask_epi8(separators))} << i;
+    }
+    return masks;
+}
+
+static bool HasAvx2() {
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+}
+#endif
+
+CsvBlockMasks ScanCsvBlock(const char* data, const size_t size) {
+#ifdef COLUMNAR_CSV_SCAN_X86
+    if (size >= CsvBlockBytes) {
+        return HasAvx2() ? ScanAvx2(data) : ScanSse2(data);
+    }
+#endif
+    return ScanScalar(data, std::min(size, CsvBlockBytes));
+}
+
+bool NeedsCsvQuotes(const std::string_view value) {
+    for (size_t pos = 0; pos < value.size(); pos += CsvBlockBytes) {
+        const CsvBlockMasks masks = ScanCsvBlock(value.data() + pos, value.size() - pos);
+        if ((masks.quotes | masks.separators) != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t CsvStructureScanner::Next(size_t pos, const bool quotes_only) {
+    while (pos < end_) {
+        const size_t block = pos - (pos - begin_) % CsvBlockBytes;
+        if (block != block_) {
+            masks_ = ScanCsvBlock(data_ + block, end_ - block);
+            block_ = block;
+        }
+
+        uint64_t bits = quotes_only ? masks_.quotes : masks_.quotes | masks_.separators;
+        bits &= ~uint64_t{0} << (pos - block);
+        if (bits != 0) {
+            return block + static_cast<size_t>(std::countr_zero(bits));
+        }
+        pos = block + CsvBlockBytes;
+    }
+    return end_;
+}
@@ -1,5 +1,12 @@
 #include "io/file.h"
 
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
 #include <iterator>
 #include <utility>
 
@@ -98,6 +105,78 @@ std::istream& InputFile::StreamAt(const uint64_t offset) {
     return in_;
 }
 
+MappedFile::MappedFile(std::filesystem::path path) : MappedFile(std::move(path), std::nullopt) {}
+
+MappedFile::MappedFile(std::filesystem::path path, const uint64_t length)
+    : MappedFile(std::move(path), std::optional(length)) {}
+
+MappedFile::MappedFile(std::filesystem::path path, const std::optional<uint64_t> length) : path_(std::move(path)) {
+    const int fd = ::open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw Error::PathIo("io", path_, "open for read");
+    }
+
+    struct stat st{};
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw Error::PathIo("io", path_, "read file size");
+    }
+
+    size_ = static_cast<uint64_t>(st.st_size);
+    if (length) {
+        if (*length > size_) {
+            ::close(fd);
+            throw Error::MalformedData("io", "file is shorter than expected", path_.string());
+        }
+        size_ = *length;
+    }
+    if (size_ > 0) {
+        void* mapped = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            ::close(fd);
+            throw Error::PathIo("io", path_, "map file");
+        }
+        data_ = static_cast<const uint8_t*>(mapped);
+    }
+
+    ::close(fd);
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : path_(std::move(other.path_)),
+      data_(std::exchange(other.data_, nullptr)),
+      size_(std::exchange(other.size_, 0)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        Unmap();
+        path_ = std::move(other.path_);
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile() { Unmap(); }
+
+std::span<const uint8_t> MappedFile::ReadAt(const uint64_t offset, const uint64_t size) const {
+    if (offset > size_ || size > size_ - offset) {
+        throw Error::PathIo("io", path_, "read file");
+    }
+    if (size == 0) {
+        return {};
+    }
+    return {data_ + offset, static_cast<size_t>(size)};
+}
+
+void MappedFile::Unmap() noexcept {
+    if (data_ != nullptr) {
+        ::munmap(const_cast<uint8_t*>(data_), size_);
+        data_ = nullptr;
+    }
+    size_ = 0;
+}
+
 std::ofstream OpenOutputFile(const std::filesystem::path& path, const FileOpenMode mode) {
     std::ofstream file(path, std::ios::binary | (mode == FileOpenMode::Append ? std::ios::app : std::ios::trunc));
     if (!file.is_open()) {
@@ -106,6 +185,118 @@ std::ofstream OpenOutputFile(const std::filesystem::path& path, const FileOpenMo
     return file;
 }
 
+void SyncFile(const std::filesystem::path& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw Error::PathIo("io", path, "open for sync");
+    }
+
+    const int result = ::fsync(fd);
+    ::close(fd);
+    if (result != 0) {
+        throw Error::PathIo("io", path, "sync");
+    }
+}
+
+void SyncParentDirectory(const std::filesystem::path& path) {
+    const std::filesystem::path directory = path.has_parent_path() ? path.parent_path() : ".";
+    const int fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        throw Error::PathIo("io", directory, "open directory for sync");
+    }
+
+    const int result = ::fsync(fd);
+    ::close(fd);
+    if (result != 0) {
+        throw Error::PathIo("io", directory, "sync directory");
+    }
+}
+
+std::unique_ptr<FileLock> FileLock::TryAcquire(const std::filesystem::path& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        if (errno == ENOENT) {
+            return nullptr;
+        }
+        throw Error::PathIo("io", path, "open for lock");
+    }
+    std::unique_ptr<FileLock> lock(new FileLock(fd));
+
+    int result = 0;
+    do {
+        result = ::flock(fd, LOCK_EX | LOCK_NB);
+    } while (result != 0 && errno == EINTR);
+    if (result != 0) {
+        if (errno == EWOULDBLOCK) {
+            return nullptr;
+        }
+        throw Error::PathIo("io", path, "lock file");
+    }
+
+    // The holder that was released may have removed or replaced the file in the meantime.
+    struct stat locked{};
+    struct stat current{};
+    if (::fstat(fd, &locked) != 0 || ::stat(path.c_str(), &current) != 0 || locked.st_dev != current.st_dev ||
+        locked.st_ino != current.st_ino) {
+        return nullptr;
+    }
+    return lock;
+}
+
+FileLock::~FileLock() { ::close(fd_); }
+
+OutputFile::OutputFile(std::filesystem::path path) : path_(std::move(path)) {
+    fd_ = ::open(path_.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+    if (fd_ < 0) {
+        throw Error::PathIo("io", path_, "open for write");
+    }
+}
+
+OutputFile::OutputFile(OutputFile&& other) noexcept
+    : path_(std::move(other.path_)), fd_(std::exchange(other.fd_, -1)) {}
+
+OutputFile& OutputFile::operator=(OutputFile&& other) noexcept {
+    if (this != &other) {
+        CloseQuietly();
+        path_ = std::move(other.path_);
+        fd_ = std::exchange(other.fd_, -1);
+    }
+    return *this;
+}
+
+OutputFile::~OutputFile() { CloseQuietly(); }
+
+void OutputFile::Write(std::string_view bytes) {
+    while (!bytes.empty()) {
+        const ssize_t written = ::write(fd_, bytes.data(), bytes.size());
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw Error::PathIo("io", path_, "write file");
+        }
+        bytes.remove_prefix(static_cast<size_t>(written));
+    }
+}
+
+void OutputFile::Close() {
+    if (fd_ < 0) {
+        return;
+    }
+    // The descriptor is released even when close fails, so it is never retried; EINTR loses nothing that was written.
+    const int result = ::close(std::exchange(fd_, -1));
+    if (result != 0 && errno != EINTR) {
+        throw Error::PathIo("io", path_, "close file");
+    }
+}
+
+void OutputFile::CloseQuietly() noexcept {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
 std::string ReadTextFile(const std::filesystem::path& path) {
     std::ifstream file = OpenInputFile(path);
     return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
@@ -0,0 +1,428 @@
+#include "io/io_scheduler.h"
+
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#ifdef COLUMNAR_HAVE_LIBURING
+#include <liburing.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "common/error.h"
+#include "common/thread_pool.h"
+
+static constexpr uint64_t MaxReadSize = uint64_t{1} << 30;
+static constexpr size_t PreadvMaxThreads = 4;
+
+class ReadOnlyFile {
+   public:
+    explicit ReadOnlyFile(const std::filesystem::path& path) : fd_(::open(path.c_str(), O_RDONLY | O_CLOEXEC)) {
+        if (fd_ < 0) {
+            throw Error::PathIo("io", path, "open for read");
+        }
+    }
+    ReadOnlyFile(const ReadOnlyFile&) = delete;
+    ReadOnlyFile& operator=(const ReadOnlyFile&) = delete;
+    ~ReadOnlyFile() { ::close(fd_); }
+
+    int Descriptor() const { return fd_; }
+
+   private:
+    int fd_ = -1;
+};
+
+// Submit splits the batch into runs of adjacent requests and reads each run with one preadv on a small pool, so the
+// reads overlap with whatever the caller does before Wait().
+class PreadvIoScheduler final : public IoScheduler {
+   public:
+    PreadvIoScheduler(std::filesystem::path path, const size_t threads)
+        : path_(std::move(path)), file_(path_), pool_(threads) {}
+
+    IoBackend Backend() const override { return IoBackend::Preadv; }
+
+    Ticket Submit(std::vector<IoReadRequest> requests) override {
+        std::ranges::sort(requests, {}, &IoReadRequest::offset);
+
+        std::vector<std::future<void>> reads;
+        size_t begin = 0;
+        while (begin < requests.size()) {
+            size_t end = begin + 1;
+            while (end < requests.size() && end - begin < static_cast<size_t>(IOV_MAX) &&
+                   requests[end].offset == requests[end - 1].offset + requests[end - 1].buffer.size()) {
+                ++end;
+            }
+
+            std::vector<IoReadRequest> run(requests.begin() + static_cast<std::ptrdiff_t>(begin),
+                                           requests.begin() + static_cast<std::ptrdiff_t>(end));
+            reads.push_back(pool_.Submit([this, run = std::move(run)] { ReadContiguous(run); }));
+            begin = end;
+        }
+
+        std::lock_guard lock(mutex_);
+        const Ticket ticket = next_ticket_++;
+        pending_.emplace(ticket, std::move(reads));
+        return ticket;
+    }
+
+    void Wait(const Ticket ticket) override {
+        std::vector<std::future<void>> reads;
+        {
+            std::lock_guard lock(mutex_);
+            const auto it = pending_.find(ticket);
+            if (it == pending_.end()) {
+                throw Error::InvalidArgument("io", "unknown io ticket", path_.string());
+            }
+            reads = std::move(it->second);
+            pending_.erase(it);
+        }
+
+        // Every run must be done with its buffers before a failure is reported.
+        for (const auto& read : reads) {
+            read.wait();
+        }
+        for (auto& read : reads) {
+            read.get();
+        }
+    }
+
+   private:
+    void ReadContiguous(const std::span<const IoReadRequest> run) const {
+        std::vector<iovec> iov;
+        iov.reserve(run.size());
+        for (const auto& request : run) {
+            if (!request.buffer.empty()) {
+                iov.push_back({request.buffer.data(), request.buffer.size()});
+            }
+        }
+
+        uint64_t offset = run.front().offset;
+        size_t first = 0;
+
+        while (first < iov.size()) {
+            const ssize_t read = ::preadv(file_.Descriptor(), iov.data() + first, static_cast<int>(iov.size() - first),
+                                          static_cast<off_t>(offset));
+            if (read < 0 && errno == EINTR) {
+                continue;
+            }
+            if (read <= 0) {
+                throw Error::PathIo("io", path_, "read file");
+            }
+
+            offset += static_cast<uint64_t>(read);
+            size_t consumed = static_cast<size_t>(read);
+            while (first < iov.size() && consumed >= iov[first].iov_len) {
+                consumed -= iov[first].iov_len;
+                ++first;
+            }
+            if (consumed > 0) {
+                iov[first].iov_base = static_cast<uint8_t*>(iov[first].iov_base) + consumed;
+                iov[first].iov_len -= consumed;
+            }
+        }
+    }
+
+    std::filesystem::path path_;
+    ReadOnlyFile file_;
+
+    std::mutex mutex_;
+    std::unordered_map<Ticket, std::vector<std::future<void>>> pending_;
+    Ticket next_ticket_ = 0;
+
+    // Last, so its workers finish the outstanding reads before the file is closed.
+    ThreadPool pool_;
+};
+
+#ifdef COLUMNAR_HAVE_LIBURING
+
+class IoUringScheduler final : public IoScheduler {
+   public:
+    IoUringScheduler(std::filesystem::path path, const size_t queue_depth)
+        : path_(std::move(path)), file_(path_), capacity_(std::clamp<size_t>(queue_depth, 1, 4096)) {
+        if (io_uring_queue_init(static_cast<unsigned>(capacity_), &ring_, 0) < 0) {
+            throw Error::Unsupported("io", "io_uring is not available", path_.string());
+        }
+    }
+
+    ~IoUringScheduler() override {
+        std::unique_lock lock(mutex_);
+        try {
+            Drain(lock);
+        } catch (const Error&) {
+        }
+        io_uring_queue_exit(&ring_);
+    }
+
+    IoBackend Backend() const override { return IoBackend::IoUring; }
+
+    Ticket Submit(std::vector<IoReadRequest> requests) override {
+        std::unique_lock lock(mutex_);
+        const Ticket ticket = next_ticket_++;
+        PendingBatch& batch = batches_[ticket];
+
+        batch.reads.reserve(requests.size());
+        for (const auto& request : requests) {
+            if (!request.buffer.empty()) {
+                batch.reads.push_back({request, 0, &batch});
+            }
+        }
+        batch.remaining = batch.reads.size();
+
+        size_t queued = 0;
+        try {
+            for (auto& read : batch.reads) {
+                Queue(read, lock);
+                ++queued;
+            }
+            SubmitQueued();
+        } catch (const Error&) {
+            if (!broken_) {
+                batch.remaining -= batch.reads.size() - queued;
+            }
+            Drain(lock);
+            batches_.erase(ticket);
+            throw;
+        }
+
+        return ticket;
+    }
+
+    void Wait(const Ticket ticket) override {
+        std::unique_lock lock(mutex_);
+        const auto it = batches_.find(ticket);
+        if (it == batches_.end()) {
+            throw Error::InvalidArgument("io", "unknown io ticket", path_.string());
+        }
+
+        while (it->second.remaining > 0) {
+            ReapOne(lock);
+        }
+
+        const bool failed = it->second.failed;
+        batches_.erase(it);
+        if (failed) {
+            throw Error::PathIo("io", path_, "read file");
+        }
+    }
+
+   private:
+    struct PendingBatch;
+
+    struct UringRead {
+        IoReadRequest request;
+        uint64_t done = 0;
+        PendingBatch* owner = nullptr;
+    };
+
+    struct PendingBatch {
+        std::vector<UringRead> reads;
+        size_t remaining = 0;
+        bool failed = false;
+    };
+
+    void Queue(UringRead& read, std::unique_lock<std::mutex>& lock) {
+        if (broken_) {
+            throw Error::Io("io", "io_uring completion wait failed", path_.string());
+        }
+        while (in_flight_ >= capacity_) {
+            SubmitQueued();
+            ReapOne(lock);
+        }
+
+        io_uring_sqe* sqe = io_uring_get_sqe(&ring_);
+        if (sqe == nullptr) {
+            throw Error::Io("io", "io_uring submission queue is full", path_.string());
+        }
+
+        const uint64_t length = std::min(read.request.buffer.size() - read.done, MaxReadSize);
+        io_uring_prep_read(sqe, file_.Descriptor(), read.request.buffer.data() + read.done,
+                           static_cast<unsigned>(length), read.request.offset + read.done);
+        io_uring_sqe_set_data(sqe, &read);
+        ++in_flight_;
+    }
+
+    void SubmitQueued() {
+        int rc = 0;
+        do {
+            rc = io_uring_submit(&ring_);
+        } while (rc == -EINTR);
+
+        if (rc < 0) {
+            throw Error::Io("io", "io_uring submit failed", path_.string());
+        }
+    }
+
+    // One thread at a time blocks for a completion, without the lock so that Submit and other tickets go ahead. The
+    // other callers sleep until it has recorded its completion, then recheck what they are waiting for.
+    void ReapOne(std::unique_lock<std::mutex>& lock) {
+        if (reaping_) {
+            reaped_.wait(lock);
+            return;
+        }
+
+        reaping_ = true;
+        lock.unlock();
+
+        io_uring_cqe* cqe = nullptr;
+        int rc = 0;
+        do {
+            rc = io_uring_wait_cqe(&ring_, &cqe);
+        } while (rc == -EINTR);
+
+        UringRead* read = nullptr;
+        int result = 0;
+        if (rc >= 0) {
+            read = static_cast<UringRead*>(io_uring_cqe_get_data(cqe));
+            result = cqe->res;
+            io_uring_cqe_seen(&ring_, cqe);
+        }
+
+        lock.lock();
+        reaping_ = false;
+        reaped_.notify_all();
+
+        if (rc < 0) {
+            FailOutstanding();
+            return;
+        }
+
+        --in_flight_;
+        Complete(*read, result, lock);
+    }
+
+    // A failed wait does not say which read it was for, so the ring is given up: every outstanding batch fails through
+    // its own Wait, and later reads are refused.
+    void FailOutstanding() {
+        broken_ = true;
+        in_flight_ = 0;
+        for (auto& [ticket, batch] : batches_) {
+            if (batch.remaining > 0) {
+                batch.failed = true;
+                batch.remaining = 0;
+            }
+        }
+    }
+
+    void Complete(UringRead& read, const int result, std::unique_lock<std::mutex>& lock) {
+        PendingBatch& batch = *read.owner;
+
+        if (result > 0) {
+            read.done += static_cast<uint64_t>(result);
+            if (read.done == read.request.buffer.size()) {
+                --batch.remaining;
+                return;
+            }
+        } else if (result != -EINTR && result != -EAGAIN) {
+            batch.failed = true;
+            --batch.remaining;
+            return;
+        }
+
+        try {
+            Queue(read, lock);
+            SubmitQueued();
+        } catch (const Error&) {
+            if (!broken_) {
+                --batch.remaining;
+            }
+            batch.failed = true;
+        }
+    }
+
+    void Drain(std::unique_lock<std::mutex>& lock) {
+        if (in_flight_ > 0) {
+            SubmitQueued();
+        }
+        while (in_flight_ > 0) {
+            ReapOne(lock);
+        }
+    }
+
+    std::filesystem::path path_;
+    ReadOnlyFile file_;
+
+    std::mutex mutex_;
+    std::condition_variable reaped_;
+    bool reaping_ = false;
+    bool broken_ = false;
+    io_uring ring_{};
+    size_t capacity_ = 0;
+    size_t in_flight_ = 0;
+
+    std::unordered_map<Ticket, PendingBatch> batches_;
+    Ticket next_ticket_ = 0;
+};
+
+#endif
+
+const char* IoBackendName(const IoBackend backend) {
+    switch (backend) {
+        case IoBackend::Auto:
+            return "auto";
+        case IoBackend::Preadv:
+            return "preadv";
+        case IoBackend::IoUring:
+            return "io_uring";
+    }
+
+    throw Error::InvalidArgument("io", "unknown io backend");
+}
+
+IoBackend IoBackendFromName(const std::string_view name) {
+    if (name == "auto") {
+        return IoBackend::Auto;
+    }
+    if (name == "preadv") {
+        return IoBackend::Preadv;
+    }
+    if (name == "io_uring") {
+        return IoBackend::IoUring;
+    }
+
+    throw Error::InvalidArgument("io", "unsupported io backend: " + std::string(name));
+}
+
+bool IoUringAvailable() {
+#ifdef COLUMNAR_HAVE_LIBURING
+    return true;
+#else
+    return false;
+#endif
+}
+
+std::unique_ptr<IoScheduler> CreateIoScheduler(const std::filesystem::path& path, const IoBackend backend,
+                                               const size_t queue_depth) {
+    switch (backend) {
+        case IoBackend::Preadv:
+            return std::make_unique<PreadvIoScheduler>(path, std::min(queue_depth, PreadvMaxThreads));
+        case IoBackend::IoUring:
+#ifdef COLUMNAR_HAVE_LIBURING
+            return std::make_unique<IoUringScheduler>(path, queue_depth);
+#else
+            throw Error::Unsupported("io", "built without io_uring support", path.string());
+#endif
+        case IoBackend::Auto:
+            break;
+    }
+
+#ifdef COLUMNAR_HAVE_LIBURING
+    try {
+        return std::make_unique<IoUringScheduler>(path, queue_depth);
+    } catch (const Error& error) {
+        if (error.GetCode() != Error::Code::Unsupported) {
+            throw;
+        }
+    }
+#endif
+
+    return std::make_unique<PreadvIoScheduler>(path, std::min(queue_depth, PreadvMaxThreads));
+}
@@ -0,0 +1,110 @@
+#include "io/metadata_cache.h"
+
+#include <sstream>
+#include <utility>
+#include <vector>
+
+#include "common/error.h"
+#include "io/columnar_batch.h"
+#include "io/file.h"
+
+// Copied out of the mapping, so a cached footer neither pins the whole file nor faults if the file is truncated.
+static std::vector<uint8_t> ReadFlatFooter(const MappedFile& file) {
+    const std::span<const uint8_t> blob = ColumnarBatchReader::MetadataBlob(file);
+    if (MetadataView::IsFlat(blob)) {
+        return std::vector<uint8_t>(blob.begin(), blob.end());
+    }
+
+    std::istringstream legacy(std::string(reinterpret_cast<const char*>(blob.data()), blob.size()), std::ios::binary);
+    std::ostringstream flat(std::ios::binary);
+    WriteMetadata(flat, ReadMetadata(legacy));
+    const std::string converted = flat.str();
+    return std::vector<uint8_t>(converted.begin(), converted.end());
+}
+
+// Owns the bytes behind a cached view, and remembers how much of the file they describe.
+struct CachedFooter {
+    explicit CachedFooter(const MappedFile& file) : bytes(ReadFlatFooter(file)), view(bytes), file_size(file.Size()) {
+        if (view.GetSchema().columns.empty()) {
+            throw Error::MalformedData("io", "columnar schema is empty", file.Path().string());
+        }
+    }
+
+    CachedFooter(const CachedFooter&) = delete;
+    CachedFooter& operator=(const CachedFooter&) = delete;
+
+    std::vector<uint8_t> bytes;
+    MetadataView view;
+    uint64_t file_size = 0;
+};
+
+MetadataCache::MetadataCache(const size_t capacity_bytes) : capacity_bytes_(capacity_bytes) {}
+
+MetadataCache& MetadataCache::Instance() {
+    static MetadataCache instance;
+    return instance;
+}
+
+std::shared_ptr<const MetadataView> MetadataCache::Get(const std::filesystem::path& path) {
+    const auto file_metadata = GetFileMetadata(path);
+    if (!file_metadata || !file_metadata->is_regular) {
+        throw Error::NotFound("io", "columnar file not found", path.string());
+    }
+
+    const std::string key = path.lexically_normal().string();
+    {
+        std::lock_guard lock(mutex_);
+        const auto it = entries_.find(key);
+        if (it != entries_.end() && it->second.size == file_metadata->size &&
+            it->second.last_write_time == file_metadata->last_write_time) {
+            recency_.splice(recency_.begin(), recency_, it->second.recency);
+            return it->second.metadata;
+        }
+    }
+
+    // Opened outside the lock so concurrent queries on other files are not serialized behind it.
+    const auto footer = std::make_shared<const CachedFooter>(ColumnarBatchReader::OpenFile(path));
+    std::shared_ptr<const MetadataView> metadata(footer, &footer->view);
+
+    std::lock_guard lock(mutex_);
+    const auto [it, inserted] = entries_.try_emplace(key);
+    if (inserted) {
+        it->second.recency = recency_.insert(recency_.begin(), key);
+    } else {
+        footer_bytes_ -= it->second.footer_bytes;
+        recency_.splice(recency_.begin(), recency_, it->second.recency);
+    }
+
+    // While an append runs the footer only covers the committed start of the file, and the entry goes stale as soon
+    // as the file grows past it.
+    it->second.size = footer->file_size;
+    it->second.last_write_time = file_metadata->last_write_time;
+    it->second.metadata = metadata;
+    it->second.footer_bytes = footer->bytes.size();
+    footer_bytes_ += footer->bytes.size();
+
+    Evict();
+    return metadata;
+}
+
+// The most recent entry always stays, however large its footer.
+void MetadataCache::Evict() {
+    while (footer_bytes_ > capacity_bytes_ && recency_.size() > 1) {
+        const auto it = entries_.find(recency_.back());
+        footer_bytes_ -= it->second.footer_bytes;
+        entries_.erase(it);
+        recency_.pop_back();
+    }
+}
+
+void MetadataCache::Clear() {
+    std::lock_guard lock(mutex_);
+    entries_.clear();
+    recency_.clear();
+    footer_bytes_ = 0;
+}
+
+size_t MetadataCache::Size() const {
+    std::lock_guard lock(mutex_);
+    return entries_.size();
+}
@@ -0,0 +1,139 @@
+#include "io/table_files.h"
+
+#include <algorithm>
+#include <optional>
+#include <sstream>
+#include <system_error>
+
+#include "common/error.h"
+#include "io/file.h"
+
+static std::optional<int> HexDigit(const char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return std::nullopt;
+}
+
+// Hive escapes characters such as '/', '=' and ':' in partition values as %XX.
+static std::string UnescapePartitionValue(const std::string_view value) {
+    std::string result;
+    result.reserve(value.size());
+
+    for (size_t i = 0; i < value.size(); ++i) {
+        if (value[i] == '%' && i + 2 < value.size()) {
+            const auto high = HexDigit(value[i + 1]);
+            const auto low = HexDigit(value[i + 2]);
+            if (high && low) {
+                result.push_back(static_cast<char>(*high * 16 + *low));
+                i += 2;
+                continue;
+            }
+        }
+        result.push_back(value[i]);
+    }
+
+    return result;
+}
+
+static TableFile MakeTableFile(const std::filesystem::path& root, const std::filesystem::path& relative) {
+    TableFile file{.path = root / relative, .partition_values = {}};
+
+    for (const auto& component : relative.parent_path()) {
+        const std::string name = component.string();
+        const size_t separator = name.find('=');
+        if (separator == std::string::npos || separator == 0) {
+            continue;
+        }
+        file.partition_values.emplace_back(name.substr(0, separator),
+                                           UnescapePartitionValue(std::string_view(name).substr(separator + 1)));
+    }
+
+    return file;
+}
+
+static bool IsHiddenName(const std::filesystem::path& path) {
+    const std::string name = path.filename().string();
+    return name.starts_with('.') || name.starts_with('_');
+}
+
+static std::vector<TableFile> ListDirectory(const std::filesystem::path& root) {
+    std::vector<std::filesystem::path> paths;
+
+    std::error_code error;
+    auto it = std::filesystem::recursive_directory_iterator(root, error);
+    if (error) {
+        throw Error::PathIo("io", root, "list table directory");
+    }
+
+    for (; it != std::filesystem::recursive_directory_iterator(); it.increment(error)) {
+        if (error) {
+            throw Error::PathIo("io", root, "list table directory");
+        }
+        if (IsHiddenName(it->path())) {
+            if (it->is_directory()) {
+                it.disable_recursion_pending();
+            }
+            continue;
+        }
+        if (it->is_regular_file()) {
+            paths.push_back(it->path().lexically_relative(root));
+        }
+    }
+
+    std::ranges::sort(paths);
+
+    std::vector<TableFile> files;
+    files.reserve(paths.size());
+    for (const auto& relative : paths) {
+        files.push_back(MakeTableFile(root, relative));
+    }
+    return files;
+}
+
+static std::vector<TableFile> ReadManifest(const std::filesystem::path& manifest) {
+    std::istringstream lines(ReadTextFile(manifest));
+    const std::filesystem::path root = manifest.parent_path();
+
+    std::vector<TableFile> files;
+    std::string line;
+    while (std::getline(lines, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.empty() || line.starts_with('#')) {
+            continue;
+        }
+
+        const std::filesystem::path listed(line);
+        if (listed.is_absolute()) {
+            throw Error::InvalidArgument("io", "manifest entries must be relative paths", manifest.string());
+        }
+        files.push_back(MakeTableFile(root, listed));
+    }
+
+    return files;
+}
+
+std::vector<TableFile> ListTableFiles(const std::filesystem::path& path) {
+    std::vector<TableFile> files;
+    if (std::filesystem::is_directory(path)) {
+        files = ListDirectory(path);
+    } else if (path.extension() == TableManifestExtension) {
+        files = ReadManifest(path);
+    } else {
+        files.push_back({.path = path, .partition_values = {}});
+    }
+
+    if (files.empty()) {
+        throw Error::NotFound("io", "table has no columnar files", path.string());
+    }
+
+    return files;
+}
@@ -69,22 +69,34 @@ void Batch::AppendValueFromColumn(const size_t column_index, const Column& sourc
 }
 
 void Batch::AppendColumnRange(const size_t column_index, const Column& source, const size_t begin,
-                              const size_t count) const {
+                              const size_t count) {
     if (column_index >= columns_.size()) {
         throw Error::OutOfRange("model", "column index out of range");
     }
+    AdoptCompatibleColumn(column_index, source);
     columns_[column_index]->AppendRangeFromColumn(source, begin, count);
 }
 
 void Batch::AppendColumnSelected(const size_t column_index, const Column& source,
-                                 const std::span<const size_t> rows) const {
+                                 const std::span<const size_t> rows) {
     if (column_index >= columns_.size()) {
         throw Error::OutOfRange("model", "column index out of range");
     }
+    AdoptCompatibleColumn(column_index, source);
     columns_[column_index]->AppendSelectedFromColumn(source, rows);
 }
 
-void Batch::AppendRowsRangeFromBatch(const Batch& source, const size_t begin, const size_t count) const {
+void Batch::AdoptCompatibleColumn(const size_t column_index, const Column& source) {
+    MutableColumn& target = *columns_[column_index];
+    if (target.Size() != 0 || target.Type() != source.Type()) {
+        return;
+    }
+    if (auto column = source.CreateCompatibleColumn()) {
+        columns_[column_index] = std::move(column);
+    }
+}
+
+void Batch::AppendRowsRangeFromBatch(const Batch& source, const size_t begin, const size_t count) {
     if (source.ColumnsCount() != ColumnsCount()) {
         throw Error::InconsistentData("model", "batch column count mismatch");
     }
@@ -93,7 +105,7 @@ void Batch::AppendRowsRangeFromBatch(const Batch& source, const size_t begin, co
     }
 }
 
-void Batch::AppendRowsSelectedFromBatch(const Batch& source, const std::span<const size_t> rows) const {
+void Batch::AppendRowsSelectedFromBatch(const Batch& source, const std::span<const size_t> rows) {
     if (source.ColumnsCount() != ColumnsCount()) {
         throw Error::InconsistentData("model", "batch column count mismatch");
     }
@@ -110,6 +122,32 @@ void Batch::ReadColumnFrom(const size_t column_index, std::istream& in, const ui
     columns_[column_index]->ReadFrom(in, row_count, size);
 }
 
+void Batch::ReadColumnFrom(const size_t column_index, const std::span<const uint8_t> bytes,
+                           const uint32_t row_count) const {
+    if (column_index >= columns_.size()) {
+        throw Error::OutOfRange("model", "column index out of range");
+    }
+    columns_[column_index]->ReadFrom(bytes, row_count);
+}
+
+std::optional<std::span<uint8_t>> Batch::PrepareColumnRawRead(const size_t column_index, const uint32_t row_count,
+                                                              const uint64_t size) const {
+    if (column_index >= columns_.size()) {
+        throw Error::OutOfRange("model", "column index out of range");
+    }
+    return columns_[column_index]->PrepareRawRead(row_count, size);
+}
+
+void Batch::SetColumn(const size_t column_index, std::unique_ptr<MutableColumn> column) {
+    if (column_index >= columns_.size()) {
+        throw Error::OutOfRange("model", "column index out of range");
+    }
+    if (!column || column->Type() != schema_.columns[column_index].type) {
+        throw Error::InconsistentData("model", "column type mismatch");
+    }
+    columns_[column_index] = std::move(column);
+}
+
 const Column& Batch::ColumnAt(const size_t i) const {
     if (i >= columns_.size()) {
         throw Error::OutOfRange("model", "column index out of range");
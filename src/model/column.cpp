@@ -2,6 +2,8 @@
 
 #include <memory>
 
+#include "common/error.h"
+#include "common/parsing.h"
 #include "model/column_boolean.h"
 #include "model/column_character.h"
 #include "model/column_date.h"
@@ -11,8 +13,6 @@
 #include "model/column_int64.h"
 #include "model/column_string.h"
 #include "model/column_timestamp.h"
-#include "common/error.h"
-#include "common/parsing.h"
 
 std::unique_ptr<MutableColumn> CreateColumn(const ColumnType type) {
     switch (type) {
@@ -41,6 +41,12 @@ std::unique_ptr<MutableColumn> CreateColumn(const ColumnType type) {
 
 Column::Column(const ColumnType type) : type_(type) {}
 
+void MutableColumn::AppendFromStrings(const std::span<const std::string_view> values) {
+    for (const std::string_view value : values) {
+        AppendFromString(value);
+    }
+}
+
 Int128 Column::ValueAsInt128(const size_t row) const { return ParseInt128(ValueAsString(row)); }
 
 static bool MatchesValueComparison(const Int128 lhs, const Int128 rhs, const ValueComparison comparison) {
@@ -88,6 +94,12 @@ void Column::AppendEncodedValue(const size_t row, std::string& out) const {
     out += value;
 }
 
+std::unique_ptr<MutableColumn> Column::CreateCompatibleColumn() const { return nullptr; }
+
+std::optional<std::span<uint8_t>> MutableColumn::PrepareRawRead(uint32_t, uint64_t) { return std::nullopt; }
+
+void MutableColumn::SetRunEnds(std::vector<uint32_t>) {}
+
 void Column::CheckRowIndex(const char* module, const size_t row, const size_t size) {
     if (row >= size) {
         throw Error::OutOfRange(module, "row index out of range");
@@ -0,0 +1,339 @@
+#include "model/column_dictionary_string.h"
+
+#include <cstring>
+#include <istream>
+#include <limits>
+#include <memory>
+#include <utility>
+
+#include "common/bit_packing.h"
+#include "common/error.h"
+#include "common/string_pattern_utils.h"
+#include "io/stream.h"
+#include "model/column_string.h"
+
+constexpr char EncodedValueSeparator = ':';
+
+static std::string_view SourceValue(const Column& source, const size_t row, std::string& scratch) {
+    if (const auto* dictionary_source = dynamic_cast<const DictionaryStringColumn*>(&source)) {
+        return dictionary_source->ValueAt(row);
+    }
+    if (const auto* string_source = dynamic_cast<const StringColumn*>(&source)) {
+        return string_source->ValueAt(row);
+    }
+    scratch = source.ValueAsString(row);
+    return scratch;
+}
+
+// Evaluates the predicate once per dictionary entry unless the dictionary is larger than the column itself.
+template <class Predicate>
+static void SelectRowsByCodes(const DictionaryStringColumn::Dictionary& dictionary,
+                              const std::span<const uint32_t> codes, Predicate&& matches_value,
+                              std::vector<size_t>& rows) {
+    if (dictionary.size() > codes.size()) {
+        for (size_t row = 0; row < codes.size(); ++row) {
+            if (matches_value(dictionary[codes[row]])) {
+                rows.push_back(row);
+            }
+        }
+        return;
+    }
+
+    std::vector<uint8_t> matches(dictionary.size());
+    for (size_t code = 0; code < dictionary.size(); ++code) {
+        matches[code] = matches_value(dictionary[code]) ? 1 : 0;
+    }
+
+    for (size_t row = 0; row < codes.size(); ++row) {
+        if (matches[codes[row]] != 0) {
+            rows.push_back(row);
+        }
+    }
+}
+
+static void AppendUint32(std::vector<uint8_t>& out, const uint32_t value) {
+    const size_t offset = out.size();
+    out.resize(offset + sizeof(value));
+    std::memcpy(out.data() + offset, &value, sizeof(value));
+}
+
+static uint32_t ReadUint32(const std::span<const uint8_t> bytes, uint64_t& consumed) {
+    uint32_t value = 0;
+    if (bytes.size() - consumed < sizeof(value)) {
+        throw Error::InconsistentData(DictionaryStringColumn::ModuleName(), "dictionary chunk size mismatch");
+    }
+    std::memcpy(&value, bytes.data() + consumed, sizeof(value));
+    consumed += sizeof(value);
+    return value;
+}
+
+DictionaryStringColumn::DictionaryStringColumn()
+    : MutableColumn(ColumnType::String), dictionary_(std::make_shared<const Dictionary>()) {}
+
+DictionaryStringColumn::DictionaryStringColumn(std::shared_ptr<const Dictionary> dictionary)
+    : MutableColumn(ColumnType::String), dictionary_(std::move(dictionary)) {
+    if (!dictionary_) {
+        throw Error::InvalidArgument(ModuleName(), "dictionary is null");
+    }
+}
+
+DictionaryStringColumn::DictionaryStringColumn(const DictionaryStringColumn& other)
+    : MutableColumn(other), dictionary_(other.dictionary_), codes_(other.codes_) {}
+
+DictionaryStringColumn& DictionaryStringColumn::operator=(const DictionaryStringColumn& other) {
+    if (this == &other) {
+        return *this;
+    }
+
+    MutableColumn::operator=(other);
+    dictionary_ = other.dictionary_;
+    codes_ = other.codes_;
+    owned_.reset();
+    index_.clear();
+
+    return *this;
+}
+
+std::string_view DictionaryStringColumn::ValueAt(const size_t row) const {
+    CheckRowIndex(ModuleName(), row, codes_.size());
+    return (*dictionary_)[codes_[row]];
+}
+
+size_t DictionaryStringColumn::Size() const { return codes_.size(); }
+
+void DictionaryStringColumn::Reserve(const size_t n) { codes_.reserve(n); }
+
+void DictionaryStringColumn::Clear() {
+    codes_.clear();
+    dictionary_ = std::make_shared<const Dictionary>();
+    owned_.reset();
+    index_.clear();
+}
+
+const DictionaryStringColumn* DictionaryStringColumn::SharedDictionarySource(const Column& source) {
+    const auto* dictionary_source = dynamic_cast<const DictionaryStringColumn*>(&source);
+    if (dictionary_source == nullptr) {
+        return nullptr;
+    }
+
+    if (dictionary_source->dictionary_ != dictionary_ && codes_.empty()) {
+        dictionary_ = dictionary_source->dictionary_;
+        owned_.reset();
+        index_.clear();
+    }
+
+    return dictionary_source->dictionary_ == dictionary_ ? dictionary_source : nullptr;
+}
+
+uint32_t DictionaryStringColumn::Intern(const std::string_view value) {
+    if (index_.empty()) {
+        index_.reserve(dictionary_->size());
+        for (size_t code = 0; code < dictionary_->size(); ++code) {
+            index_.emplace((*dictionary_)[code], static_cast<uint32_t>(code));
+        }
+    }
+
+    if (const auto it = index_.find(value); it != index_.end()) {
+        return it->second;
+    }
+
+    if (dictionary_->size() >= std::numeric_limits<uint32_t>::max()) {
+        throw Error::Overflow(ModuleName(), "dictionary exceeds supported size");
+    }
+
+    // Copy on write: the dictionary may be shared with columns cut from this one or with group key caches.
+    if (!owned_ || owned_.use_count() > 2) {
+        owned_ = std::make_shared<Dictionary>(*dictionary_);
+        dictionary_ = owned_;
+    }
+
+    const auto code = static_cast<uint32_t>(owned_->size());
+    owned_->emplace_back(value);
+    index_.emplace(owned_->back(), code);
+
+    return code;
+}
+
+void DictionaryStringColumn::AppendFromString(const std::string_view value) { codes_.push_back(Intern(value)); }
+
+void DictionaryStringColumn::AppendRepeated(const std::string_view value, const size_t count) {
+    codes_.insert(codes_.end(), count, Intern(value));
+}
+
+void DictionaryStringColumn::AppendFromColumn(const Column& source, const size_t row) {
+    if (source.Type() != ColumnType::String) {
+        throw Error::InconsistentData(ModuleName(), "column type mismatch");
+    }
+
+    if (const auto* dictionary_source = SharedDictionarySource(source)) {
+        CheckRowIndex(ModuleName(), row, dictionary_source->codes_.size());
+        codes_.push_back(dictionary_source->codes_[row]);
+        return;
+    }
+
+    std::string scratch;
+    codes_.push_back(Intern(SourceValue(source, row, scratch)));
+}
+
+void DictionaryStringColumn::AppendRangeFromColumn(const Column& source, const size_t begin, const size_t count) {
+    if (source.Type() != ColumnType::String) {
+        throw Error::InconsistentData(ModuleName(), "column type mismatch");
+    }
+    if (begin > source.Size() || count > source.Size() - begin) {
+        throw Error::OutOfRange(ModuleName(), "row range out of range");
+    }
+
+    if (const auto* dictionary_source = SharedDictionarySource(source)) {
+        const auto first = dictionary_source->codes_.begin() + static_cast<std::ptrdiff_t>(begin);
+        codes_.insert(codes_.end(), first, first + static_cast<std::ptrdiff_t>(count));
+        return;
+    }
+
+    codes_.reserve(codes_.size() + count);
+    std::string scratch;
+    for (size_t row = begin; row < begin + count; ++row) {
+        codes_.push_back(Intern(SourceValue(source, row, scratch)));
+    }
+}
+
+void DictionaryStringColumn::AppendSelectedFromColumn(const Column& source, const std::span<const size_t> rows) {
+    if (source.Type() != ColumnType::String) {
+        throw Error::InconsistentData(ModuleName(), "column type mismatch");
+    }
+
+    codes_.reserve(codes_.size() + rows.size());
+
+    if (const auto* dictionary_source = SharedDictionarySource(source)) {
+        for (const size_t row : rows) {
+            CheckRowIndex(ModuleName(), row, dictionary_source->codes_.size());
+            codes_.push_back(dictionary_source->codes_[row]);
+        }
+        return;
+    }
+
+    std::string scratch;
+    for (const size_t row : rows) {
+        codes_.push_back(Intern(SourceValue(source, row, scratch)));
+    }
+}
+
+std::string DictionaryStringColumn::ValueAsString(const size_t row) const { return std::string(ValueAt(row)); }
+
+void DictionaryStringColumn::SelectRowsByStringSet(const std::unordered_set<std::string>& values,
+                                                   std::vector<size_t>& rows) const {
+    SelectRowsByCodes(
+        *dictionary_, codes_, [&](const std::string& value) { return values.contains(value); }, rows);
+}
+
+void DictionaryStringColumn::SelectRowsByLikePattern(const std::string_view pattern, const bool negated,
+                                                     std::vector<size_t>& rows) const {
+    SelectRowsByCodes(
+        *dictionary_, codes_,
+        [&](const std::string& value) {
+            const bool matched = LikeMatches(value, pattern);
+            return negated ? !matched : matched;
+        },
+        rows);
+}
+
+void DictionaryStringColumn::AppendEncodedValue(const size_t row, std::string& out) const {
+    const std::string_view value = ValueAt(row);
+    out += std::to_string(value.size());
+    out.push_back(EncodedValueSeparator);
+    out += value;
+}
+
+std::unique_ptr<Column> DictionaryStringColumn::Clone() const {
+    return std::make_unique<DictionaryStringColumn>(*this);
+}
+
+std::unique_ptr<MutableColumn> DictionaryStringColumn::CloneMutable() const {
+    return std::make_unique<DictionaryStringColumn>(*this);
+}
+
+std::unique_ptr<MutableColumn> DictionaryStringColumn::CreateCompatibleColumn() const {
+    return std::make_unique<DictionaryStringColumn>(dictionary_);
+}
+
+void DictionaryStringColumn::WriteTo(std::ostream& out) const {
+    for (const uint32_t code : codes_) {
+        const std::string& value = (*dictionary_)[code];
+        if (value.size() > std::numeric_limits<uint32_t>::max()) {
+            throw Error::Overflow(ModuleName(), "value exceeds supported size");
+        }
+        WriteStream<uint32_t>(out, static_cast<uint32_t>(value.size()));
+        WriteBytes(out, value);
+    }
+}
+
+void DictionaryStringColumn::ReadFrom(std::istream& in, const uint32_t row_count, const uint64_t size) {
+    std::vector<uint8_t> bytes(size);
+    ReadBytes(in, reinterpret_cast<char*>(bytes.data()), bytes.size());
+    ReadFrom(bytes, row_count);
+}
+
+void DictionaryStringColumn::ReadFrom(const std::span<const uint8_t> bytes, const uint32_t row_count) {
+    StringColumn plain;
+    plain.ReadFrom(bytes, row_count);
+
+    Clear();
+    AppendRangeFromColumn(plain, 0, plain.Size());
+}
+
+void DictionaryStringColumn::WriteDictionaryTo(std::vector<uint8_t>& out) const {
+    if (dictionary_->size() > std::numeric_limits<uint32_t>::max()) {
+        throw Error::Overflow(ModuleName(), "dictionary exceeds supported size");
+    }
+
+    AppendUint32(out, static_cast<uint32_t>(dictionary_->size()));
+    for (const auto& value : *dictionary_) {
+        if (value.size() > std::numeric_limits<uint32_t>::max()) {
+            throw Error::Overflow(ModuleName(), "value exceeds supported size");
+        }
+        AppendUint32(out, static_cast<uint32_t>(value.size()));
+        out.insert(out.end(), value.begin(), value.end());
+    }
+
+    const uint8_t width = BitWidthFor(dictionary_->empty() ? 0 : dictionary_->size() - 1);
+    out.push_back(width);
+    PackBits<uint32_t>(codes_, width, out);
+}
+
+void DictionaryStringColumn::ReadDictionaryFrom(const std::span<const uint8_t> bytes, const uint32_t row_count) {
+    uint64_t consumed = 0;
+
+    const uint32_t dictionary_size = ReadUint32(bytes, consumed);
+    auto dictionary = std::make_shared<Dictionary>();
+    dictionary->reserve(dictionary_size);
+
+    for (uint32_t code = 0; code < dictionary_size; ++code) {
+        const uint32_t length = ReadUint32(bytes, consumed);
+        if (bytes.size() - consumed < length) {
+            throw Error::InconsistentData(ModuleName(), "dictionary chunk size mismatch");
+        }
+        dictionary->emplace_back(reinterpret_cast<const char*>(bytes.data() + consumed), length);
+        consumed += length;
+    }
+
+    if (consumed == bytes.size()) {
+        throw Error::InconsistentData(ModuleName(), "dictionary chunk size mismatch");
+    }
+    const uint8_t width = bytes[consumed++];
+    if (width > 32 || bytes.size() - consumed != PackedByteCount(row_count, width)) {
+        throw Error::InconsistentData(ModuleName(), "dictionary chunk size mismatch");
+    }
+
+    std::vector<uint32_t> codes(row_count);
+    UnpackBits<uint32_t>(bytes.subspan(consumed), width, codes);
+
+    for (const uint32_t code : codes) {
+        if (code >= dictionary->size()) {
+            throw Error::MalformedData(ModuleName(), "dictionary code out of range");
+        }
+    }
+
+    codes_ = std::move(codes);
+    owned_ = std::move(dictionary);
+    dictionary_ = owned_;
+    index_.clear();
+}
@@ -1,67 +1,116 @@
 #include "model/column_string.h"
 
+#include <cstring>
 #include <limits>
 #include <memory>
 #include <utility>
 
 #include "common/error.h"
+#include "common/string_arena.h"
 #include "common/string_pattern_utils.h"
 #include "io/stream.h"
+#include "model/column_dictionary_string.h"
 
 constexpr char EncodedValueSeparator = ':';
 
 StringColumn::StringColumn() : MutableColumn(ColumnType::String) {}
 
-size_t StringColumn::Size() const { return values_.size(); }
+size_t StringColumn::Size() const { return ends_.size(); }
 
-void StringColumn::Reserve(const size_t n) { values_.reserve(n); }
+void StringColumn::Reserve(const size_t n) { ends_.reserve(n); }
 
-void StringColumn::Clear() { values_.clear(); }
+void StringColumn::Clear() {
+    bytes_.clear();
+    ends_.clear();
+}
+
+std::string_view StringColumn::StoredValue(const size_t row) const {
+    const uint64_t begin = row == 0 ? 0 : ends_[row - 1];
+    return std::string_view(bytes_).substr(begin, ends_[row] - begin);
+}
+
+void StringColumn::AppendStoredValue(const std::string_view value) {
+    bytes_.append(value);
+    ends_.push_back(bytes_.size());
+}
 
-void StringColumn::AppendFromString(const std::string_view value) { values_.emplace_back(value); }
+void StringColumn::AppendFromString(const std::string_view value) { AppendStoredValue(value); }
+
+void StringColumn::AppendFromStrings(const std::span<const std::string_view> values) {
+    for (const std::string_view value : values) {
+        AppendStoredValue(value);
+    }
+}
 
 void StringColumn::AppendFromColumn(const Column& source, const size_t row) {
     if (source.Type() != ColumnType::String) {
         throw Error::InconsistentData(ModuleName(), "column type mismatch");
     }
-    const auto& typed_source = static_cast<const StringColumn&>(source);
-    CheckRowIndex(ModuleName(), row, typed_source.values_.size());
-    values_.push_back(typed_source.values_[row]);
+    if (const auto* dictionary_source = dynamic_cast<const DictionaryStringColumn*>(&source)) {
+        AppendStoredValue(dictionary_source->ValueAt(row));
+        return;
+    }
+    AppendStoredValue(static_cast<const StringColumn&>(source).ValueAt(row));
 }
 
 void StringColumn::AppendRangeFromColumn(const Column& source, const size_t begin, const size_t count) {
     if (source.Type() != ColumnType::String) {
         throw Error::InconsistentData(ModuleName(), "column type mismatch");
     }
-    const auto& typed_source = static_cast<const StringColumn&>(source);
-    if (begin > typed_source.values_.size() || count > typed_source.values_.size() - begin) {
+    if (begin > source.Size() || count > source.Size() - begin) {
         throw Error::OutOfRange(ModuleName(), "row range out of range");
     }
-    values_.insert(values_.end(), typed_source.values_.begin() + static_cast<std::ptrdiff_t>(begin),
-                   typed_source.values_.begin() + static_cast<std::ptrdiff_t>(begin + count));
+    ends_.reserve(ends_.size() + count);
+    if (const auto* dictionary_source = dynamic_cast<const DictionaryStringColumn*>(&source)) {
+        for (size_t row = begin; row < begin + count; ++row) {
+            AppendStoredValue(dictionary_source->ValueAt(row));
+        }
+        return;
+    }
+    if (count == 0) {
+        return;
+    }
+
+    // The range is contiguous in the source's bytes, so it is copied at once and only its ends are rebased.
+    const auto& typed_source = static_cast<const StringColumn&>(source);
+    const uint64_t source_begin = begin == 0 ? 0 : typed_source.ends_[begin - 1];
+    const uint64_t source_end = typed_source.ends_[begin + count - 1];
+    const uint64_t base = bytes_.size();
+    bytes_.append(std::string_view(typed_source.bytes_).substr(source_begin, source_end - source_begin));
+    for (size_t row = begin; row < begin + count; ++row) {
+        ends_.push_back(base + typed_source.ends_[row] - source_begin);
+    }
 }
 
 void StringColumn::AppendSelectedFromColumn(const Column& source, const std::span<const size_t> rows) {
     if (source.Type() != ColumnType::String) {
         throw Error::InconsistentData(ModuleName(), "column type mismatch");
     }
+    ends_.reserve(ends_.size() + rows.size());
+    if (const auto* dictionary_source = dynamic_cast<const DictionaryStringColumn*>(&source)) {
+        for (const size_t row : rows) {
+            AppendStoredValue(dictionary_source->ValueAt(row));
+        }
+        return;
+    }
     const auto& typed_source = static_cast<const StringColumn&>(source);
-    values_.reserve(values_.size() + rows.size());
     for (const size_t row : rows) {
-        CheckRowIndex(ModuleName(), row, typed_source.values_.size());
-        values_.push_back(typed_source.values_[row]);
+        AppendStoredValue(typed_source.ValueAt(row));
     }
 }
 
-std::string StringColumn::ValueAsString(const size_t row) const {
-    CheckRowIndex(ModuleName(), row, values_.size());
-    return values_[row];
+std::string_view StringColumn::ValueAt(const size_t row) const {
+    CheckRowIndex(ModuleName(), row, ends_.size());
+    return StoredValue(row);
 }
 
+std::string StringColumn::ValueAsString(const size_t row) const { return std::string(ValueAt(row)); }
+
 void StringColumn::SelectRowsByStringSet(const std::unordered_set<std::string>& values,
                                          std::vector<size_t>& rows) const {
-    for (size_t row = 0; row < values_.size(); ++row) {
-        if (values.contains(values_[row])) {
+    const StringViewSet lookup(values.begin(), values.end());
+    for (size_t row = 0; row < ends_.size(); ++row) {
+        if (lookup.contains(StoredValue(row))) {
             rows.push_back(row);
         }
     }
@@ -69,8 +118,8 @@ void StringColumn::SelectRowsByStringSet(const std::unordered_set<std::string>&
 
 void StringColumn::SelectRowsByLikePattern(const std::string_view pattern, const bool negated,
                                            std::vector<size_t>& rows) const {
-    for (size_t row = 0; row < values_.size(); ++row) {
-        const bool matched = LikeMatches(values_[row], pattern);
+    for (size_t row = 0; row < ends_.size(); ++row) {
+        const bool matched = LikeMatches(StoredValue(row), pattern);
         if (negated ? !matched : matched) {
             rows.push_back(row);
         }
@@ -78,8 +127,7 @@ void StringColumn::SelectRowsByLikePattern(const std::string_view pattern, const
 }
 
 void StringColumn::AppendEncodedValue(const size_t row, std::string& out) const {
-    CheckRowIndex(ModuleName(), row, values_.size());
-    const std::string& value = values_[row];
+    const std::string_view value = ValueAt(row);
     out += std::to_string(value.size());
     out.push_back(EncodedValueSeparator);
     out += value;
@@ -90,7 +138,8 @@ std::unique_ptr<Column> StringColumn::Clone() const { return std::make_unique<St
 std::unique_ptr<MutableColumn> StringColumn::CloneMutable() const { return std::make_unique<StringColumn>(*this); }
 
 void StringColumn::WriteTo(std::ostream& out) const {
-    for (const auto& value : values_) {
+    for (size_t row = 0; row < ends_.size(); ++row) {
+        const std::string_view value = StoredValue(row);
         if (value.size() > std::numeric_limits<uint32_t>::max()) {
             throw Error::Overflow(ModuleName(), "value exceeds supported size");
         }
@@ -100,8 +149,8 @@ void StringColumn::WriteTo(std::ostream& out) const {
 }
 
 void StringColumn::ReadFrom(std::istream& in, const uint32_t row_count, const uint64_t size) {
-    values_.clear();
-    values_.reserve(row_count);
+    Clear();
+    ends_.reserve(row_count);
 
     uint64_t consumed = 0;
 
@@ -109,14 +158,45 @@ void StringColumn::ReadFrom(std::istream& in, const uint32_t row_count, const ui
         const uint32_t length = ReadStream<uint32_t>(in);
         consumed += sizeof(length);
 
-        std::string value(length, '\0');
-        ReadBytes(in, value.data(), value.size());
+        const size_t begin = bytes_.size();
+        bytes_.resize(begin + length);
+        ReadBytes(in, bytes_.data() + begin, length);
 
         consumed += length;
-        values_.push_back(std::move(value));
+        ends_.push_back(bytes_.size());
     }
 
     if (consumed != size) {
         throw Error::InconsistentData(ModuleName(), "column chunk size mismatch");
     }
 }
+
+void StringColumn::ReadFrom(const std::span<const uint8_t> bytes, const uint32_t row_count) {
+    Clear();
+    ends_.reserve(row_count);
+    if (bytes.size() >= static_cast<uint64_t>(row_count) * sizeof(uint32_t)) {
+        bytes_.reserve(bytes.size() - static_cast<uint64_t>(row_count) * sizeof(uint32_t));
+    }
+
+    const char* data = reinterpret_cast<const char*>(bytes.data());
+    uint64_t consumed = 0;
+
+    for (uint32_t row_index = 0; row_index < row_count; ++row_index) {
+        uint32_t length = 0;
+        if (bytes.size() - consumed < sizeof(length)) {
+            throw Error::InconsistentData(ModuleName(), "column chunk size mismatch");
+        }
+        std::memcpy(&length, data + consumed, sizeof(length));
+        consumed += sizeof(length);
+
+        if (bytes.size() - consumed < length) {
+            throw Error::InconsistentData(ModuleName(), "column chunk size mismatch");
+        }
+        AppendStoredValue(std::string_view(data + consumed, length));
+        consumed += length;
+    }
+
+    if (consumed != bytes.size()) {
+        throw Error::InconsistentData(ModuleName(), "column chunk size mismatch");
+    }
+}
@@ -1,14 +1,31 @@
 #include "model/metadata.h"
 
+#include <algorithm>
 #include <array>
+#include <cstring>
+#include <iterator>
 #include <limits>
 #include <sstream>
 #include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "common/error.h"
 #include "io/stream.h"
 
 static constexpr std::array<char, 4> MetadataMagic = {'C', 'M', 'D', '2'};
+static constexpr uint32_t SectionedMetadataVersion = 3;
+static constexpr uint32_t FlatMetadataVersion = 4;
+
+// Version 3 appends tagged sections after the statistics; readers skip tags they do not know.
+enum class MetadataSection : uint32_t {
+    ChunkEncodings = 1,
+    PageZoneMaps = 2,
+    BloomFilters = 3,
+    StringStats = 4,
+    DistinctSketches = 5,
+};
 
 static ColumnType ColumnTypeFromByte(const uint8_t type_byte) {
     switch (static_cast<ColumnType>(type_byte)) {
@@ -31,12 +48,28 @@ static Compression CompressionFromByte(const uint8_t compression_byte) {
     switch (static_cast<Compression>(compression_byte)) {
         case Compression::None:
         case Compression::Lz4:
+        case Compression::Zstd:
+        case Compression::Lz4Hc:
             return static_cast<Compression>(compression_byte);
     }
 
     throw Error::MalformedData("model", "unknown compression codec in metadata");
 }
 
+static ChunkEncoding ChunkEncodingFromByte(const uint8_t encoding_byte) {
+    switch (static_cast<ChunkEncoding>(encoding_byte)) {
+        case ChunkEncoding::Plain:
+        case ChunkEncoding::Dictionary:
+        case ChunkEncoding::BitPacked:
+        case ChunkEncoding::RunLength:
+        case ChunkEncoding::Delta:
+        case ChunkEncoding::DeltaOfDelta:
+            return static_cast<ChunkEncoding>(encoding_byte);
+    }
+
+    throw Error::MalformedData("model", "unknown chunk encoding in metadata");
+}
+
 static ColumnarMetadata ReadLegacyMetadata(std::istream& in) {
     ColumnarMetadata metadata;
 
@@ -101,11 +134,203 @@ static ColumnarMetadata ReadLegacyMetadata(std::istream& in) {
     return metadata;
 }
 
-static ColumnarMetadata ReadV2Metadata(std::istream& in) {
+static void ReadChunkEncodings(std::istream& in, const uint64_t size, ColumnarMetadata& metadata) {
+    uint64_t chunk_count = 0;
+    for (const auto& row_group : metadata.row_groups) {
+        chunk_count += row_group.columns.size();
+    }
+    if (size != chunk_count) {
+        throw Error::MalformedData("model", "chunk encoding section size mismatch");
+    }
+
+    for (auto& row_group : metadata.row_groups) {
+        for (auto& column : row_group.columns) {
+            column.encoding = ChunkEncodingFromByte(ReadStream<uint8_t>(in));
+        }
+    }
+}
+
+// Per chunk: uint32 page_rows, uint32 page_count, then page_count min/max pairs.
+static void ReadPageZoneMaps(std::istream& in, const uint64_t size, ColumnarMetadata& metadata) {
+    uint64_t consumed = 0;
+
+    for (auto& row_group : metadata.row_groups) {
+        for (auto& column : row_group.columns) {
+            column.page_rows = ReadStream<uint32_t>(in);
+            const uint32_t page_count = ReadStream<uint32_t>(in);
+            consumed += 2 * sizeof(uint32_t) + uint64_t{page_count} * 2 * sizeof(Int128);
+            if (consumed > size) {
+                throw Error::MalformedData("model", "page zone map section size mismatch");
+            }
+
+            const uint64_t expected_pages =
+                column.page_rows == 0 ? 0 : (uint64_t{row_group.row_count} + column.page_rows - 1) / column.page_rows;
+            if (page_count != expected_pages) {
+                throw Error::InconsistentData("model", "page zone map count does not match row count");
+            }
+
+            column.pages.resize(page_count);
+            for (auto& page : column.pages) {
+                page.min_value = ReadStream<Int128>(in);
+                page.max_value = ReadStream<Int128>(in);
+            }
+        }
+    }
+
+    if (consumed != size) {
+        throw Error::MalformedData("model", "page zone map section size mismatch");
+    }
+}
+
+// Per chunk: uint32 block_count, then the filter words; chunks without a filter have zero blocks.
+static void ReadBloomFilters(std::istream& in, const uint64_t size, ColumnarMetadata& metadata) {
+    uint64_t consumed = 0;
+
+    for (auto& row_group : metadata.row_groups) {
+        for (auto& column : row_group.columns) {
+            const uint32_t block_count = ReadStream<uint32_t>(in);
+            const uint64_t word_count = uint64_t{block_count} * BloomFilter::WordsPerBlock;
+            consumed += sizeof(uint32_t) + word_count * sizeof(uint32_t);
+            if (consumed > size) {
+                throw Error::MalformedData("model", "bloom filter section size mismatch");
+            }
+
+            std::vector<uint32_t> words(word_count);
+            for (auto& word : words) {
+                word = ReadStream<uint32_t>(in);
+            }
+            column.bloom_filter = BloomFilter(std::move(words));
+        }
+    }
+
+    if (consumed != size) {
+        throw Error::MalformedData("model", "bloom filter section size mismatch");
+    }
+}
+
+static std::string ReadStatsString(std::istream& in, uint64_t& consumed, const uint64_t size) {
+    const uint32_t length = ReadStream<uint32_t>(in);
+    consumed += sizeof(uint32_t) + length;
+    if (consumed > size) {
+        throw Error::MalformedData("model", "string statistics section size mismatch");
+    }
+
+    std::string value(length, '\0');
+    ReadBytes(in, value.data(), value.size());
+    return value;
+}
+
+// Per chunk: uint8 present flag, then min and max as uint32 length + bytes, uint32 empty count, uint32 max length.
+static void ReadStringStats(std::istream& in, const uint64_t size, ColumnarMetadata& metadata) {
+    uint64_t consumed = 0;
+
+    for (auto& row_group : metadata.row_groups) {
+        for (auto& column : row_group.columns) {
+            consumed += sizeof(uint8_t);
+            if (consumed > size) {
+                throw Error::MalformedData("model", "string statistics section size mismatch");
+            }
+
+            column.has_string_stats = ReadStream<uint8_t>(in) != 0;
+            if (!column.has_string_stats) {
+                continue;
+            }
+
+            column.string_min = ReadStatsString(in, consumed, size);
+            column.string_max = ReadStatsString(in, consumed, size);
+
+            consumed += 2 * sizeof(uint32_t);
+            if (consumed > size) {
+                throw Error::MalformedData("model", "string statistics section size mismatch");
+            }
+            column.empty_count = ReadStream<uint32_t>(in);
+            column.max_length = ReadStream<uint32_t>(in);
+
+            if (column.empty_count > row_group.row_count) {
+                throw Error::InconsistentData("model", "empty string count exceeds row count");
+            }
+        }
+    }
+
+    if (consumed != size) {
+        throw Error::MalformedData("model", "string statistics section size mismatch");
+    }
+}
+
+// Per chunk: uint8 present flag, then uint32 size and the serialized sketch.
+static void ReadDistinctSketches(std::istream& in, const uint64_t size, ColumnarMetadata& metadata) {
+    uint64_t consumed = 0;
+
+    for (auto& row_group : metadata.row_groups) {
+        for (auto& column : row_group.columns) {
+            consumed += sizeof(uint8_t);
+            if (consumed > size) {
+                throw Error::MalformedData("model", "distinct sketch section size mismatch");
+            }
+            if (ReadStream<uint8_t>(in) == 0) {
+                continue;
+            }
+
+            consumed += sizeof(uint32_t);
+            if (consumed > size) {
+                throw Error::MalformedData("model", "distinct sketch section size mismatch");
+            }
+            const uint32_t sketch_size = ReadStream<uint32_t>(in);
+            consumed += sketch_size;
+            if (consumed > size) {
+                throw Error::MalformedData("model", "distinct sketch section size mismatch");
+            }
+
+            std::vector<uint8_t> bytes(sketch_size);
+            ReadBytes(in, reinterpret_cast<char*>(bytes.data()), bytes.size());
+            column.distinct_sketch = HyperLogLog::Deserialize(bytes);
+        }
+    }
+
+    if (consumed != size) {
+        throw Error::MalformedData("model", "distinct sketch section size mismatch");
+    }
+}
+
+static void ReadSections(std::istream& in, ColumnarMetadata& metadata) {
+    const uint32_t section_count = ReadStream<uint32_t>(in);
+
+    for (uint32_t i = 0; i < section_count; ++i) {
+        const auto tag = static_cast<MetadataSection>(ReadStream<uint32_t>(in));
+        const uint64_t size = ReadStream<uint64_t>(in);
+
+        switch (tag) {
+            case MetadataSection::ChunkEncodings:
+                ReadChunkEncodings(in, size, metadata);
+                continue;
+            case MetadataSection::PageZoneMaps:
+                ReadPageZoneMaps(in, size, metadata);
+                continue;
+            case MetadataSection::BloomFilters:
+                ReadBloomFilters(in, size, metadata);
+                continue;
+            case MetadataSection::StringStats:
+                ReadStringStats(in, size, metadata);
+                continue;
+            case MetadataSection::DistinctSketches:
+                ReadDistinctSketches(in, size, metadata);
+                continue;
+        }
+
+        if (size > static_cast<uint64_t>(std::numeric_limits<std::streamsize>::max())) {
+            throw Error::MalformedData("model", "metadata section too large");
+        }
+        in.ignore(static_cast<std::streamsize>(size));
+        if (static_cast<uint64_t>(in.gcount()) != size) {
+            throw Error::MalformedData("model", "truncated metadata section");
+        }
+    }
+}
+
+static ColumnarMetadata ReadVersionedMetadata(std::istream& in, const uint32_t version) {
     ColumnarMetadata metadata;
 
-    const uint32_t version = ReadStream<uint32_t>(in);
-    if (version != 2) {
+    if (version != 2 && version != SectionedMetadataVersion) {
         throw Error::MalformedData("model", "unsupported metadata version");
     }
 
@@ -163,6 +388,10 @@ static ColumnarMetadata ReadV2Metadata(std::istream& in) {
         }
     }
 
+    if (version >= 3) {
+        ReadSections(in, metadata);
+    }
+
     if (in.peek() != std::istream::traits_type::eof()) {
         throw Error::MalformedData("model", "unexpected trailing bytes in metadata");
     }
@@ -170,6 +399,246 @@ static ColumnarMetadata ReadV2Metadata(std::istream& in) {
     return metadata;
 }
 
+// Version 4 is the flat layout: FlatHeader and the schema, then tables of uint32 row counts and FlatChunkRecords (row
+// group major) at 16-byte aligned offsets, and last the extra area holding each chunk's variable-size statistics.
+struct FlatHeader {
+    std::array<char, 4> magic = MetadataMagic;
+    uint32_t version = FlatMetadataVersion;
+    uint32_t column_count = 0;
+    uint32_t row_group_count = 0;
+
+    uint64_t row_group_table = 0;
+    uint64_t chunk_table = 0;
+    uint64_t extra = 0;
+    uint64_t extra_size = 0;
+};
+
+// The chunk's extra data is its page zone maps, Bloom filter words, string bounds and sketch, in that order.
+struct FlatChunkRecord {
+    Int128 min_value = 0;
+    Int128 max_value = 0;
+
+    uint64_t offset = 0;
+    uint64_t compressed_size = 0;
+    uint64_t uncompressed_size = 0;
+    uint64_t extra_offset = 0;
+
+    uint32_t page_rows = 0;
+    uint32_t page_count = 0;
+    uint32_t bloom_blocks = 0;
+    uint32_t sketch_size = 0;
+    uint32_t string_min_size = 0;
+    uint32_t string_max_size = 0;
+    uint32_t empty_count = 0;
+    uint32_t max_length = 0;
+
+    uint8_t compression = 0;
+    uint8_t encoding = 0;
+    uint8_t flags = 0;
+    std::array<uint8_t, 13> reserved{};
+
+    uint64_t PagesSize() const { return uint64_t{page_count} * sizeof(ZoneMap); }
+    uint64_t BloomSize() const { return uint64_t{bloom_blocks} * BloomFilter::WordsPerBlock * sizeof(uint32_t); }
+    uint64_t SketchOffset() const { return PagesSize() + BloomSize() + string_min_size + string_max_size; }
+    uint64_t ExtraSize() const { return SketchOffset() + sketch_size; }
+};
+
+static_assert(sizeof(FlatHeader) == 48 && std::is_trivially_copyable_v<FlatHeader>);
+static_assert(sizeof(FlatChunkRecord) == 112 && std::is_trivially_copyable_v<FlatChunkRecord>);
+static_assert(sizeof(ZoneMap) == 2 * sizeof(Int128));
+
+static constexpr uint64_t FlatAlignment = 16;
+
+static constexpr uint8_t ChunkHasMinMax = 1;
+static constexpr uint8_t ChunkHasStringStats = 2;
+static constexpr uint8_t ChunkHasDistinctSketch = 4;
+
+template <class T>
+static T LoadFlat(const std::span<const uint8_t> blob, const uint64_t offset) {
+    if (offset > blob.size() || blob.size() - offset < sizeof(T)) {
+        throw Error::MalformedData("model", "truncated flat metadata");
+    }
+
+    T value{};
+    std::memcpy(&value, blob.data() + offset, sizeof(value));
+    return value;
+}
+
+static bool TableFits(const uint64_t offset, const uint64_t count, const uint64_t width, const uint64_t end) {
+    return offset <= end && count <= (end - offset) / width;
+}
+
+static FlatChunkRecord LoadChunkRecord(const std::span<const uint8_t> blob, const uint64_t offset,
+                                       const uint64_t extra_size) {
+    const auto record = LoadFlat<FlatChunkRecord>(blob, offset);
+    if (record.extra_offset > extra_size || record.ExtraSize() > extra_size - record.extra_offset) {
+        throw Error::MalformedData("model", "chunk statistics exceed the flat metadata");
+    }
+    return record;
+}
+
+bool MetadataView::IsFlat(const std::span<const uint8_t> blob) {
+    if (blob.size() < sizeof(FlatHeader)) {
+        return false;
+    }
+
+    const auto header = LoadFlat<FlatHeader>(blob, 0);
+    return header.magic == MetadataMagic && header.version == FlatMetadataVersion;
+}
+
+MetadataView::MetadataView(const std::span<const uint8_t> blob) : blob_(blob) {
+    if (!IsFlat(blob)) {
+        throw Error::MalformedData("model", "metadata is not in the flat layout");
+    }
+
+    const auto header = LoadFlat<FlatHeader>(blob, 0);
+
+    uint64_t cursor = sizeof(FlatHeader);
+    schema_.columns.reserve(std::min<uint64_t>(header.column_count, blob.size()));
+
+    for (uint32_t i = 0; i < header.column_count; ++i) {
+        const auto name_size = LoadFlat<uint32_t>(blob, cursor);
+        cursor += sizeof(uint32_t);
+        if (name_size > blob.size() - cursor) {
+            throw Error::MalformedData("model", "truncated flat metadata");
+        }
+
+        std::string name(reinterpret_cast<const char*>(blob.data() + cursor), name_size);
+        cursor += name_size;
+
+        const ColumnType type = ColumnTypeFromByte(LoadFlat<uint8_t>(blob, cursor));
+        cursor += sizeof(uint8_t);
+
+        schema_.columns.push_back(ColumnSchema{std::move(name), type});
+    }
+
+    if (header.extra > blob.size() || header.extra_size != blob.size() - header.extra) {
+        throw Error::MalformedData("model", "flat metadata size mismatch");
+    }
+
+    const uint64_t chunk_count = uint64_t{header.row_group_count} * header.column_count;
+    if (cursor > header.row_group_table ||
+        !TableFits(header.row_group_table, header.row_group_count, sizeof(uint32_t), header.chunk_table) ||
+        !TableFits(header.chunk_table, chunk_count, sizeof(FlatChunkRecord), header.extra)) {
+        throw Error::MalformedData("model", "flat metadata tables overlap");
+    }
+
+    row_group_count_ = header.row_group_count;
+    row_group_table_ = header.row_group_table;
+    chunk_table_ = header.chunk_table;
+    extra_ = header.extra;
+    extra_size_ = header.extra_size;
+}
+
+uint32_t MetadataView::RowCount(const size_t row_group) const {
+    if (row_group >= row_group_count_) {
+        throw Error::OutOfRange("model", "row group index out of range");
+    }
+    return LoadFlat<uint32_t>(blob_, row_group_table_ + row_group * sizeof(uint32_t));
+}
+
+uint64_t MetadataView::RecordOffset(const size_t row_group, const size_t column) const {
+    if (row_group >= row_group_count_ || column >= schema_.columns.size()) {
+        throw Error::OutOfRange("model", "column chunk index out of range");
+    }
+    return chunk_table_ + (uint64_t{row_group} * schema_.columns.size() + column) * sizeof(FlatChunkRecord);
+}
+
+ColumnChunkMetadata MetadataView::Chunk(const size_t row_group, const size_t column) const {
+    const FlatChunkRecord record = LoadChunkRecord(blob_, RecordOffset(row_group, column), extra_size_);
+    const uint32_t row_count = RowCount(row_group);
+
+    ColumnChunkMetadata chunk;
+    chunk.offset = record.offset;
+    chunk.compressed_size = record.compressed_size;
+    chunk.uncompressed_size = record.uncompressed_size;
+    chunk.compression = CompressionFromByte(record.compression);
+    chunk.encoding = ChunkEncodingFromByte(record.encoding);
+
+    chunk.has_min_max = (record.flags & ChunkHasMinMax) != 0;
+    if (chunk.has_min_max) {
+        chunk.min_value = record.min_value;
+        chunk.max_value = record.max_value;
+    }
+
+    const uint64_t expected_pages =
+        record.page_rows == 0 ? 0 : (uint64_t{row_count} + record.page_rows - 1) / record.page_rows;
+    if (record.page_count != expected_pages) {
+        throw Error::InconsistentData("model", "page zone map count does not match row count");
+    }
+
+    const uint8_t* extra = blob_.data() + extra_ + record.extra_offset;
+
+    chunk.page_rows = record.page_rows;
+    chunk.pages.resize(record.page_count);
+    std::memcpy(chunk.pages.data(), extra, record.PagesSize());
+    extra += record.PagesSize();
+
+    if (record.bloom_blocks > 0) {
+        std::vector<uint32_t> words(uint64_t{record.bloom_blocks} * BloomFilter::WordsPerBlock);
+        std::memcpy(words.data(), extra, record.BloomSize());
+        chunk.bloom_filter = BloomFilter(std::move(words));
+    }
+    extra += record.BloomSize();
+
+    chunk.has_string_stats = (record.flags & ChunkHasStringStats) != 0;
+    if (chunk.has_string_stats) {
+        chunk.string_min.assign(reinterpret_cast<const char*>(extra), record.string_min_size);
+        chunk.string_max.assign(reinterpret_cast<const char*>(extra) + record.string_min_size, record.string_max_size);
+        chunk.empty_count = record.empty_count;
+        chunk.max_length = record.max_length;
+
+        if (chunk.empty_count > row_count) {
+            throw Error::InconsistentData("model", "empty string count exceeds row count");
+        }
+    }
+
+    return chunk;
+}
+
+bool MetadataView::HasDistinctSketch(const size_t row_group, const size_t column) const {
+    return (LoadChunkRecord(blob_, RecordOffset(row_group, column), extra_size_).flags & ChunkHasDistinctSketch) != 0;
+}
+
+std::optional<HyperLogLog> MetadataView::DistinctSketch(const size_t row_group, const size_t column) const {
+    const FlatChunkRecord record = LoadChunkRecord(blob_, RecordOffset(row_group, column), extra_size_);
+    if ((record.flags & ChunkHasDistinctSketch) == 0) {
+        return std::nullopt;
+    }
+    return HyperLogLog::Deserialize(
+        blob_.subspan(extra_ + record.extra_offset + record.SketchOffset(), record.sketch_size));
+}
+
+void MetadataView::DecodeRowGroup(const size_t row_group, const std::span<const size_t> columns,
+                                  RowGroupMetadata& out) const {
+    out.row_count = RowCount(row_group);
+    out.columns.clear();
+    out.columns.resize(schema_.columns.size());
+
+    for (const size_t column : columns) {
+        out.columns[column] = Chunk(row_group, column);
+    }
+}
+
+ColumnarMetadata MetadataView::Decode() const {
+    ColumnarMetadata metadata;
+    metadata.schema = schema_;
+    metadata.row_groups.resize(row_group_count_);
+
+    for (size_t row_group = 0; row_group < row_group_count_; ++row_group) {
+        RowGroupMetadata& group = metadata.row_groups[row_group];
+        group.row_count = RowCount(row_group);
+        group.columns.reserve(schema_.columns.size());
+
+        for (size_t column = 0; column < schema_.columns.size(); ++column) {
+            group.columns.push_back(Chunk(row_group, column));
+            group.columns.back().distinct_sketch = DistinctSketch(row_group, column);
+        }
+    }
+
+    return metadata;
+}
+
 ColumnarMetadata ReadMetadata(std::istream& in) {
     const std::streampos start = in.tellg();
     if (start != std::streampos(-1)) {
@@ -177,7 +646,14 @@ ColumnarMetadata ReadMetadata(std::istream& in) {
         in.read(magic, sizeof(magic));
         if (in.gcount() == static_cast<std::streamsize>(MetadataMagic.size()) &&
             std::equal(std::begin(magic), std::end(magic), MetadataMagic.begin())) {
-            return ReadV2Metadata(in);
+            const uint32_t version = ReadStream<uint32_t>(in);
+            if (version != FlatMetadataVersion) {
+                return ReadVersionedMetadata(in, version);
+            }
+
+            in.seekg(start);
+            const std::vector<uint8_t> blob{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+            return MetadataView(blob).Decode();
         }
 
         in.clear();
@@ -187,52 +663,114 @@ ColumnarMetadata ReadMetadata(std::istream& in) {
     return ReadLegacyMetadata(in);
 }
 
-void WriteMetadata(std::ostream& out, const ColumnarMetadata& metadata) {
-    if (metadata.schema.columns.size() > std::numeric_limits<uint32_t>::max()) {
-        throw Error::Overflow("model", "too many columns for metadata");
+static uint32_t CheckedSize(const size_t size, const char* what) {
+    if (size > std::numeric_limits<uint32_t>::max()) {
+        throw Error::Overflow("model", std::string(what) + " too large for metadata");
     }
+    return static_cast<uint32_t>(size);
+}
 
-    WriteBytes(out, {MetadataMagic.data(), MetadataMagic.size()});
-    WriteStream<uint32_t>(out, 2);
-    WriteStream<uint32_t>(out, metadata.schema.columns.size());
+static FlatChunkRecord WriteChunkExtra(std::ostream& extra, const ColumnChunkMetadata& column,
+                                       std::vector<uint8_t>& sketch) {
+    FlatChunkRecord record;
+    record.offset = column.offset;
+    record.compressed_size = column.compressed_size;
+    record.uncompressed_size = column.uncompressed_size;
+    record.compression = static_cast<uint8_t>(column.compression);
+    record.encoding = static_cast<uint8_t>(column.encoding);
+    record.extra_offset = static_cast<uint64_t>(extra.tellp());
+
+    if (column.has_min_max) {
+        record.flags |= ChunkHasMinMax;
+        record.min_value = column.min_value;
+        record.max_value = column.max_value;
+    }
 
-    for (const auto& [name, type] : metadata.schema.columns) {
-        if (name.size() > std::numeric_limits<uint32_t>::max()) {
-            throw Error::Overflow("model", "column name too long");
-        }
+    record.page_rows = column.pages.empty() ? 0 : column.page_rows;
+    record.page_count = CheckedSize(column.pages.size(), "page zone maps");
+    for (const auto& page : column.pages) {
+        WriteStream(extra, page.min_value);
+        WriteStream(extra, page.max_value);
+    }
 
-        WriteStream<uint32_t>(out, name.size());
-        WriteBytes(out, name);
-        WriteStream<uint8_t>(out, static_cast<uint8_t>(type));
+    record.bloom_blocks = CheckedSize(column.bloom_filter.BlockCount(), "bloom filter");
+    for (const uint32_t word : column.bloom_filter.Words()) {
+        WriteStream(extra, word);
     }
 
-    if (metadata.row_groups.size() > std::numeric_limits<uint32_t>::max()) {
-        throw Error::Overflow("model", "too many row groups for metadata");
+    if (column.has_string_stats) {
+        record.flags |= ChunkHasStringStats;
+        record.string_min_size = CheckedSize(column.string_min.size(), "string statistic");
+        record.string_max_size = CheckedSize(column.string_max.size(), "string statistic");
+        record.empty_count = column.empty_count;
+        record.max_length = column.max_length;
+        WriteBytes(extra, column.string_min);
+        WriteBytes(extra, column.string_max);
     }
 
-    WriteStream<uint32_t>(out, metadata.row_groups.size());
+    if (column.distinct_sketch) {
+        sketch.clear();
+        column.distinct_sketch->Serialize(sketch);
+        record.flags |= ChunkHasDistinctSketch;
+        record.sketch_size = CheckedSize(sketch.size(), "distinct sketch");
+        WriteBytes(extra, {reinterpret_cast<const char*>(sketch.data()), sketch.size()});
+    }
 
-    for (const auto& [row_count, columns] : metadata.row_groups) {
-        WriteStream<uint32_t>(out, row_count);
-        WriteStream<uint32_t>(out, columns.size());
+    return record;
+}
 
-        for (const auto& column : columns) {
-            WriteStream<uint64_t>(out, column.offset);
-            WriteStream<uint64_t>(out, column.compressed_size);
-            WriteStream<uint64_t>(out, column.uncompressed_size);
-            WriteStream<uint8_t>(out, static_cast<uint8_t>(column.compression));
-        }
+static uint64_t AlignFlat(const uint64_t offset) {
+    return (offset + FlatAlignment - 1) / FlatAlignment * FlatAlignment;
+}
+
+void WriteMetadata(std::ostream& out, const ColumnarMetadata& metadata) {
+    FlatHeader header;
+    header.column_count = CheckedSize(metadata.schema.columns.size(), "column count");
+    header.row_group_count = CheckedSize(metadata.row_groups.size(), "row group count");
+
+    std::ostringstream schema(std::ios::binary);
+    for (const auto& [name, type] : metadata.schema.columns) {
+        WriteStream<uint32_t>(schema, CheckedSize(name.size(), "column name"));
+        WriteBytes(schema, name);
+        WriteStream<uint8_t>(schema, static_cast<uint8_t>(type));
     }
 
-    for (const auto& row_group : metadata.row_groups) {
-        for (const auto& column : row_group.columns) {
-            WriteStream<uint8_t>(out, column.has_min_max ? 1 : 0);
-            if (!column.has_min_max) {
-                continue;
-            }
+    std::ostringstream row_counts(std::ios::binary);
+    std::ostringstream chunks(std::ios::binary);
+    std::ostringstream extra(std::ios::binary);
+    std::vector<uint8_t> sketch;
 
-            WriteStream(out, column.min_value);
-            WriteStream(out, column.max_value);
+    for (const auto& [row_count, columns] : metadata.row_groups) {
+        if (columns.size() != metadata.schema.columns.size()) {
+            throw Error::InconsistentData("model", "row group column count mismatch");
+        }
+
+        WriteStream<uint32_t>(row_counts, row_count);
+        for (const auto& column : columns) {
+            WriteStream(chunks, WriteChunkExtra(extra, column, sketch));
         }
     }
+
+    const std::string schema_bytes = schema.str();
+    const std::string row_count_bytes = row_counts.str();
+    const std::string chunk_bytes = chunks.str();
+    const std::string extra_bytes = extra.str();
+
+    header.row_group_table = AlignFlat(sizeof(FlatHeader) + schema_bytes.size());
+    header.chunk_table = AlignFlat(header.row_group_table + row_count_bytes.size());
+    header.extra = AlignFlat(header.chunk_table + chunk_bytes.size());
+    header.extra_size = extra_bytes.size();
+
+    const auto pad_to = [&out](const uint64_t written, const uint64_t offset) {
+        WriteBytes(out, std::string(offset - written, '\0'));
+    };
+
+    WriteStream(out, header);
+    WriteBytes(out, schema_bytes);
+    pad_to(sizeof(FlatHeader) + schema_bytes.size(), header.row_group_table);
+    WriteBytes(out, row_count_bytes);
+    pad_to(header.row_group_table + row_count_bytes.size(), header.chunk_table);
+    WriteBytes(out, chunk_bytes);
+    pad_to(header.chunk_table + chunk_bytes.size(), header.extra);
+    WriteBytes(out, extra_bytes);
 }
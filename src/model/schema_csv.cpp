@@ -1,14 +1,17 @@
 #include "model/schema_csv.h"
 
 #include <array>
+#include <bit>
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "common/error.h"
 #include "common/parsing.h"
 #include "io/csv.h"
 
-static bool CanParseAs(const ColumnType type, const std::string& value) {
+static bool CanParseAs(const ColumnType type, const std::string_view value) {
     switch (type) {
         case ColumnType::Boolean:
             return TryParseBoolean(value).has_value();
@@ -33,32 +36,70 @@ static bool CanParseAs(const ColumnType type, const std::string& value) {
     throw Error::Unsupported("model", "unknown column type");
 }
 
-static ColumnType InferColumnType(const std::vector<std::string>& values) {
-    static constexpr std::array InferenceOrder = {
-        ColumnType::Boolean, ColumnType::Int16,     ColumnType::Int32,     ColumnType::Int64,  ColumnType::Int128,
-        ColumnType::Date,    ColumnType::Timestamp, ColumnType::Character, ColumnType::String,
-    };
+static constexpr std::array InferenceOrder = {
+    ColumnType::Boolean, ColumnType::Int16,     ColumnType::Int32,     ColumnType::Int64,  ColumnType::Int128,
+    ColumnType::Date,    ColumnType::Timestamp, ColumnType::Character, ColumnType::String,
+};
 
-    for (const ColumnType type : InferenceOrder) {
-        bool matches = true;
+// Bit i is set while every value seen so far parses as InferenceOrder[i]; a column gets the first type left standing.
+using TypeCandidates = uint16_t;
+static constexpr TypeCandidates AllTypeCandidates = (1u << InferenceOrder.size()) - 1;
 
-        for (const auto& value : values) {
-            if (!CanParseAs(type, value)) {
-                matches = false;
-                break;
+struct CsvTypeCandidates {
+    size_t rows = 0;
+    std::vector<TypeCandidates> columns;
+
+    void Add(const std::vector<std::string_view>& row) {
+        if (rows == 0) {
+            columns.assign(row.size(), AllTypeCandidates);
+        } else if (row.size() != columns.size()) {
+            throw Error::MalformedData("model", "csv rows have inconsistent column count");
+        }
+        ++rows;
+
+        for (size_t i = 0; i < row.size(); ++i) {
+            for (TypeCandidates left = columns[i]; left != 0; left &= left - 1) {
+                const int type = std::countr_zero(left);
+                if (!CanParseAs(InferenceOrder[type], row[i])) {
+                    columns[i] &= ~static_cast<TypeCandidates>(1u << type);
+                }
             }
         }
+    }
 
-        if (matches) {
-            return type;
+    void Merge(const CsvTypeCandidates& other) {
+        if (other.rows == 0) {
+            return;
         }
+        if (rows == 0) {
+            *this = other;
+            return;
+        }
+        if (other.columns.size() != columns.size()) {
+            throw Error::MalformedData("model", "csv rows have inconsistent column count");
+        }
+        rows += other.rows;
+        for (size_t i = 0; i < columns.size(); ++i) {
+            columns[i] &= other.columns[i];
+        }
+    }
+};
+
+static CsvTypeCandidates CollectTypeCandidates(CsvReader& reader) {
+    CsvTypeCandidates candidates;
+    std::vector<std::string_view> row;
+    while (reader.ReadRow(row)) {
+        candidates.Add(row);
     }
+    return candidates;
+}
 
-    return ColumnType::String;
+static ColumnType InferColumnType(const TypeCandidates candidates) {
+    return candidates == 0 ? ColumnType::String : InferenceOrder[std::countr_zero(candidates)];
 }
 
 Schema ReadSchemaCsv(const std::filesystem::path& path) {
-    const CsvReader reader(path);
+    CsvReader reader(path);
 
     Schema schema;
     std::vector<std::string> row;
@@ -89,35 +130,28 @@ Schema ReadSchemaCsv(const std::filesystem::path& path) {
     return schema;
 }
 
-Schema InferSchemaCsv(const std::filesystem::path& path) {
-    const CsvReader reader(path);
-
-    std::vector<std::vector<std::string>> values_by_column;
-    std::vector<std::string> row;
-
-    while (reader.ReadRow(row)) {
-        if (values_by_column.empty()) {
-            values_by_column.resize(row.size());
-        } else if (row.size() != values_by_column.size()) {
-            throw Error::MalformedData("model", "csv rows have inconsistent column count", path.string());
-        }
+Schema InferSchemaCsv(const std::filesystem::path& path, const CsvParallelOptions& options) {
+    CsvChunkParser<CsvTypeCandidates> chunks(path, options, CollectTypeCandidates);
 
-        for (size_t i = 0; i < row.size(); ++i) {
-            values_by_column[i].push_back(row[i]);
-        }
+    CsvTypeCandidates candidates;
+    while (const auto chunk = chunks.Next()) {
+        candidates.Merge(*chunk);
+    }
+    if (auto remainder = chunks.TakeRemainder()) {
+        candidates.Merge(CollectTypeCandidates(*remainder));
     }
 
-    if (values_by_column.empty()) {
+    if (candidates.rows == 0) {
         throw Error::MalformedData("model", "csv is empty", path.string());
     }
 
     Schema schema;
-    schema.columns.reserve(values_by_column.size());
+    schema.columns.reserve(candidates.columns.size());
 
-    for (size_t i = 0; i < values_by_column.size(); ++i) {
+    for (size_t i = 0; i < candidates.columns.size(); ++i) {
         schema.columns.push_back(ColumnSchema{
             "column_" + std::to_string(i + 1),
-            InferColumnType(values_by_column[i]),
+            InferColumnType(candidates.columns[i]),
         });
     }
 
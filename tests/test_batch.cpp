@@ -1,13 +1,19 @@
+#include <memory>
+#include <span>
 #include <string>
 #include <type_traits>
 #include <utility>
 #include <vector>
 
+#include "common/error.h"
+#include "common/parsing.h"
 #include "gtest/gtest.h"
 #include "io/columnar_batch.h"
 #include "io/csv.h"
 #include "io/csv_batch.h"
-#include "common/error.h"
+#include "io/csv_chunks.h"
+#include "io/file.h"
+#include "model/column_dictionary_string.h"
 #include "testing/temp_file.h"
 
 static_assert(std::is_copy_constructible_v<Batch>);
@@ -81,6 +87,98 @@ TEST(batch, csv_reader_respects_max_rows) {
     EXPECT_FALSE(reader.ReadNext().has_value());
 }
 
+static std::vector<std::vector<std::string>> ReadAllBatchRows(BatchReader& reader) {
+    std::vector<std::vector<std::string>> rows;
+    while (auto batch = reader.ReadNext()) {
+        AppendBatchRows(*batch, rows);
+    }
+    return rows;
+}
+
+TEST(batch, parallel_csv_reader_splits_outside_quoted_line_breaks) {
+    const Schema schema{{{"id", ColumnType::Int64}, {"note", ColumnType::String}}};
+    const TempFile data_in("batch_parallel_csv");
+
+    std::vector<std::vector<std::string>> data_rows;
+    for (int i = 0; i < 2000; ++i) {
+        std::string note = "n" + std::to_string(i);
+        if (i % 3 == 0) {
+            note += "\n\"x\",\r\nmore";
+        }
+        data_rows.push_back({std::to_string(i), note});
+    }
+    WriteRows(data_in.Path(), data_rows);
+
+    ThreadPool pool(4);
+    const std::vector<CsvChunk> chunks = SplitCsvFile(data_in.Path(), 997, pool);
+    ASSERT_GT(chunks.size(), 20u);
+    for (size_t i = 1; i < chunks.size(); ++i) {
+        EXPECT_EQ(chunks[i].begin, chunks[i - 1].end);
+    }
+
+    BatchSizing sizing;
+    sizing.max_rows = 64;
+    ParallelCsvBatchReader reader(data_in.Path(), schema, sizing, CsvParallelOptions{.threads = 4, .chunk_bytes = 997});
+    EXPECT_EQ(ReadAllBatchRows(reader), data_rows);
+}
+
+TEST(batch, parallel_csv_reader_tops_up_batches_at_chunk_boundaries) {
+    const Schema schema{{{"id", ColumnType::Int64}, {"note", ColumnType::String}}};
+    const TempFile data_in("batch_parallel_csv_sizes");
+
+    std::vector<std::vector<std::string>> data_rows;
+    for (int i = 0; i < 6000; ++i) {
+        data_rows.push_back({std::to_string(i), std::string(i % 17, 'x')});
+    }
+    WriteRows(data_in.Path(), data_rows);
+
+    ThreadPool pool(3);
+    const size_t chunk_count = SplitCsvFile(data_in.Path(), 8000, pool).size();
+    ASSERT_GT(chunk_count, 5u);
+
+    BatchSizing by_rows;
+    by_rows.max_rows = 100;
+    ParallelCsvBatchReader parallel(data_in.Path(), schema, by_rows,
+                                    CsvParallelOptions{.threads = 3, .chunk_bytes = 8000});
+    size_t rows = 0;
+    size_t short_batches = 0;
+    while (auto batch = parallel.ReadNext()) {
+        EXPECT_LE(batch->RowsCount(), 100u);
+        short_batches += batch->RowsCount() < 100 ? 1 : 0;
+        rows += batch->RowsCount();
+    }
+    EXPECT_EQ(rows, data_rows.size());
+    // Each chunk boundary leaves at most one short batch, and the end of the file another.
+    EXPECT_LE(short_batches, chunk_count);
+
+    BatchSizing by_bytes;
+    by_bytes.max_bytes = 1500;
+    for (const BatchSizing& sizing : {by_rows, by_bytes}) {
+        ParallelCsvBatchReader reader(data_in.Path(), schema, sizing,
+                                      CsvParallelOptions{.threads = 3, .chunk_bytes = 997});
+        EXPECT_EQ(ReadAllBatchRows(reader), data_rows);
+    }
+}
+
+TEST(batch, parallel_csv_reader_falls_back_after_stray_quotes) {
+    const Schema schema{{{"id", ColumnType::Int64}, {"note", ColumnType::String}}};
+    const TempFile data_in("batch_parallel_csv_stray");
+
+    // A quote inside an unquoted value is kept as is, which throws off the quote parity the split relies on.
+    std::string text;
+    for (int i = 0; i < 500; ++i) {
+        text += std::to_string(i) + (i == 100 ? ",ab\"c\n" : ",\"multi\nline\"\n");
+    }
+    WriteFileBytes(data_in.Path(), std::span(reinterpret_cast<const uint8_t*>(text.data()), text.size()));
+
+    CsvBatchReader sequential(data_in.Path(), schema, {});
+    const auto expected = ReadAllBatchRows(sequential);
+    ASSERT_EQ(expected.size(), 500u);
+
+    ParallelCsvBatchReader reader(data_in.Path(), schema, {}, CsvParallelOptions{.threads = 3, .chunk_bytes = 512});
+    EXPECT_EQ(ReadAllBatchRows(reader), expected);
+}
+
 TEST(batch, write_batch_csv_writes_single_batch) {
     Schema schema;
     schema.columns = {
@@ -103,6 +201,60 @@ TEST(batch, write_batch_csv_writes_single_batch) {
                                          }));
 }
 
+TEST(batch, csv_batch_writer_formats_columns_like_value_as_string) {
+    const Schema schema{{{"flag", ColumnType::Boolean},
+                         {"small", ColumnType::Int16},
+                         {"large", ColumnType::Int64},
+                         {"huge", ColumnType::Int128},
+                         {"day", ColumnType::Date},
+                         {"at", ColumnType::Timestamp},
+                         {"grade", ColumnType::Character},
+                         {"note", ColumnType::String},
+                         {"tag", ColumnType::String}}};
+
+    Batch batch(schema);
+    std::vector<std::string> notes;
+    for (int i = 0; i < 10000; ++i) {
+        std::string note = "note " + std::to_string(i);
+        if (i % 5 == 0) {
+            note = std::string(70 + i % 9, 'x') + (i % 2 == 0 ? "\"q\"" : ",\r\n");
+        }
+        const int64_t micros = (int64_t{i} - 5000) * 86'400'123'457;
+        const std::vector<std::string> row = {i % 2 == 0 ? "true" : "false",
+                                              std::to_string(i % 65536 - 32768),
+                                              std::to_string(int64_t{i} * -922337203685477),
+                                              i == 0 ? "-170141183460469231731687303715884105728" : std::to_string(i),
+                                              DateToString(i * 97 - 400000),
+                                              TimestampToString(micros),
+                                              std::string(1, i % 50 == 0 ? '"' : static_cast<char>('A' + i % 26)),
+                                              note,
+                                              i % 3 == 0 ? "a,b" : "c"};
+        for (size_t col = 0; col < row.size(); ++col) {
+            batch.AppendValueFromString(col, row[col]);
+        }
+    }
+
+    // Strings read back from a columnar file come as dictionary columns.
+    auto tags = std::make_unique<DictionaryStringColumn>();
+    tags->AppendRangeFromColumn(batch.ColumnAt(8), 0, batch.RowsCount());
+    batch.SetColumn(8, std::move(tags));
+
+    std::vector<std::vector<std::string>> expected;
+    AppendBatchRows(batch, expected);
+    AppendBatchRows(batch, expected);
+
+    const TempFile data_out("batch_write_csv_columns");
+    {
+        CsvBatchWriter writer(data_out.Path(), schema);
+        writer.Write(batch);
+        writer.Write(batch);
+        writer.Finalize();
+        // Finalizing again is harmless.
+        writer.Finalize();
+    }
+    EXPECT_EQ(ReadRows(data_out.Path()), expected);
+}
+
 TEST(batch, columnar_roundtrip) {
     Schema schema;
     schema.columns = {
@@ -243,6 +395,44 @@ TEST(batch, csv_reader_respects_max_bytes) {
     EXPECT_FALSE(reader.ReadNext().has_value());
 }
 
+TEST(batch, csv_reader_decodes_every_column_type_across_batches) {
+    const Schema schema{{{"flag", ColumnType::Boolean},
+                         {"small", ColumnType::Int16},
+                         {"medium", ColumnType::Int32},
+                         {"large", ColumnType::Int64},
+                         {"huge", ColumnType::Int128},
+                         {"day", ColumnType::Date},
+                         {"at", ColumnType::Timestamp},
+                         {"grade", ColumnType::Character},
+                         {"note", ColumnType::String}}};
+    const TempFile data_in("batch_csv_typed");
+
+    std::vector<std::vector<std::string>> data_rows;
+    for (int i = 0; i < 50; ++i) {
+        const std::string huge = "-170141183460469231731687303715884105" + std::to_string(i + 100);
+        const std::string at = "2024-02-29 12:34:" + std::to_string(10 + i);
+        const std::string note = i % 7 == 0 ? "" : "note,\"" + std::to_string(i);
+        data_rows.push_back({i % 2 == 0 ? "true" : "false", std::to_string(i - 25), std::to_string(i * 100000),
+                             std::to_string(int64_t{i} << 40), huge, "2024-02-" + std::to_string(10 + i % 19), at,
+                             std::string(1, static_cast<char>('A' + i % 26)), note});
+    }
+    WriteRows(data_in.Path(), data_rows);
+
+    BatchSizing sizing;
+    sizing.max_bytes = 400;
+    CsvBatchReader reader(data_in.Path(), schema, sizing);
+
+    std::vector<std::vector<std::string>> rows;
+    size_t batches = 0;
+    while (auto batch = reader.ReadNext()) {
+        batch->Validate();
+        AppendBatchRows(*batch, rows);
+        ++batches;
+    }
+    EXPECT_GT(batches, 5u);
+    EXPECT_EQ(rows, data_rows);
+}
+
 TEST(batch, csv_reader_throws_on_column_mismatch) {
     Schema schema;
     schema.columns = {
@@ -1,17 +1,24 @@
+#include <algorithm>
 #include <filesystem>
+#include <span>
 #include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "common/error.h"
 #include "common/parsing.h"
+#include "convert/compact.h"
 #include "convert/csv_columnar.h"
+#include "convert/pipeline.h"
 #include "gtest/gtest.h"
 #include "io/columnar_batch.h"
 #include "io/compression.h"
 #include "io/csv.h"
 #include "io/file.h"
+#include "io/metadata_cache.h"
 #include "io/stream.h"
+#include "model/column_dictionary_string.h"
 #include "model/metadata.h"
 #include "model/schema.h"
 #include "model/schema_csv.h"
@@ -74,7 +81,8 @@ TEST(columnar, metadata_offsets_and_sizes) {
     WriteRows(schema_in.Path(), schema_rows);
     WriteRows(data_in.Path(), data_rows);
 
-    ConvertCsvToColumnar(schema_in.Path(), data_in.Path(), columnar_file.Path(), 2);
+    ConvertCsvToColumnar(schema_in.Path(), data_in.Path(), columnar_file.Path(), 2,
+                         ColumnarWriteOptions{.lightweight_encoding = false});
 
     ColumnarBatchReader reader(columnar_file.Path());
     const auto& [schema, row_groups] = reader.GetMetadata();
@@ -202,6 +210,8 @@ TEST(columnar, infer_schema_from_csv_is_convert_compatible) {
                                                {"column_8", "timestamp"},
                                                {"column_9", "char"},
                                            }));
+    EXPECT_EQ(InferSchemaCsv(data_in.Path(), CsvParallelOptions{.threads = 2, .chunk_bytes = 64}),
+              ReadSchemaCsv(schema_out.Path()));
 
     ConvertCsvToColumnar(schema_out.Path(), data_in.Path(), columnar_file.Path(), 1);
     ConvertColumnarToCsv(columnar_file.Path(), schema_out.Path(), data_out.Path());
@@ -273,6 +283,476 @@ TEST(columnar, lz4_compressed_roundtrip) {
     EXPECT_LT(row_group.columns[1].compressed_size, row_group.columns[1].uncompressed_size);
 }
 
+TEST(columnar, zstd_and_lz4hc_compressed_roundtrip) {
+    const TempFile schema_in("schema_codecs_in");
+    const TempFile data_in("data_codecs_in");
+
+    WriteRows(schema_in.Path(), {{"id", "int64"}, {"payload", "string"}});
+
+    std::vector<std::vector<std::string>> data_rows;
+    for (int i = 0; i < 256; ++i) {
+        data_rows.push_back({std::to_string(i), "https://example.com/catalog/item?id=" + std::to_string(i % 7)});
+    }
+    WriteRows(data_in.Path(), data_rows);
+
+    for (const auto& [compression, level] :
+         std::vector<std::pair<Compression, int>>{{Compression::Zstd, DefaultCompressionLevel},
+                                                  {Compression::Zstd, 19},
+                                                  {Compression::Lz4Hc, DefaultCompressionLevel},
+                                                  {Compression::Lz4Hc, 12}}) {
+        const TempFile columnar_file("columnar_codecs");
+        const TempFile data_out("data_codecs_out");
+        const TempFile schema_out("schema_codecs_out");
+
+        ConvertCsvToColumnar(schema_in.Path(), data_in.Path(), columnar_file.Path(), 256, compression, level);
+        ConvertColumnarToCsv(columnar_file.Path(), schema_out.Path(), data_out.Path());
+
+        EXPECT_EQ(ReadRows(data_out.Path()), data_rows);
+
+        const ColumnarBatchReader reader(columnar_file.Path());
+        const auto& chunk = reader.GetMetadata().row_groups.at(0).columns.at(1);
+        EXPECT_EQ(chunk.compression, compression);
+        EXPECT_LT(chunk.compressed_size, chunk.uncompressed_size);
+    }
+
+    EXPECT_EQ(CompressionFromName("zstd"), Compression::Zstd);
+    EXPECT_EQ(CompressionFromName("lz4hc"), Compression::Lz4Hc);
+    EXPECT_THROW(ValidateCompressionLevel(Compression::Zstd, 1000), Error);
+    EXPECT_THROW(ValidateCompressionLevel(Compression::Lz4Hc, 64), Error);
+}
+
+TEST(columnar, adaptive_codec_selection_per_chunk) {
+    const TempFile schema_in("schema_adaptive_in");
+    const TempFile data_in("data_adaptive_in");
+
+    WriteRows(schema_in.Path(), {{"hash", "int64"}, {"url", "string"}});
+
+    std::vector<std::vector<std::string>> data_rows;
+    uint64_t state = 88172645463325252ull;
+    for (int i = 0; i < 1024; ++i) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        data_rows.push_back({std::to_string(static_cast<int64_t>(state)),
+                             "https://example.com/catalog/item?id=" + std::to_string(i % 5)});
+    }
+    WriteRows(data_in.Path(), data_rows);
+
+    const auto convert = [&](const CodecObjective objective, const CodecSelectionScope scope) {
+        const TempFile columnar_file("columnar_adaptive");
+        const TempFile data_out("data_adaptive_out");
+        const TempFile schema_out("schema_adaptive_out");
+
+        ColumnarWriteOptions options;
+        options.adaptive_codec = CodecSelection{.objective = objective, .scope = scope};
+        options.lightweight_encoding = false;
+        ConvertCsvToColumnar(schema_in.Path(), data_in.Path(), columnar_file.Path(), 256, options);
+        ConvertColumnarToCsv(columnar_file.Path(), schema_out.Path(), data_out.Path());
+        EXPECT_EQ(ReadRows(data_out.Path()), data_rows);
+
+        return ColumnarBatchReader(columnar_file.Path()).GetMetadata();
+    };
+
+    const ColumnarMetadata smallest = convert(CodecObjective::SmallestSize, CodecSelectionScope::RowGroup);
+    ASSERT_EQ(smallest.row_groups.size(), 4u);
+    for (const auto& group : smallest.row_groups) {
+        EXPECT_EQ(group.columns[0].compression, Compression::None);
+        EXPECT_NE(group.columns[1].compression, Compression::None);
+        EXPECT_LT(group.columns[1].compressed_size, group.columns[1].uncompressed_size);
+    }
+
+    // Uncompressed chunks are read in place, which no codec decodes faster.
+    const ColumnarMetadata fastest = convert(CodecObjective::FastestDecode, CodecSelectionScope::File);
+    for (const auto& group : fastest.row_groups) {
+        EXPECT_EQ(group.columns[1].compression, Compression::None);
+    }
+
+    EXPECT_EQ(CodecObjectiveFromName("balanced"), CodecObjective::Balanced);
+    EXPECT_THROW(CodecObjectiveFromName("fastest"), Error);
+}
+
+TEST(columnar, low_cardinality_strings_are_dictionary_encoded) {
+    const TempFile schema_in("schema_dictionary_in");
+    const TempFile data_in("data_dictionary_in");
+
+    WriteRows(schema_in.Path(), {{"phone", "string"}, {"title", "string"}});
+
+    const std::vector<std::string> phones = {"iPhone", "Galaxy S9", "Pixel", ""};
+    std::vector<std::vector<std::string>> data_rows;
+    for (int i = 0; i < 600; ++i) {
+        data_rows.push_back({phones[i % phones.size()], "title number " + std::to_string(i)});
+    }
+    WriteRows(data_in.Path(), data_rows);
+
+    for (const Compression compression : {Compression::None, Compression::Zstd}) {
+        const TempFile columnar_file("columnar_dictionary");
+        const TempFile data_out("data_dictionary_out");
+        const TempFile schema_out("schema_dictionary_out");
+
+        ConvertCsvToColumnar(schema_in.Path(), data_in.Path(), columnar_file.Path(), 256,
+                             ColumnarWriteOptions{.compression = compression});
+        ConvertColumnarToCsv(columnar_file.Path(), schema_out.Path(), data_out.Path());
+        EXPECT_EQ(ReadRows(data_out.Path()), data_rows);
+
+        ColumnarBatchReader reader(columnar_file.Path());
+        ASSERT_EQ(reader.GetMetadata().row_groups.size(), 3u);
+        for (const auto& group : reader.GetMetadata().row_groups) {
+            EXPECT_EQ(group.columns[0].encoding, ChunkEncoding::Dictionary);
+            EXPECT_EQ(group.columns[1].encoding, ChunkEncoding::Plain);
+        }
+
+        const auto batch = reader.ReadNext();
+        ASSERT_TRUE(batch.has_value());
+        const auto* phone = dynamic_cast<const DictionaryStringColumn*>(&batch->ColumnAt(0));
+        ASSERT_NE(phone, nullptr);
+        EXPECT_EQ(phone->GetDictionary()->size(), phones.size());
+        EXPECT_EQ(phone->ValueAsString(5), "Galaxy S9");
+    }
+
+    const TempFile plain_file("columnar_dictionary_plain");
+    ColumnarWriteOptions plain;
+    plain.lightweight_encoding = false;
+    ConvertCsvToColumnar(schema_in.Path(), data_in.Path(), plain_file.Path(), 256, plain);
+    EXPECT_EQ(ColumnarBatchReader(plain_file.Path()).GetMetadata().row_groups[0].columns[0].encoding,
+              ChunkEncoding::Plain);
+}
+
+TEST(columnar, small_integer_domains_are_bit_packed_or_run_length_encoded) {
+    const TempFile schema_in("schema_integer_encoding_in");
+    const TempFile data_in("data_integer_encoding_in");
+    const TempFile columnar_file("columnar_integer_encoding");
+    const TempFile data_out("data_integer_encoding_out");
+    const TempFile schema_out("schema_integer_encoding_out");
+
+    WriteRows(schema_in.Path(), {{"is_refresh", "int16"}, {"engine", "int32"}, {"id", "int64"}});
+
+    std::vector<std::vector<std::string>> data_rows;
+    for (int i = 0; i < 512; ++i) {
+        data_rows.push_back({i / 100 % 2 == 0 ? "0" : "1", std::to_string(1000 + (i * 7) % 13),
+                             std::to_string(static_cast<int64_t>(i) * 1'000'000'007)});
+    }
+    WriteRows(data_in.Path(), data_rows);
+
+    ConvertCsvToColumnar(schema_in.Path(), data_in.Path(), columnar_file.Path(), 512, Compression::None);
+    ConvertColumnarToCsv(columnar_file.Path(), schema_out.Path(), data_out.Path());
+    EXPECT_EQ(ReadRows(data_out.Path()), data_rows);
+
+    ColumnarBatchReader reader(columnar_file.Path());
+    const auto& chunks = reader.GetMetadata().row_groups.at(0).columns;
+    EXPECT_EQ(chunks[0].encoding, ChunkEncoding::RunLength);
+    EXPECT_EQ(chunks[1].encoding, ChunkEncoding::BitPacked);
+    EXPECT_LT(chunks[1].uncompressed_size, 512u * sizeof(int32_t) / 4);
+    EXPECT_EQ(chunks[2].encoding, ChunkEncoding::BitPacked);
+
+    const auto batch = reader.ReadNext();
+    ASSERT_TRUE(batch.has_value());
+    std::vector<size_t> rows;
+    batch->ColumnAt(0).SelectRowsByInt128Comparison(1, ValueComparison::Equal, rows);
+    ASSERT_EQ(rows.size(), 212u);
+    EXPECT_EQ(rows.front(), 100u);
+    EXPECT_EQ(rows[100], 300u);
+    EXPECT_EQ(rows.back(), 511u);
+}
+
+TEST(columnar, near_monotonic_timestamps_are_delta_encoded) {
+    const TempFile schema_in("schema_delta_in");
+    const TempFile data_in("data_delta_in");
+    const TempFile columnar_file("columnar_delta");
+    const TempFile data_out("data_delta_out");
+    const TempFile schema_out("schema_delta_out");
+
+    WriteRows(schema_in.Path(), {{"event_time", "timestamp"}, {"accelerating", "timestamp"}, {"event_date", "date"}});
+
+    const int64_t base = ParseTimestamp("2013-07-01 00:00:00");
+    const int64_t second = ParseTimestamp("2013-07-01 00:00:01") - base;
+    std::vector<std::vector<std::string>> data_rows;
+    for (int64_t i = 0; i < 300; ++i) {
+        data_rows.push_back({TimestampToString(base + (i * 1000 + i % 3) * second),
+                             TimestampToString(base + i * i * second),
+                             DateToString(static_cast<int32_t>(15887 + i / 50))});
+    }
+    WriteRows(data_in.Path(), data_rows);
+
+    ConvertCsvToColumnar(schema_in.Path(), data_in.Path(), columnar_file.Path(), 300, Compression::None);
+    ConvertColumnarToCsv(columnar_file.Path(), schema_out.Path(), data_out.Path());
+    EXPECT_EQ(ReadRows(data_out.Path()), data_rows);
+
+    const ColumnarBatchReader reader(columnar_file.Path());
+    const auto& chunks = reader.GetMetadata().row_groups.at(0).columns;
+    EXPECT_EQ(chunks[0].encoding, ChunkEncoding::Delta);
+    EXPECT_LT(chunks[0].uncompressed_size, 300u * sizeof(int64_t) / 2);
+    EXPECT_EQ(chunks[1].encoding, ChunkEncoding::DeltaOfDelta);
+    EXPECT_EQ(chunks[2].encoding, ChunkEncoding::RunLength);
+}
+
+TEST(columnar, page_zone_maps_cover_each_page_of_a_chunk) {
+    const TempFile schema_in("schema_page_zone_in");
+    const TempFile data_in("data_page_zone_in");
+    const TempFile columnar_file("columnar_page_zone");
+
+    WriteRows(schema_in.Path(), {{"counter", "int32"}, {"url", "string"}});
+
+    std::vector<std::vector<std::string>> data_rows;
+    for (int i = 0; i < 10; ++i) {
+        data_rows.push_back({std::to_string(i * 10 + (i % 4 == 1 ? 5 : 0)), "u" + std::to_string(i)});
+    }
+    WriteRows(data_in.Path(), data_rows);
+
+    ConvertCsvToColumnar(schema_in.Path(), data_in.Path(), columnar_file.Path(), 10,
+                         ColumnarWriteOptions{.page_rows = 4});
+
+    const ColumnarBatchReader reader(columnar_file.Path());
+    const auto& chunks = reader.GetMetadata().row_groups.at(0).columns;
+    EXPECT_EQ(chunks[0].page_rows, 4u);
+    ASSERT_EQ(chunks[0].pages.size(), 3u);
+    EXPECT_EQ(chunks[0].pages[0].min_value, 0);
+    EXPECT_EQ(chunks[0].pages[0].max_value, 30);
+    EXPECT_EQ(chunks[0].pages[1].min_value, 40);
+    EXPECT_EQ(chunks[0].pages[1].max_value, 70);
+    EXPECT_EQ(chunks[0].pages[2].min_value, 80);
+    EXPECT_EQ(chunks[0].pages[2].max_value, 95);
+    EXPECT_TRUE(chunks[1].pages.empty());
+
+    const TempFile unpaged_file("columnar_page_zone_unpaged");
+    ConvertCsvToColumnar(schema_in.Path(), data_in.Path(), unpaged_file.Path(), 10,
+                         ColumnarWriteOptions{.page_rows = 0});
+    EXPECT_TRUE(ColumnarBatchReader(unpaged_file.Path()).GetMetadata().row_groups.at(0).columns[0].pages.empty());
+}
+
+TEST(columnar, string_chunks_record_truncated_bounds_and_empty_counts) {
+    const TempFile schema_in("schema_string_stats_in");
+    const TempFile data_in("data_string_stats_in");
+    const TempFile columnar_file("columnar_string_stats");
+
+    WriteRows(schema_in.Path(), {{"url", "string"}});
+
+    const std::string long_min = "http://" + std::string(100, 'a');
+    const std::string long_max = "http://" + std::string(100, 'z');
+    WriteRows(data_in.Path(), {{long_max}, {""}, {long_min}, {""}, {"http://m"}});
+
+    ConvertCsvToColumnar(schema_in.Path(), data_in.Path(), columnar_file.Path(), 5);
+
+    const ColumnarBatchReader reader(columnar_file.Path());
+    const auto& chunk = reader.GetMetadata().row_groups.at(0).columns.at(0);
+    ASSERT_TRUE(chunk.has_string_stats);
+    EXPECT_FALSE(chunk.has_min_max);
+    EXPECT_EQ(chunk.empty_count, 2u);
+    EXPECT_EQ(chunk.max_length, long_max.size());
+    EXPECT_EQ(chunk.string_min, "");
+    EXPECT_LT(chunk.string_max.size(), long_max.size());
+    EXPECT_GT(chunk.string_max, long_max);
+    EXPECT_TRUE(long_max.starts_with(chunk.string_max.substr(0, chunk.string_max.size() - 1)));
+}
+
+TEST(columnar, distinct_sketches_round_trip_and_estimate_cardinality) {
+    const TempFile schema_in("schema_distinct_sketch_in");
+    const TempFile data_in("data_distinct_sketch_in");
+    const TempFile columnar_file("columnar_distinct_sketch");
+
+    WriteRows(schema_in.Path(), {{"user", "int64"}, {"region", "string"}});
+
+    std::vector<std::vector<std::string>> data_rows;
+    for (int i = 0; i < 40000; ++i) {
+        data_rows.push_back({std::to_string(i % 20000), "r" + std::to_string(i % 7)});
+    }
+    WriteRows(data_in.Path(), data_rows);
+
+    ConvertCsvToColumnar(schema_in.Path(), data_in.Path(), columnar_file.Path(), 40000,
+                         ColumnarWriteOptions{.distinct_sketch_columns = {"user", "region"}});
+
+    const ColumnarBatchReader reader(columnar_file.Path());
+    const auto& chunks = reader.GetMetadata().row_groups.at(0).columns;
+    ASSERT_TRUE(chunks[0].distinct_sketch.has_value());
+    ASSERT_TRUE(chunks[1].distinct_sketch.has_value());
+    EXPECT_NEAR(static_cast<double>(chunks[0].distinct_sketch->Estimate()), 20000.0, 20000.0 * 0.02);
+    EXPECT_EQ(chunks[1].distinct_sketch->Estimate(), 7u);
+
+    EXPECT_THROW(ConvertCsvToColumnar(schema_in.Path(), data_in.Path(), columnar_file.Path(), 40000,
+                                      ColumnarWriteOptions{.distinct_sketch_columns = {"missing"}}),
+                 Error);
+}
+
+TEST(columnar, sparse_and_dense_distinct_sketches_agree) {
+    const auto hash = [](uint64_t value) {
+        value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+        value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+        return value ^ (value >> 31);
+    };
+    const auto serialize = [](const HyperLogLog& sketch) {
+        std::vector<uint8_t> bytes;
+        sketch.Serialize(bytes);
+        return bytes;
+    };
+
+    for (const uint64_t values : {0, 50, 3000, 40000}) {
+        HyperLogLog whole;
+        std::vector<HyperLogLog> parts(8);
+        for (uint64_t i = 0; i < values; ++i) {
+            whole.Insert(hash(i));
+            parts[i % parts.size()].Insert(hash(i));
+        }
+
+        HyperLogLog merged;
+        for (const auto& part : parts) {
+            merged.Merge(part);
+        }
+
+        const std::vector<uint8_t> bytes = serialize(whole);
+        EXPECT_EQ(serialize(merged), bytes) << values;
+        EXPECT_EQ(merged.Estimate(), whole.Estimate()) << values;
+        EXPECT_EQ(serialize(HyperLogLog::Deserialize(bytes)), bytes) << values;
+        EXPECT_NEAR(static_cast<double>(whole.Estimate()), static_cast<double>(values), values * 0.03) << values;
+    }
+}
+
+TEST(columnar, parallel_column_encoding_writes_the_same_file_as_serial) {
+    const TempFile schema_in("schema_parallel_encoding_in");
+    const TempFile data_in("data_parallel_encoding_in");
+    const TempFile serial_file("columnar_serial_encoding");
+    const TempFile parallel_file("columnar_parallel_encoding");
+
+    WriteRows(schema_in.Path(), {{"id", "int64"}, {"region", "string"}, {"amount", "int64"}, {"note", "string"}});
+
+    std::vector<std::vector<std::string>> data_rows;
+    for (int i = 0; i < 20000; ++i) {
+        data_rows.push_back({std::to_string(i), "r" + std::to_string(i % 5), std::to_string(i % 300 * 7),
+                             "note " + std::to_string(i * 31 % 977)});
+    }
+    WriteRows(data_in.Path(), data_rows);
+
+    ColumnarWriteOptions options{.compression = Compression::Zstd,
+                                 .bloom_filter_columns = {"id"},
+                                 .distinct_sketch_columns = {"region", "note"}};
+    const PipelineOptions one_encoder{.encode_workers = 1};
+    options.encode_threads = 1;
+    ConvertCsvToColumnar(schema_in.Path(), data_in.Path(), serial_file.Path(), 3000, options, {}, one_encoder);
+    options.encode_threads = 4;
+    ConvertCsvToColumnar(schema_in.Path(), data_in.Path(), parallel_file.Path(), 3000, options, {}, one_encoder);
+
+    EXPECT_EQ(ReadFileBytes(parallel_file.Path()), ReadFileBytes(serial_file.Path()));
+    EXPECT_EQ(ColumnarBatchReader(parallel_file.Path()).GetMetadata().row_groups.size(), 7u);
+}
+
+TEST(columnar, pipelined_conversion_writes_row_groups_in_input_order) {
+    const TempFile schema_in("schema_pipeline_in");
+    const TempFile data_in("data_pipeline_in");
+    const TempFile serial_file("columnar_pipeline_serial");
+    const TempFile pipelined_file("columnar_pipeline");
+
+    WriteRows(schema_in.Path(), {{"id", "int64"}, {"name", "string"}});
+
+    std::vector<std::vector<std::string>> data_rows;
+    for (int i = 0; i < 5000; ++i) {
+        data_rows.push_back({std::to_string(i), "name " + std::to_string(i * 17 % 1009)});
+    }
+    WriteRows(data_in.Path(), data_rows);
+
+    const ColumnarWriteOptions options{.compression = Compression::Lz4};
+    ConvertCsvToColumnar(schema_in.Path(), data_in.Path(), serial_file.Path(), 97, options, {},
+                         PipelineOptions{.encode_workers = 1, .queue_batches = 1});
+    ConvertCsvToColumnar(schema_in.Path(), data_in.Path(), pipelined_file.Path(), 97, options, {},
+                         PipelineOptions{.encode_workers = 4, .queue_batches = 2});
+
+    EXPECT_EQ(ReadFileBytes(pipelined_file.Path()), ReadFileBytes(serial_file.Path()));
+    EXPECT_EQ(ColumnarBatchReader(pipelined_file.Path()).GetMetadata().row_groups.size(), 52u);
+
+    // A batch that does not match the writer's schema fails in the encode stage and surfaces on the caller.
+    ColumnarBatchWriter writer(pipelined_file.Path(), Schema{{ColumnSchema("id", ColumnType::Int64)}}, options);
+    ConvertPipeline pipeline(writer, PipelineOptions{.encode_workers = 2, .queue_batches = 1});
+    const Batch mismatched(Schema{{ColumnSchema("id", ColumnType::Int64), ColumnSchema("x", ColumnType::Int64)}}, 0);
+    EXPECT_THROW(
+        {
+            for (int i = 0; i < 100; ++i) {
+                pipeline.Write(mismatched);
+            }
+            pipeline.Flush();
+        },
+        Error);
+}
+
+TEST(columnar, metadata_cache_reuses_footer_until_file_changes) {
+    const TempFile schema_in("schema_metadata_cache_in");
+    const TempFile data_in("data_metadata_cache_in");
+    const TempFile columnar_file("columnar_metadata_cache");
+
+    WriteRows(schema_in.Path(), {{"value", "int64"}});
+    WriteRows(data_in.Path(), {{"1"}, {"2"}, {"3"}});
+    ConvertCsvToColumnar(schema_in.Path(), data_in.Path(), columnar_file.Path(), 1);
+
+    MetadataCache& cache = MetadataCache::Instance();
+    const auto first = cache.Get(columnar_file.Path());
+    EXPECT_EQ(first->RowGroupCount(), 3u);
+    EXPECT_EQ(cache.Get(columnar_file.Path()), first);
+
+    WriteRows(data_in.Path(), {{"1"}, {"2"}, {"3"}, {"4"}});
+    ConvertCsvToColumnar(schema_in.Path(), data_in.Path(), columnar_file.Path(), 1);
+
+    const auto second = cache.Get(columnar_file.Path());
+    EXPECT_NE(second, first);
+    EXPECT_EQ(second->RowGroupCount(), 4u);
+    // The old footer was copied out of the file, so it outlives the rewrite.
+    EXPECT_EQ(first->RowGroupCount(), 3u);
+
+    EXPECT_THROW(cache.Get(columnar_file.Path().string() + ".missing"), Error);
+
+    // Least recently used footers go once the capacity is exceeded; views already handed out stay usable.
+    const TempFile other_file("columnar_metadata_cache_other");
+    ConvertCsvToColumnar(schema_in.Path(), data_in.Path(), other_file.Path(), 2);
+
+    MetadataCache small(1);
+    const auto evicted = small.Get(columnar_file.Path());
+    const auto kept = small.Get(other_file.Path());
+    EXPECT_EQ(small.Size(), 1u);
+    EXPECT_EQ(small.Get(other_file.Path()), kept);
+    EXPECT_NE(small.Get(columnar_file.Path()), evicted);
+    EXPECT_EQ(evicted->RowGroupCount(), 4u);
+    EXPECT_EQ(kept->RowGroupCount(), 2u);
+}
+
+TEST(columnar, sort_by_clusters_rows_through_spilled_runs) {
+    const TempFile schema_in("schema_sorted_in");
+    const TempFile data_in("data_sorted_in");
+    const TempFile columnar_file("columnar_sorted");
+    const TempFile schema_out("schema_sorted_out");
+    const TempFile data_out("data_sorted_out");
+
+    WriteRows(schema_in.Path(), {{"counter", "int32"}, {"region", "string"}, {"seq", "int64"}});
+
+    std::vector<std::vector<std::string>> data_rows;
+    for (int i = 0; i < 100; ++i) {
+        data_rows.push_back({std::to_string(i * 7 % 5), "r" + std::to_string(i * 3 % 4), std::to_string(i)});
+    }
+    WriteRows(data_in.Path(), data_rows);
+
+    ConvertCsvToColumnar(schema_in.Path(), data_in.Path(), columnar_file.Path(), 20, ColumnarWriteOptions{},
+                         SortOptions{.columns = {"counter", "region"}, .run_rows = 16});
+
+    const auto file_name = columnar_file.Path().filename().string();
+    for (const auto& entry : std::filesystem::directory_iterator(columnar_file.Path().parent_path())) {
+        const auto name = entry.path().filename().string();
+        EXPECT_FALSE(name.starts_with(file_name) && name != file_name) << "spill run left behind: " << name;
+    }
+
+    const ColumnarBatchReader reader(columnar_file.Path());
+    const auto& row_groups = reader.GetMetadata().row_groups;
+    ASSERT_EQ(row_groups.size(), 5u);
+    for (size_t i = 0; i + 1 < row_groups.size(); ++i) {
+        EXPECT_LE(row_groups[i].columns[0].max_value, row_groups[i + 1].columns[0].min_value);
+    }
+
+    std::vector<std::vector<std::string>> expected = data_rows;
+    std::ranges::stable_sort(expected, [](const auto& lhs, const auto& rhs) {
+        return std::pair(std::stoi(lhs[0]), lhs[1]) < std::pair(std::stoi(rhs[0]), rhs[1]);
+    });
+
+    ConvertColumnarToCsv(columnar_file.Path(), schema_out.Path(), data_out.Path());
+    EXPECT_EQ(ReadRows(data_out.Path()), expected);
+
+    EXPECT_THROW(ConvertCsvToColumnar(schema_in.Path(), data_in.Path(), columnar_file.Path(), 20,
+                                      ColumnarWriteOptions{}, SortOptions{.columns = {"missing"}}),
+                 Error);
+}
+
 TEST(columnar, lz4_falls_back_to_none_when_chunk_does_not_shrink) {
     const TempFile schema_in("schema_lz4_fallback_in");
     const TempFile data_in("data_lz4_fallback_in");
@@ -320,3 +800,288 @@ TEST(columnar, read_legacy_metadata_without_compression_fields) {
     EXPECT_EQ(chunk.min_value, 7);
     EXPECT_EQ(chunk.max_value, 9);
 }
+
+TEST(columnar, flat_metadata_view_decodes_only_requested_chunks) {
+    ColumnarMetadata metadata;
+    metadata.schema.columns = {ColumnSchema{"id", ColumnType::Int64}, ColumnSchema{"url", ColumnType::String}};
+
+    for (uint32_t group = 0; group < 2; ++group) {
+        ColumnChunkMetadata id;
+        id.offset = group * 100;
+        id.compressed_size = 40;
+        id.uncompressed_size = 80;
+        id.compression = Compression::Zstd;
+        id.encoding = ChunkEncoding::Delta;
+        id.has_min_max = true;
+        id.min_value = group;
+        id.max_value = group + 10;
+        id.page_rows = 2;
+        id.pages = {{group, group + 1}, {group + 2, group + 10}};
+        id.bloom_filter = BloomFilter::ForDistinctCount(4);
+        id.bloom_filter.Insert(group + 1000);
+
+        ColumnChunkMetadata url;
+        url.offset = group * 100 + 40;
+        url.compressed_size = 60;
+        url.uncompressed_size = 60;
+        url.has_string_stats = true;
+        url.string_min = "a" + std::to_string(group);
+        url.string_max = "z";
+        url.empty_count = 1;
+        url.max_length = 7;
+        url.distinct_sketch = HyperLogLog();
+        url.distinct_sketch->Insert(group + 1);
+
+        metadata.row_groups.push_back(RowGroupMetadata{4, {id, url}});
+    }
+
+    std::ostringstream out(std::ios::binary);
+    WriteMetadata(out, metadata);
+    const std::string bytes = out.str();
+    const std::span<const uint8_t> blob(reinterpret_cast<const uint8_t*>(bytes.data()), bytes.size());
+
+    ASSERT_TRUE(MetadataView::IsFlat(blob));
+    const MetadataView view(blob);
+    EXPECT_EQ(view.GetSchema().columns.size(), 2u);
+    EXPECT_EQ(view.RowGroupCount(), 2u);
+    EXPECT_EQ(view.RowCount(1), 4u);
+
+    const ColumnChunkMetadata id = view.Chunk(1, 0);
+    EXPECT_EQ(id.offset, 100u);
+    EXPECT_EQ(id.compression, Compression::Zstd);
+    EXPECT_EQ(id.encoding, ChunkEncoding::Delta);
+    EXPECT_EQ(id.max_value, 11);
+    ASSERT_EQ(id.pages.size(), 2u);
+    EXPECT_EQ(id.pages[1].max_value, 11);
+    EXPECT_TRUE(id.bloom_filter.MayContain(1001));
+    EXPECT_FALSE(view.HasDistinctSketch(1, 0));
+    EXPECT_TRUE(view.HasDistinctSketch(1, 1));
+    EXPECT_EQ(view.DistinctSketch(1, 1)->Estimate(), 1u);
+
+    RowGroupMetadata row_group;
+    view.DecodeRowGroup(0, std::vector<size_t>{1}, row_group);
+    ASSERT_EQ(row_group.columns.size(), 2u);
+    EXPECT_FALSE(row_group.columns[0].has_min_max);
+    EXPECT_EQ(row_group.columns[1].string_min, "a0");
+    EXPECT_EQ(row_group.columns[1].empty_count, 1u);
+    EXPECT_FALSE(row_group.columns[1].distinct_sketch.has_value());
+
+    std::istringstream in(bytes, std::ios::binary);
+    const ColumnarMetadata decoded = ReadMetadata(in);
+    ASSERT_EQ(decoded.row_groups.size(), 2u);
+    EXPECT_EQ(decoded.row_groups[0].columns[1].string_max, "z");
+    EXPECT_TRUE(decoded.row_groups[0].columns[1].distinct_sketch.has_value());
+
+    EXPECT_THROW(MetadataView(blob.first(blob.size() - 1)), Error);
+    EXPECT_THROW(view.Chunk(2, 0), Error);
+}
+
+TEST(columnar, read_sectioned_metadata_written_before_flat_layout) {
+    std::ostringstream out(std::ios::binary);
+
+    WriteBytes(out, "CMD2");
+    WriteStream<uint32_t>(out, 3);
+    WriteStream<uint32_t>(out, 1);
+    WriteStream<uint32_t>(out, 2);
+    WriteBytes(out, "id");
+    WriteStream<uint8_t>(out, static_cast<uint8_t>(ColumnType::Int64));
+    WriteStream<uint32_t>(out, 1);
+    WriteStream<uint32_t>(out, 5);
+    WriteStream<uint32_t>(out, 1);
+    WriteStream<uint64_t>(out, 0);
+    WriteStream<uint64_t>(out, 12);
+    WriteStream<uint64_t>(out, 40);
+    WriteStream<uint8_t>(out, static_cast<uint8_t>(Compression::Lz4));
+    WriteStream<uint8_t>(out, 1);
+    WriteStream<Int128>(out, 3);
+    WriteStream<Int128>(out, 8);
+    WriteStream<uint32_t>(out, 2);
+    WriteStream<uint32_t>(out, 1);
+    WriteStream<uint64_t>(out, 1);
+    WriteStream<uint8_t>(out, static_cast<uint8_t>(ChunkEncoding::BitPacked));
+    WriteStream<uint32_t>(out, 99);
+    WriteStream<uint64_t>(out, 3);
+    WriteBytes(out, "xyz");
+
+    std::istringstream in(out.str(), std::ios::binary);
+    const ColumnarMetadata metadata = ReadMetadata(in);
+
+    ASSERT_EQ(metadata.row_groups.size(), 1u);
+    const auto& chunk = metadata.row_groups[0].columns.at(0);
+    EXPECT_EQ(metadata.row_groups[0].row_count, 5u);
+    EXPECT_EQ(chunk.compression, Compression::Lz4);
+    EXPECT_EQ(chunk.encoding, ChunkEncoding::BitPacked);
+    EXPECT_EQ(chunk.min_value, 3);
+    EXPECT_EQ(chunk.max_value, 8);
+}
+
+TEST(columnar, append_adds_row_groups_and_readers_stop_at_the_committed_footer) {
+    const TempFile schema_in("schema_append_in");
+    const TempFile data_in("data_append_in");
+    const TempFile more_in("more_append_in");
+    const TempFile columnar_file("columnar_append");
+    const TempFile schema_out("schema_append_out");
+    const TempFile data_out("data_append_out");
+
+    const std::vector<std::vector<std::string>> first_rows = {{"1", "a"}, {"2", "bb"}, {"3", "ccc"}};
+    const std::vector<std::vector<std::string>> more_rows = {{"4", "dddd"}, {"5", ""}};
+
+    WriteRows(schema_in.Path(), {{"id", "int64"}, {"name", "string"}});
+    WriteRows(data_in.Path(), first_rows);
+    WriteRows(more_in.Path(), more_rows);
+
+    const ColumnarWriteOptions append{.compression = Compression::Lz4, .open_mode = FileOpenMode::Append};
+
+    // A missing file is created, then the second convert only adds row groups and a footer.
+    ConvertCsvToColumnar(schema_in.Path(), data_in.Path(), columnar_file.Path(), 2, append);
+    const ColumnarMetadata before = ColumnarBatchReader(columnar_file.Path()).GetMetadata();
+    const uint64_t before_size = std::filesystem::file_size(columnar_file.Path());
+    ConvertCsvToColumnar(schema_in.Path(), more_in.Path(), columnar_file.Path(), 2, append);
+
+    std::filesystem::path journal = columnar_file.Path();
+    journal += ".append";
+    EXPECT_FALSE(std::filesystem::exists(journal));
+
+    const ColumnarMetadata after = ColumnarBatchReader(columnar_file.Path()).GetMetadata();
+    ASSERT_EQ(after.row_groups.size(), 3u);
+    EXPECT_EQ(after.row_groups[0].columns[0].offset, before.row_groups[0].columns[0].offset);
+    EXPECT_EQ(after.row_groups[1].columns[1].offset, before.row_groups[1].columns[1].offset);
+    // The new chunks follow the old footer, which is left in place.
+    EXPECT_EQ(after.row_groups[2].columns[0].offset, before_size);
+
+    std::vector<std::vector<std::string>> expected = first_rows;
+    expected.insert(expected.end(), more_rows.begin(), more_rows.end());
+    ConvertColumnarToCsv(columnar_file.Path(), schema_out.Path(), data_out.Path());
+    EXPECT_EQ(ReadRows(data_out.Path()), expected);
+
+    const std::vector<uint8_t> committed = ReadFileBytes(columnar_file.Path());
+    const std::optional<Batch> batch = ColumnarBatchReader(columnar_file.Path()).ReadNext();
+    ASSERT_TRUE(batch.has_value());
+
+    const TempFile crashed_file("columnar_append_crashed");
+    std::filesystem::path crashed_journal = crashed_file.Path();
+    crashed_journal += ".append";
+    {
+        ColumnarBatchWriter writer(columnar_file.Path(), batch->GetSchema(), append);
+        writer.Write(*batch);
+        writer.Flush();
+
+        // Readers see the file as it was before the append, and a running append is not mistaken for an interrupted
+        // one.
+        EXPECT_TRUE(std::filesystem::exists(journal));
+        EXPECT_EQ(ColumnarBatchReader(columnar_file.Path()).GetMetadata().row_groups.size(), 3u);
+        EXPECT_FALSE(RollBackInterruptedAppend(columnar_file.Path()));
+        EXPECT_TRUE(std::filesystem::exists(journal));
+
+        // What a crash between the new chunks and the new footer leaves on disk.
+        std::filesystem::copy_file(columnar_file.Path(), crashed_file.Path());
+        std::filesystem::copy_file(journal, crashed_journal);
+
+        // Dropped without Finalize, which rolls the append back.
+    }
+    EXPECT_FALSE(std::filesystem::exists(journal));
+    EXPECT_EQ(ReadFileBytes(columnar_file.Path()), committed);
+
+    // Reading the crashed file leaves it alone and stops at the committed footer; the next append repairs it.
+    const std::vector<uint8_t> crashed = ReadFileBytes(crashed_file.Path());
+    ConvertColumnarToCsv(crashed_file.Path(), schema_out.Path(), data_out.Path());
+    EXPECT_EQ(ReadRows(data_out.Path()), expected);
+    EXPECT_TRUE(std::filesystem::exists(crashed_journal));
+    EXPECT_EQ(ReadFileBytes(crashed_file.Path()), crashed);
+
+    EXPECT_TRUE(RollBackInterruptedAppend(crashed_file.Path()));
+    EXPECT_FALSE(std::filesystem::exists(crashed_journal));
+    EXPECT_EQ(ReadFileBytes(crashed_file.Path()), committed);
+
+    EXPECT_THROW(ColumnarBatchWriter(columnar_file.Path(), Schema{{ColumnSchema("id", ColumnType::Int64)}}, append),
+                 Error);
+    EXPECT_EQ(ReadFileBytes(columnar_file.Path()), committed);
+
+    // A crash after the new footer was synced but before the journal was removed keeps the append.
+    std::filesystem::path saved_journal = journal;
+    saved_journal += ".saved";
+    {
+        ColumnarBatchWriter writer(columnar_file.Path(), batch->GetSchema(), append);
+        writer.Write(*batch);
+        std::filesystem::copy_file(journal, saved_journal);
+        writer.Finalize();
+    }
+    const std::vector<uint8_t> appended = ReadFileBytes(columnar_file.Path());
+    std::filesystem::rename(saved_journal, journal);
+    EXPECT_EQ(ColumnarBatchReader(columnar_file.Path()).GetMetadata().row_groups.size(), 3u);
+
+    EXPECT_TRUE(RollBackInterruptedAppend(columnar_file.Path()));
+    EXPECT_FALSE(std::filesystem::exists(journal));
+    EXPECT_EQ(ReadFileBytes(columnar_file.Path()), appended);
+    EXPECT_EQ(ColumnarBatchReader(columnar_file.Path()).GetMetadata().row_groups.size(), 4u);
+}
+
+TEST(columnar, compact_coalesces_row_groups_and_keeps_statistics) {
+    const TempFile schema_in("schema_compact_in");
+    const TempFile data_in("data_compact_in");
+    const TempFile columnar_file("columnar_compact");
+    const TempFile sorted_file("columnar_compact_sorted");
+    const TempFile schema_out("schema_compact_out");
+    const TempFile data_out("data_compact_out");
+
+    WriteRows(schema_in.Path(), {{"id", "int64"}, {"region", "string"}});
+
+    std::vector<std::vector<std::string>> data_rows;
+    for (int i = 0; i < 50; ++i) {
+        data_rows.push_back({std::to_string(i * 37 % 50), "r" + std::to_string(i % 4)});
+    }
+    WriteRows(data_in.Path(), data_rows);
+
+    ConvertCsvToColumnar(schema_in.Path(), data_in.Path(), columnar_file.Path(), 3,
+                         ColumnarWriteOptions{.bloom_filter_columns = {"id"}});
+
+    CompactColumnarFile(columnar_file.Path(), columnar_file.Path(),
+                        CompactOptions{.target_rows = 20,
+                                       .write_options = ColumnarWriteOptions{.compression = Compression::Lz4},
+                                       .threads = 3});
+
+    std::filesystem::path staged = columnar_file.Path();
+    staged += ".compact";
+    EXPECT_FALSE(std::filesystem::exists(staged));
+
+    uint64_t row_bytes = 0;
+    {
+        const ColumnarBatchReader reader(columnar_file.Path());
+        const auto& row_groups = reader.GetMetadata().row_groups;
+        ASSERT_EQ(row_groups.size(), 3u);
+        EXPECT_EQ(row_groups[0].row_count, 20u);
+        EXPECT_EQ(row_groups[1].row_count, 20u);
+        EXPECT_EQ(row_groups[2].row_count, 10u);
+        for (const auto& row_group : row_groups) {
+            EXPECT_FALSE(row_group.columns[0].bloom_filter.Empty());
+            EXPECT_TRUE(row_group.columns[1].bloom_filter.Empty());
+            row_bytes += row_group.columns[0].uncompressed_size + row_group.columns[1].uncompressed_size;
+        }
+        row_bytes = std::max<uint64_t>(row_bytes / data_rows.size(), 1);
+    }
+
+    ConvertColumnarToCsv(columnar_file.Path(), schema_out.Path(), data_out.Path());
+    EXPECT_EQ(ReadRows(data_out.Path()), data_rows);
+
+    // The byte target is converted to rows with the average row size of the input chunks.
+    CompactColumnarFile(columnar_file.Path(), sorted_file.Path(),
+                        CompactOptions{.target_rows = 20,
+                                       .target_bytes = row_bytes * 7,
+                                       .sort = SortOptions{.columns = {"id"}, .run_rows = 16},
+                                       .threads = 2});
+
+    const ColumnarBatchReader sorted(sorted_file.Path());
+    const auto& row_groups = sorted.GetMetadata().row_groups;
+    ASSERT_EQ(row_groups.size(), 8u);
+    for (size_t i = 0; i < row_groups.size(); ++i) {
+        EXPECT_EQ(row_groups[i].row_count, i + 1 < row_groups.size() ? 7u : 1u);
+        if (i + 1 < row_groups.size()) {
+            EXPECT_LT(row_groups[i].columns[0].max_value, row_groups[i + 1].columns[0].min_value);
+        }
+    }
+
+    std::vector<std::vector<std::string>> expected = data_rows;
+    std::ranges::sort(expected, [](const auto& lhs, const auto& rhs) { return std::stoi(lhs[0]) < std::stoi(rhs[0]); });
+    ConvertColumnarToCsv(sorted_file.Path(), schema_out.Path(), data_out.Path());
+    EXPECT_EQ(ReadRows(data_out.Path()), expected);
+}
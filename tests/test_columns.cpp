@@ -1,13 +1,20 @@
+#include <charconv>
+#include <optional>
+#include <span>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <vector>
 
+#include "common/bit_packing.h"
+#include "common/error.h"
+#include "common/parsing.h"
+#include "gtest/gtest.h"
+#include "model/batch.h"
 #include "model/column.h"
+#include "model/column_dictionary_string.h"
 #include "model/column_int64.h"
 #include "model/column_string.h"
-#include "common/error.h"
-#include "gtest/gtest.h"
-#include "common/parsing.h"
 
 static void ExpectColumnRoundtrip(const ColumnType type, const std::vector<std::string>& values,
                                   const std::vector<std::string>& expected_values = {}) {
@@ -70,6 +77,122 @@ TEST(columns, string_roundtrip) {
     EXPECT_EQ(read_back.ValueAsString(2), "be,ta");
 }
 
+TEST(columns, read_from_span) {
+    Int64Column ints;
+    ints.AppendFromString("7");
+    ints.AppendFromString("-3");
+    StringColumn strings;
+    strings.AppendFromString("alpha");
+    strings.AppendFromString("");
+
+    std::stringstream int_buffer;
+    ints.WriteTo(int_buffer);
+    const std::string int_bytes = int_buffer.str();
+    std::stringstream string_buffer;
+    strings.WriteTo(string_buffer);
+    const std::string string_bytes = string_buffer.str();
+
+    Int64Column int_read_back;
+    int_read_back.ReadFrom(std::span(reinterpret_cast<const uint8_t*>(int_bytes.data()), int_bytes.size()), 2);
+    EXPECT_EQ(int_read_back.ValueAsString(0), "7");
+    EXPECT_EQ(int_read_back.ValueAsString(1), "-3");
+
+    StringColumn string_read_back;
+    const std::span string_span(reinterpret_cast<const uint8_t*>(string_bytes.data()), string_bytes.size());
+    string_read_back.ReadFrom(string_span, 2);
+    EXPECT_EQ(string_read_back.ValueAsString(0), "alpha");
+    EXPECT_EQ(string_read_back.ValueAsString(1), "");
+
+    StringColumn truncated;
+    EXPECT_THROW(truncated.ReadFrom(string_span.first(string_span.size() - 1), 2), Error);
+}
+
+TEST(columns, string_ranges_and_selections_keep_values) {
+    StringColumn source;
+    for (const std::string value : {"alpha", "", "gamma", "delta delta", "e"}) {
+        source.AppendFromString(value);
+    }
+
+    StringColumn target;
+    target.AppendFromString("head");
+    target.AppendRangeFromColumn(source, 1, 3);
+    target.AppendSelectedFromColumn(source, std::vector<size_t>{4, 0});
+    target.AppendFromColumn(source, 3);
+
+    std::vector<std::string> values;
+    for (size_t row = 0; row < target.Size(); ++row) {
+        values.emplace_back(target.ValueAt(row));
+    }
+    EXPECT_EQ(values, (std::vector<std::string>{"head", "", "gamma", "delta delta", "e", "alpha", "delta delta"}));
+
+    std::vector<size_t> rows;
+    target.SelectRowsByStringSet({"delta delta", "", "missing"}, rows);
+    EXPECT_EQ(rows, (std::vector<size_t>{1, 3, 6}));
+
+    target.Clear();
+    target.AppendRangeFromColumn(source, 0, 0);
+    EXPECT_EQ(target.Size(), 0u);
+    target.AppendFromString("again");
+    EXPECT_EQ(target.ValueAt(0), "again");
+}
+
+TEST(columns, dictionary_string_codes_survive_selection) {
+    DictionaryStringColumn values;
+    for (const char* value : {"iPhone", "Galaxy", "iPhone", "", "iPad", "Galaxy"}) {
+        values.AppendFromString(value);
+    }
+    ASSERT_EQ(values.GetDictionary()->size(), 4u);
+
+    std::vector<size_t> rows;
+    values.SelectRowsByLikePattern("i%", false, rows);
+    EXPECT_EQ(rows, (std::vector<size_t>{0, 2, 4}));
+    rows.clear();
+    values.SelectRowsByStringSet({"Galaxy", ""}, rows);
+    EXPECT_EQ(rows, (std::vector<size_t>{1, 3, 5}));
+
+    std::vector<uint8_t> encoded;
+    values.WriteDictionaryTo(encoded);
+    DictionaryStringColumn read_back;
+    read_back.ReadDictionaryFrom(encoded, 6);
+    for (size_t row = 0; row < values.Size(); ++row) {
+        EXPECT_EQ(read_back.ValueAsString(row), values.ValueAsString(row));
+    }
+    EXPECT_THROW(read_back.ReadDictionaryFrom(std::span(encoded).first(encoded.size() - 1), 6), Error);
+
+    Batch source(Schema{{ColumnSchema{"model", ColumnType::String}}});
+    source.SetColumn(0, read_back.CloneMutable());
+    Batch filtered(source.GetSchema());
+    filtered.AppendRowsSelectedFromBatch(source, rows);
+
+    const auto* filtered_column = dynamic_cast<const DictionaryStringColumn*>(&filtered.ColumnAt(0));
+    ASSERT_NE(filtered_column, nullptr);
+    EXPECT_EQ(filtered_column->GetDictionary(), read_back.GetDictionary());
+    EXPECT_EQ(filtered_column->ValueAsString(0), "Galaxy");
+    EXPECT_EQ(filtered_column->ValueAsString(1), "");
+
+    StringColumn plain;
+    plain.AppendSelectedFromColumn(read_back, rows);
+    EXPECT_EQ(plain.ValueAsString(2), "Galaxy");
+}
+
+TEST(columns, bit_packing_roundtrips_every_width) {
+    for (uint8_t width = 0; width <= 64; ++width) {
+        const uint64_t mask = width == 64 ? ~uint64_t{0} : (uint64_t{1} << width) - 1;
+        std::vector<uint64_t> values(37);
+        for (size_t i = 0; i < values.size(); ++i) {
+            values[i] = (0x9e3779b97f4a7c15ULL * (i + 1)) & mask;
+        }
+
+        std::vector<uint8_t> packed;
+        PackBits<uint64_t>(values, width, packed);
+        ASSERT_EQ(packed.size(), PackedByteCount(values.size(), width));
+
+        std::vector<uint64_t> unpacked(values.size());
+        UnpackBits<uint64_t>(packed, width, unpacked);
+        EXPECT_EQ(unpacked, values) << "width " << static_cast<int>(width);
+    }
+}
+
 TEST(columns, int64_invalid_value_throws) {
     Int64Column values;
     EXPECT_THROW(values.AppendFromString("not_a_number"), Error);
@@ -96,6 +219,69 @@ TEST(columns, supported_scalar_types_roundtrip) {
     ExpectColumnRoundtrip(ColumnType::Character, {"A", ",", "\n"});
 }
 
+TEST(columns, integer_parsing_matches_from_chars) {
+    const std::vector<std::string_view> values = {
+        "0", "-0", "7", "-7", "12345678", "-123456789", "9223372036854775807", "-9223372036854775808",
+        "9223372036854775808", "-9223372036854775809", "18446744073709551616", "00000000000000000000042", "+5",
+        "-", "", "12a45678", "1234567/", "123456789:", " 1", "32767", "-32768", "32768", "2147483648"};
+
+    for (const std::string_view value : values) {
+        int64_t expected = 0;
+        const auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), expected);
+        const bool valid = !value.empty() && ec == std::errc() && ptr == value.data() + value.size();
+        EXPECT_EQ(TryParseInt64(value), valid ? std::optional(expected) : std::nullopt) << value;
+
+        int16_t expected16 = 0;
+        const auto [ptr16, ec16] = std::from_chars(value.data(), value.data() + value.size(), expected16);
+        const bool valid16 = !value.empty() && ec16 == std::errc() && ptr16 == value.data() + value.size();
+        EXPECT_EQ(TryParseInt16(value), valid16 ? std::optional(expected16) : std::nullopt) << value;
+    }
+}
+
+TEST(columns, batch_parsers_report_the_first_invalid_value) {
+    const std::vector<std::string_view> dates = {"1970-01-01", "2024-02-29", "0000-01-01", "0000-02-29",
+                                                 "1900-03-01", "2000-02-29", "9999-12-31"};
+    std::vector<int32_t> days(dates.size());
+    EXPECT_EQ(TryParseDates(dates, days), std::nullopt);
+    for (size_t i = 0; i < dates.size(); ++i) {
+        EXPECT_EQ(days[i], ParseDate(dates[i]));
+        EXPECT_EQ(DateToString(days[i]), dates[i]);
+    }
+
+    for (const std::string_view invalid : {"2023-02-29", "1900-02-29", "2024-13-01", "2024-00-10", "2024-1a-01",
+                                           "2024/01/01", "2024-01-1", "-024-01-01"}) {
+        const std::vector<std::string_view> values = {"2024-01-01", invalid};
+        EXPECT_EQ(TryParseDates(values, days), std::optional<size_t>(1)) << invalid;
+    }
+
+    const std::vector<std::string_view> timestamps = {"1970-01-01 00:00:00", "2024-02-29T23:59:59.000001",
+                                                      "1969-12-31 23:59:59.5"};
+    std::vector<int64_t> micros(timestamps.size());
+    EXPECT_EQ(TryParseTimestamps(timestamps, micros), std::nullopt);
+    EXPECT_EQ(micros[0], 0);
+    EXPECT_EQ(micros[1], ParseTimestamp("2024-02-29 23:59:59.000001"));
+    EXPECT_EQ(micros[2], -500000);
+
+    for (const std::string_view invalid : {"2024-01-01 24:00:00", "2024-01-01 12:60:00", "2024-01-01 12:00:60",
+                                           "2024-01-01 12-00-00", "2024-01-01 1:00:000", "2024-01-01 12:00:00."}) {
+        const std::vector<std::string_view> values = {invalid};
+        EXPECT_EQ(TryParseTimestamps(values, micros), std::optional<size_t>(0)) << invalid;
+    }
+
+    const std::vector<std::string_view> ints = {"1", "2", "x", "4"};
+    std::vector<int32_t> out(ints.size());
+    EXPECT_EQ(TryParseInt32s(ints, out), std::optional<size_t>(2));
+    EXPECT_EQ(out[0], 1);
+    EXPECT_EQ(out[1], 2);
+
+    auto column = CreateColumn(ColumnType::Int32);
+    column->AppendFromString("10");
+    EXPECT_THROW(column->AppendFromStrings(ints), Error);
+    EXPECT_EQ(column->Size(), 1u);
+    column->AppendFromStrings(std::span(ints).first(2));
+    EXPECT_EQ(column->ValueAsString(2), "2");
+}
+
 TEST(columns, scalar_invalid_values_throw) {
     auto boolean = CreateColumn(ColumnType::Boolean);
     EXPECT_THROW(boolean->AppendFromString("maybe"), Error);
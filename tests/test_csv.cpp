@@ -1,10 +1,12 @@
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <type_traits>
 #include <vector>
 
-#include "io/csv.h"
+#include "common/error.h"
 #include "gtest/gtest.h"
+#include "io/csv.h"
 
 static_assert(!std::is_copy_constructible_v<CsvReader>);
 static_assert(!std::is_copy_assignable_v<CsvReader>);
@@ -63,3 +65,85 @@ TEST(csv, moved_reader_and_writer_remain_usable) {
     EXPECT_EQ(row, (std::vector<std::string>{"1", "value"}));
     EXPECT_FALSE(moved_reader.ReadRow(row));
 }
+
+TEST(csv, block_scanner_matches_writer_across_block_and_buffer_boundaries) {
+    std::vector<std::vector<std::string>> rows;
+    for (size_t i = 0; i < 30000; ++i) {
+        std::string text(i % 97, static_cast<char>('a' + i % 26));
+        if (i % 5 == 0) {
+            text.insert(text.size() / 2, "\"");
+        }
+        if (i % 7 == 0) {
+            text += ",\r\n";
+        }
+        rows.push_back({std::to_string(i), text, ""});
+    }
+    rows.push_back({std::string((1 << 20) + 3, 'x'), "\"\"", "last"});
+
+    std::stringstream buffer;
+    const CsvWriter writer(buffer);
+    for (const auto& row : rows) {
+        writer.WriteRow(row);
+    }
+
+    CsvReader reader(buffer);
+    std::vector<std::string> row;
+    std::vector<std::string_view> view_row;
+    for (size_t i = 0; i < rows.size(); ++i) {
+        ASSERT_TRUE(i % 2 == 0 ? reader.ReadRow(row) : reader.ReadRow(view_row)) << i;
+        if (i % 2 == 0) {
+            ASSERT_EQ(row, rows[i]) << i;
+        } else {
+            ASSERT_EQ(std::vector<std::string>(view_row.begin(), view_row.end()), rows[i]) << i;
+        }
+    }
+    EXPECT_FALSE(reader.ReadRow(row));
+}
+
+TEST(csv, quotes_open_only_at_the_start_of_a_value) {
+    std::istringstream input("ab\"c,\"x\"y,\"\"\"\"\r\n\"a,b\n,\n\"z\n\"open");
+    CsvReader reader(input);
+    std::vector<std::string_view> row;
+
+    ASSERT_TRUE(reader.ReadRow(row));
+    EXPECT_EQ(row, (std::vector<std::string_view>{"ab\"c", "xy", "\""}));
+
+    std::vector<std::string> strings;
+    ASSERT_TRUE(reader.ReadRow(strings));
+    EXPECT_EQ(strings, (std::vector<std::string>{"a,b\n,\nz"}));
+
+    EXPECT_THROW(reader.ReadRow(row), Error);
+}
+
+TEST(csv, read_rows_returns_buffered_rows_as_fields) {
+    std::istringstream input("1,a\n2,\"b\"\"c\"\n3,\"d\ne\"\n4,f\n5,g,extra\n");
+    CsvReader reader(input);
+    std::vector<std::string_view> fields;
+
+    ASSERT_EQ(reader.ReadRows(fields, 2, 3), 3u);
+    EXPECT_EQ(fields, (std::vector<std::string_view>{"1", "a", "2", "b\"c", "3", "d\ne"}));
+
+    ASSERT_EQ(reader.ReadRows(fields, 2, 1), 1u);
+    EXPECT_EQ(fields, (std::vector<std::string_view>{"4", "f"}));
+
+    EXPECT_THROW(reader.ReadRows(fields, 2, 3), Error);
+}
+
+TEST(csv, fields_are_quoted_when_any_block_holds_a_special_character) {
+    for (const size_t at : {0u, 15u, 63u, 64u, 100u, 127u, 128u, 150u}) {
+        for (const char special : {',', '"', '\n', '\r'}) {
+            std::string value(151, 'v');
+            EXPECT_FALSE(NeedsCsvQuotes(value));
+            value[at] = special;
+            EXPECT_TRUE(NeedsCsvQuotes(value)) << at;
+
+            std::string field;
+            AppendCsvField(field, value);
+            std::istringstream input(field + "\n");
+            CsvReader reader(input);
+            std::vector<std::string> row;
+            ASSERT_TRUE(reader.ReadRow(row));
+            EXPECT_EQ(row, std::vector<std::string>{value});
+        }
+    }
+}
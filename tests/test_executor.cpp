@@ -1,5 +1,8 @@
 #include <algorithm>
+#include <chrono>
 #include <cstring>
+#include <filesystem>
+#include <span>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -408,6 +411,34 @@ TEST(executor, supports_group_by_computed_numeric_and_timestamp_keys) {
     }
 }
 
+// Swaps the metadata blob of a columnar file, e.g. to point chunks that must not be read past the end of the file.
+static void ReplaceFileMetadata(const std::filesystem::path& path, const ColumnarMetadata& metadata) {
+    std::ostringstream metadata_stream;
+    WriteMetadata(metadata_stream, metadata);
+    const std::string metadata_blob = metadata_stream.str();
+
+    std::vector<uint8_t> bytes = ReadFileBytes(path);
+    ASSERT_GE(bytes.size(), sizeof(uint64_t) + 4u);
+
+    const size_t footer_offset = bytes.size() - sizeof(uint64_t) - 4u;
+    uint64_t metadata_size = 0;
+    std::memcpy(&metadata_size, bytes.data() + footer_offset, sizeof(metadata_size));
+
+    const size_t metadata_offset = footer_offset - metadata_size;
+    bytes.erase(bytes.begin() + static_cast<std::ptrdiff_t>(metadata_offset),
+                bytes.begin() + static_cast<std::ptrdiff_t>(footer_offset));
+    bytes.insert(bytes.begin() + static_cast<std::ptrdiff_t>(metadata_offset), metadata_blob.begin(),
+                 metadata_blob.end());
+
+    const uint64_t patched_metadata_size = metadata_blob.size();
+    std::memcpy(bytes.data() + metadata_offset + metadata_blob.size(), &patched_metadata_size,
+                sizeof(patched_metadata_size));
+
+    WriteFileBytes(path, bytes);
+    // The rewrite keeps the file size, so move the timestamp on for MetadataCache to notice it within one clock tick.
+    std::filesystem::last_write_time(path, std::filesystem::last_write_time(path) + std::chrono::seconds(1));
+}
+
 TEST(executor, prunes_row_groups_for_typed_where_filters_before_reading_chunks) {
     const TempFile schema_file("executor_prune_schema");
     const TempFile data_file("executor_prune_data");
@@ -435,34 +466,421 @@ TEST(executor, prunes_row_groups_for_typed_where_filters_before_reading_chunks)
     ASSERT_TRUE(file_info.has_value());
 
     metadata.row_groups[1].columns[0].offset = file_info->size + 1024;
+    ReplaceFileMetadata(columnar_file.Path(), metadata);
 
-    std::ostringstream metadata_stream;
-    WriteMetadata(metadata_stream, metadata);
-    const std::string metadata_blob = metadata_stream.str();
+    Executor executor;
+    executor.RegisterTable("hits", columnar_file.Path());
 
-    std::vector<uint8_t> bytes = ReadFileBytes(columnar_file.Path());
-    ASSERT_GE(bytes.size(), sizeof(uint64_t) + 4u);
+    auto result = executor.Execute("SELECT COUNT(*) FROM hits WHERE EventDate = '2024-01-01';");
+    ASSERT_TRUE(result.has_value()) << result.error().what();
+    EXPECT_EQ(SingleRowValues(result.value()), std::vector<std::string>{"2"});
+}
 
-    const size_t footer_offset = bytes.size() - sizeof(uint64_t) - 4u;
-    uint64_t metadata_size = 0;
-    std::memcpy(&metadata_size, bytes.data() + footer_offset, sizeof(metadata_size));
+TEST(executor, bloom_filters_prune_row_groups_for_point_lookups) {
+    const TempFile schema_file("executor_bloom_schema");
+    const TempFile data_file("executor_bloom_data");
+    const TempFile columnar_file("executor_bloom_columnar");
 
-    const size_t metadata_offset = footer_offset - metadata_size;
-    bytes.erase(bytes.begin() + static_cast<std::ptrdiff_t>(metadata_offset),
-                bytes.begin() + static_cast<std::ptrdiff_t>(footer_offset));
-    bytes.insert(bytes.begin() + static_cast<std::ptrdiff_t>(metadata_offset), metadata_blob.begin(),
-                 metadata_blob.end());
+    WriteRows(schema_file.Path(), {
+                                      {"UserID", "int64"},
+                                      {"URL", "string"},
+                                  });
 
-    const uint64_t patched_metadata_size = metadata_blob.size();
-    std::memcpy(bytes.data() + metadata_offset + metadata_blob.size(), &patched_metadata_size,
-                sizeof(patched_metadata_size));
+    std::vector<std::vector<std::string>> rows;
+    for (int i = 0; i < 64; ++i) {
+        const int64_t user = int64_t{i * 37 % 64} * 7919;
+        rows.push_back({std::to_string(user), "https://example.com/page" + std::to_string(i)});
+    }
+    WriteRows(data_file.Path(), rows);
+
+    ConvertCsvToColumnar(schema_file.Path(), data_file.Path(), columnar_file.Path(), 32,
+                         ColumnarWriteOptions{.bloom_filter_columns = {"UserID", "URL"}});
 
-    WriteFileBytes(columnar_file.Path(), bytes);
+    ColumnarMetadata metadata = ColumnarBatchReader(columnar_file.Path()).GetMetadata();
+    ASSERT_EQ(metadata.row_groups.size(), 2u);
+    ASSERT_FALSE(metadata.row_groups[1].columns[0].bloom_filter.Empty());
+    ASSERT_FALSE(metadata.row_groups[1].columns[1].bloom_filter.Empty());
+
+    const auto file_info = GetFileMetadata(columnar_file.Path());
+    ASSERT_TRUE(file_info.has_value());
+    for (auto& chunk : metadata.row_groups[1].columns) {
+        chunk.offset = file_info->size + 1024;
+    }
+    ReplaceFileMetadata(columnar_file.Path(), metadata);
 
     Executor executor;
     executor.RegisterTable("hits", columnar_file.Path());
 
-    auto result = executor.Execute("SELECT COUNT(*) FROM hits WHERE EventDate = '2024-01-01';");
-    ASSERT_TRUE(result.has_value()) << result.error().what();
-    EXPECT_EQ(SingleRowValues(result.value()), std::vector<std::string>{"2"});
+    const auto count = [&](const std::string& query) {
+        auto result = executor.Execute(query);
+        if (!result.has_value()) {
+            throw result.error();
+        }
+        return SingleRowValues(result.value());
+    };
+
+    EXPECT_EQ(count("SELECT COUNT(*) FROM hits WHERE UserID = " + std::to_string(37 * 7919) + ";"),
+              std::vector<std::string>{"1"});
+    EXPECT_EQ(count("SELECT COUNT(*) FROM hits WHERE UserID IN (" + std::to_string(10 * 7919) + ", " +
+                    std::to_string(47 * 7919) + ");"),
+              std::vector<std::string>{"2"});
+    EXPECT_EQ(count("SELECT COUNT(*) FROM hits WHERE URL = 'https://example.com/page3';"),
+              std::vector<std::string>{"1"});
+}
+
+TEST(executor, approx_count_distinct_merges_chunk_sketches_from_metadata) {
+    const TempFile schema_file("executor_sketch_schema");
+    const TempFile data_file("executor_sketch_data");
+    const TempFile columnar_file("executor_sketch_columnar");
+
+    WriteRows(schema_file.Path(), {
+                                      {"UserID", "int64"},
+                                      {"URL", "string"},
+                                  });
+
+    std::vector<std::vector<std::string>> rows;
+    for (int i = 0; i < 300; ++i) {
+        rows.push_back({std::to_string(i % 50), "https://example.com/" + std::to_string(i % 120)});
+    }
+    WriteRows(data_file.Path(), rows);
+
+    ConvertCsvToColumnar(schema_file.Path(), data_file.Path(), columnar_file.Path(), 100,
+                         ColumnarWriteOptions{.distinct_sketch_columns = {"UserID", "URL"}});
+
+    Executor executor;
+    executor.RegisterTable("hits", columnar_file.Path());
+
+    const auto run = [&](const std::string& query) {
+        auto result = executor.Execute(query);
+        if (!result.has_value()) {
+            throw result.error();
+        }
+        return SingleRowValues(result.value());
+    };
+
+    // A filtered query hashes rows at scan time; merging the chunk sketches must give the very same estimate.
+    const std::vector<std::string> scanned = run(
+        "SELECT APPROX_COUNT_DISTINCT(UserID), APPROX_COUNT_DISTINCT(URL), MAX(UserID) FROM hits WHERE UserID >= 0;");
+    ASSERT_EQ(scanned.size(), 3u);
+    EXPECT_NEAR(std::stod(scanned[0]), 50.0, 2.0);
+    EXPECT_NEAR(std::stod(scanned[1]), 120.0, 3.0);
+
+    ColumnarMetadata metadata = ColumnarBatchReader(columnar_file.Path()).GetMetadata();
+    ASSERT_EQ(metadata.row_groups.size(), 3u);
+    const auto file_info = GetFileMetadata(columnar_file.Path());
+    ASSERT_TRUE(file_info.has_value());
+    for (auto& row_group : metadata.row_groups) {
+        for (auto& chunk : row_group.columns) {
+            chunk.offset = file_info->size + 1024;
+        }
+    }
+    ReplaceFileMetadata(columnar_file.Path(), metadata);
+
+    EXPECT_EQ(run("SELECT APPROX_COUNT_DISTINCT(UserID), APPROX_COUNT_DISTINCT(URL), MAX(UserID) FROM hits;"),
+              scanned);
+}
+
+TEST(executor, string_statistics_prune_row_groups_and_skip_empty_chunks) {
+    const TempFile schema_file("executor_string_stats_schema");
+    const TempFile data_file("executor_string_stats_data");
+    const TempFile columnar_file("executor_string_stats_columnar");
+
+    WriteRows(schema_file.Path(), {
+                                      {"SearchPhrase", "string"},
+                                      {"N", "int64"},
+                                  });
+    const std::vector<std::string> phrases = {"", "", "", "", "apple", "apricot", "banana", "", "zebra", "zoo", "zeta",
+                                              "zulu"};
+    std::vector<std::vector<std::string>> rows;
+    for (size_t i = 0; i < phrases.size(); ++i) {
+        rows.push_back({phrases[i], std::to_string(i)});
+    }
+    WriteRows(data_file.Path(), rows);
+
+    ConvertCsvToColumnar(schema_file.Path(), data_file.Path(), columnar_file.Path(), 4);
+
+    ColumnarMetadata metadata = ColumnarBatchReader(columnar_file.Path()).GetMetadata();
+    ASSERT_EQ(metadata.row_groups.size(), 3u);
+    ASSERT_TRUE(metadata.row_groups[0].columns[0].has_string_stats);
+    EXPECT_EQ(metadata.row_groups[0].columns[0].empty_count, 4u);
+
+    // Nothing in the first row group may be read: its phrases are rebuilt from statistics and N must be pruned.
+    const auto file_info = GetFileMetadata(columnar_file.Path());
+    ASSERT_TRUE(file_info.has_value());
+    for (auto& chunk : metadata.row_groups[0].columns) {
+        chunk.offset = file_info->size + 1024;
+    }
+    ReplaceFileMetadata(columnar_file.Path(), metadata);
+
+    const auto run = [&](const std::string& query, const ScanOptions options) {
+        Executor executor;
+        executor.RegisterTable("hits", columnar_file.Path());
+        executor.SetScanOptions(options);
+
+        auto result = executor.Execute(query);
+        if (!result.has_value()) {
+            throw result.error();
+        }
+        return SingleRowValues(result.value());
+    };
+
+    for (const ScanOptions options : {ScanOptions{.read_ahead_row_groups = 0},
+                                      ScanOptions{.read_ahead_row_groups = 2, .worker_threads = 2}}) {
+        EXPECT_EQ(run("SELECT SUM(N) FROM hits WHERE SearchPhrase <> '';", options), std::vector<std::string>{"53"});
+        EXPECT_EQ(run("SELECT SUM(N) FROM hits WHERE SearchPhrase LIKE 'ap%';", options),
+                  std::vector<std::string>{"9"});
+        EXPECT_EQ(run("SELECT SUM(N) FROM hits WHERE SearchPhrase = 'zoo';", options), std::vector<std::string>{"9"});
+        EXPECT_EQ(run("SELECT SUM(N) FROM hits WHERE SearchPhrase > 'b';", options), std::vector<std::string>{"44"});
+        EXPECT_EQ(run("SELECT SUM(N) FROM hits WHERE SearchPhrase IN ('zoo', 'apple');", options),
+                  std::vector<std::string>{"13"});
+        EXPECT_EQ(run("SELECT COUNT(*) FROM hits WHERE SearchPhrase = '';", options), std::vector<std::string>{"5"});
+        EXPECT_EQ(run("SELECT COUNT(*) FROM hits WHERE SearchPhrase NOT LIKE 'z%';", options),
+                  std::vector<std::string>{"8"});
+    }
+}
+
+TEST(executor, page_zone_maps_prune_rows_inside_row_groups) {
+    const TempFile schema_file("executor_page_prune_schema");
+    const TempFile data_file("executor_page_prune_data");
+    const TempFile paged_file("executor_page_prune_paged");
+    const TempFile plain_file("executor_page_prune_plain");
+    const TempFile compressed_file("executor_page_prune_compressed");
+    const TempFile unpaged_file("executor_page_prune_unpaged");
+
+    WriteRows(schema_file.Path(), {
+                                      {"CounterID", "int32"},
+                                      {"EventDate", "date"},
+                                      {"URL", "string"},
+                                  });
+
+    std::vector<std::vector<std::string>> rows;
+    for (int i = 0; i < 40; ++i) {
+        const std::string day = std::to_string(101 + i / 4).substr(1);
+        rows.push_back({i / 8 == 2 ? "62" : std::to_string(i / 8), "2024-01-" + day, "u" + std::to_string(i % 3)});
+    }
+    WriteRows(data_file.Path(), rows);
+
+    ConvertCsvToColumnar(schema_file.Path(), data_file.Path(), paged_file.Path(), 40,
+                         ColumnarWriteOptions{.page_rows = 4});
+    // Plain chunks are read page by page rather than decoded whole.
+    ConvertCsvToColumnar(schema_file.Path(), data_file.Path(), plain_file.Path(), 40,
+                         ColumnarWriteOptions{.lightweight_encoding = false, .page_rows = 4});
+    ConvertCsvToColumnar(schema_file.Path(), data_file.Path(), compressed_file.Path(), 40,
+                         ColumnarWriteOptions{.compression = Compression::Lz4, .lightweight_encoding = false,
+                                              .page_rows = 4});
+    ConvertCsvToColumnar(schema_file.Path(), data_file.Path(), unpaged_file.Path(), 40,
+                         ColumnarWriteOptions{.page_rows = 0});
+
+    const auto run = [](const std::filesystem::path& path, const std::string& query, const ScanOptions options) {
+        Executor executor;
+        executor.RegisterTable("hits", path);
+        executor.SetScanOptions(options);
+
+        auto result = executor.Execute(query);
+        if (!result.has_value()) {
+            throw result.error();
+        }
+        return BatchRows(result.value());
+    };
+
+    const std::vector<std::string> queries = {
+        "SELECT URL, COUNT(*) AS c FROM hits WHERE CounterID = 62 AND EventDate >= '2024-01-05' AND "
+        "EventDate <= '2024-01-05' GROUP BY URL ORDER BY URL;",
+        "SELECT COUNT(*) FROM hits WHERE EventDate > '2024-01-08';",
+        "SELECT COUNT(*) FROM hits WHERE CounterID IN (0, 4);",
+        "SELECT COUNT(*) FROM hits WHERE CounterID = 7;",
+    };
+
+    const auto expected_urls = std::vector<std::vector<std::string>>{
+        {"u0", "1"},
+        {"u1", "2"},
+        {"u2", "1"},
+    };
+    EXPECT_EQ(run(paged_file.Path(), queries[0], {.read_ahead_row_groups = 0}), expected_urls);
+    for (const auto& query : queries) {
+        const auto expected = run(unpaged_file.Path(), query, {.read_ahead_row_groups = 0});
+        for (const auto& path : {paged_file.Path(), plain_file.Path(), compressed_file.Path()}) {
+            EXPECT_EQ(run(path, query, {.read_ahead_row_groups = 0}), expected) << query;
+            EXPECT_EQ(run(path, query, {.read_ahead_row_groups = 2, .worker_threads = 2}), expected) << query;
+            EXPECT_EQ(run(path, query, {.read_ahead_row_groups = 2, .worker_threads = 2, .io = ScanIo::Mapped}),
+                      expected)
+                << query;
+        }
+    }
+}
+
+TEST(executor, read_ahead_scan_matches_synchronous_scan) {
+    const TempFile schema_file("executor_read_ahead_schema");
+    const TempFile data_file("executor_read_ahead_data");
+    const TempFile columnar_file("executor_read_ahead_columnar");
+
+    WriteRows(schema_file.Path(), {
+                                      {"Key", "string"},
+                                      {"Value", "int64"},
+                                  });
+
+    std::vector<std::vector<std::string>> rows;
+    for (int i = 0; i < 23; ++i) {
+        rows.push_back({i % 3 == 0 ? "x" : "y", std::to_string(i)});
+    }
+    WriteRows(data_file.Path(), rows);
+
+    ConvertCsvToColumnar(schema_file.Path(), data_file.Path(), columnar_file.Path(), 4);
+
+    const auto run = [&](const ScanOptions options) {
+        Executor executor;
+        executor.RegisterTable("events", columnar_file.Path());
+        executor.SetScanOptions(options);
+
+        auto result = executor.Execute("SELECT Key, SUM(Value), COUNT(*) FROM events GROUP BY Key ORDER BY Key;");
+        if (!result.has_value()) {
+            throw result.error();
+        }
+        return BatchRows(result.value());
+    };
+
+    const auto expected = std::vector<std::vector<std::string>>{
+        {"x", "84", "8"},
+        {"y", "169", "15"},
+    };
+    EXPECT_EQ(run({.read_ahead_row_groups = 0}), expected);
+    EXPECT_EQ(run({.read_ahead_row_groups = 1, .worker_threads = 1}), expected);
+    EXPECT_EQ(run({.read_ahead_row_groups = 4, .worker_threads = 3}), expected);
+    EXPECT_EQ(run({.read_ahead_row_groups = 2, .worker_threads = 2, .io = ScanIo::Mapped}), expected);
+    EXPECT_EQ(run({.read_ahead_row_groups = 3, .worker_threads = 2, .io_backend = IoBackend::Preadv}), expected);
+}
+
+// Writes one columnar file per partition, e.g. {"EventDate=2024-01-01/Region=eu", rows}, below the table directory.
+static void WritePartitionedTable(const std::filesystem::path& table,
+                                  const std::vector<std::pair<std::string, std::vector<std::vector<std::string>>>>&
+                                      partitions) {
+    const TempFile schema_file("executor_partition_schema");
+    const TempFile data_file("executor_partition_data");
+
+    WriteRows(schema_file.Path(), {
+                                      {"EventDate", "date"},
+                                      {"Region", "string"},
+                                      {"Value", "int64"},
+                                  });
+
+    for (const auto& [directory, rows] : partitions) {
+        std::filesystem::create_directories(table / directory);
+        WriteRows(data_file.Path(), rows);
+        ConvertCsvToColumnar(schema_file.Path(), data_file.Path(), table / directory / "part-0.columnar", 2);
+    }
+}
+
+TEST(executor, partitioned_table_prunes_partitions_before_opening_footers) {
+    const TempFile table("executor_partitioned_table");
+
+    WritePartitionedTable(table.Path(), {
+                                            {"EventDate=2024-01-01/Region=eu",
+                                             {{"2024-01-01", "eu", "1"}, {"2024-01-01", "eu", "2"}}},
+                                            {"EventDate=2024-01-01/Region=us", {{"2024-01-01", "us", "4"}}},
+                                            {"EventDate=2024-01-02/Region=eu",
+                                             {{"2024-01-02", "eu", "8"}, {"2024-01-02", "eu", "16"},
+                                              {"2024-01-02", "eu", "32"}}},
+                                        });
+
+    // Not a columnar file: any query that has to open it fails.
+    const std::filesystem::path corrupt = table.Path() / "EventDate=2024-01-03" / "Region=eu";
+    std::filesystem::create_directories(corrupt);
+    WriteFileBytes(corrupt / "part-0.columnar", std::vector<uint8_t>{1, 2, 3});
+    WriteFileBytes(table.Path() / "_SUCCESS", std::vector<uint8_t>{});
+
+    const auto run = [&](const std::string& query, const ScanOptions options = {}) {
+        Executor executor;
+        executor.RegisterTable("hits", table.Path());
+        executor.SetScanOptions(options);
+
+        auto result = executor.Execute(query);
+        if (!result.has_value()) {
+            throw result.error();
+        }
+        return BatchRows(result.value());
+    };
+
+    using Rows = std::vector<std::vector<std::string>>;
+    EXPECT_EQ(run("SELECT COUNT(*), SUM(Value) FROM hits WHERE EventDate < '2024-01-03';"), (Rows{{"6", "63"}}));
+    EXPECT_EQ(run("SELECT SUM(Value) FROM hits WHERE EventDate = '2024-01-01' AND Region = 'eu';"), (Rows{{"3"}}));
+    EXPECT_EQ(run("SELECT COUNT(*) FROM hits WHERE Region IN ('us', 'apac') AND EventDate <= '2024-01-02';"),
+              (Rows{{"1"}}));
+    EXPECT_EQ(run("SELECT COUNT(*) FROM hits WHERE EventDate = '2030-01-01';"), (Rows{{"0"}}));
+
+    const Rows expected_groups{{"eu", "59"}, {"us", "4"}};
+    const std::string group_query =
+        "SELECT Region, SUM(Value) FROM hits WHERE EventDate <> '2024-01-03' GROUP BY Region ORDER BY Region;";
+    EXPECT_EQ(run(group_query, {.read_ahead_row_groups = 0}), expected_groups);
+    EXPECT_EQ(run(group_query, {.worker_threads = 2, .concurrent_files = 1}), expected_groups);
+    EXPECT_EQ(run(group_query, {.worker_threads = 4, .concurrent_files = 3}), expected_groups);
+
+    EXPECT_EQ(run("SELECT Value FROM hits WHERE EventDate >= '2024-01-01' AND EventDate <= '2024-01-02' "
+                  "ORDER BY Value DESC LIMIT 4;"),
+              (Rows{{"32"}, {"16"}, {"8"}, {"4"}}));
+
+    EXPECT_THROW(run("SELECT COUNT(*) FROM hits WHERE Value > 0;"), Error);
+}
+
+TEST(executor, partition_keys_missing_from_the_schema_do_not_prune) {
+    const TempFile table("executor_path_only_partitions");
+
+    WritePartitionedTable(table.Path(), {
+                                            {"Batch=1/Region=eu", {{"2024-01-01", "eu", "1"}}},
+                                            {"Batch=2/Region=us", {{"2024-01-02", "us", "10"}}},
+                                        });
+
+    const auto run = [&](const std::string& query) {
+        Executor executor;
+        executor.RegisterTable("hits", table.Path());
+
+        auto result = executor.Execute(query);
+        if (!result.has_value()) {
+            throw result.error();
+        }
+        return BatchRows(result.value());
+    };
+
+    using Rows = std::vector<std::vector<std::string>>;
+    EXPECT_EQ(run("SELECT SUM(Value) FROM hits WHERE Region = 'us';"), (Rows{{"10"}}));
+    // Batch exists only in the directory names, so it is neither a column nor a pruning key.
+    EXPECT_THROW(run("SELECT SUM(Value) FROM hits WHERE Batch = 1;"), Error);
+
+    const std::filesystem::path corrupt = table.Path() / "Batch=3" / "Region=eu";
+    std::filesystem::create_directories(corrupt);
+    WriteFileBytes(corrupt / "part-0.columnar", std::vector<uint8_t>{1, 2, 3});
+    EXPECT_EQ(run("SELECT SUM(Value) FROM hits WHERE Region = 'us';"), (Rows{{"10"}}));
+    EXPECT_THROW(run("SELECT SUM(Value) FROM hits WHERE Value > 0;"), Error);
+}
+
+TEST(executor, manifest_lists_table_files_relative_to_itself) {
+    const TempFile table("executor_manifest_table");
+
+    WritePartitionedTable(table.Path(), {
+                                            {"EventDate=2024-01-01/Region=eu", {{"2024-01-01", "eu", "1"}}},
+                                            {"EventDate=2024-01-02/Region=us", {{"2024-01-02", "us", "10"}}},
+                                            {"EventDate=2024-01-03/Region=eu", {{"2024-01-03", "eu", "100"}}},
+                                        });
+
+    const std::filesystem::path manifest = table.Path() / "hits.manifest";
+    const std::string_view listing =
+        "# skipped\n"
+        "EventDate=2024-01-03/Region=eu/part-0.columnar\n"
+        "\n"
+        "EventDate=2024-01-01/Region=eu/part-0.columnar\n";
+    WriteFileBytes(manifest, std::span(reinterpret_cast<const uint8_t*>(listing.data()), listing.size()));
+
+    Executor executor;
+    executor.RegisterTable("hits", manifest);
+
+    auto all = executor.Execute("SELECT Region, Value FROM hits ORDER BY Value;");
+    ASSERT_TRUE(all.has_value()) << all.error().what();
+    EXPECT_EQ(BatchRows(all.value()), (std::vector<std::vector<std::string>>{{"eu", "1"}, {"eu", "100"}}));
+
+    auto pruned = executor.Execute("SELECT MIN(Value), MAX(Value), COUNT(*) FROM hits WHERE EventDate > '2024-01-01';");
+    ASSERT_TRUE(pruned.has_value()) << pruned.error().what();
+    EXPECT_EQ(BatchRows(pruned.value()), (std::vector<std::vector<std::string>>{{"100", "100", "1"}}));
+
+    auto count = executor.Execute("SELECT COUNT(*) FROM hits;");
+    ASSERT_TRUE(count.has_value()) << count.error().what();
+    EXPECT_EQ(SingleRowValues(count.value()), std::vector<std::string>{"2"});
 }
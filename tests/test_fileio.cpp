@@ -1,10 +1,12 @@
 #include <filesystem>
 #include <ios>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "gtest/gtest.h"
 #include "io/file.h"
+#include "io/io_scheduler.h"
 #include "common/error.h"
 #include "testing/temp_file.h"
 
@@ -157,6 +159,60 @@ TEST(fileio, input_file_reads_at_offsets) {
     EXPECT_EQ(file.ReadStringAt(1, 3), std::string("\x0B\x0C\x0D", 3));
 }
 
+TEST(fileio, mapped_file_reads_at_offsets) {
+    const TempFile temp("fileio_mapped_file_read_at");
+    const std::vector<uint8_t> payload = {10, 11, 12, 13, 14};
+
+    WriteFileBytes(temp.Path(), payload);
+
+    const MappedFile file(temp.Path());
+    ASSERT_EQ(file.Size(), payload.size());
+    EXPECT_EQ(file.ReadAt<uint8_t>(3), payload[3]);
+
+    const auto view = file.ReadAt(1, 3);
+    EXPECT_EQ(std::vector<uint8_t>(view.begin(), view.end()), std::vector<uint8_t>({11, 12, 13}));
+    EXPECT_TRUE(file.ReadAt(payload.size(), 0).empty());
+    EXPECT_THROW(file.ReadAt(4, 2), Error);
+}
+
+TEST(fileio, io_scheduler_reads_batches) {
+    const TempFile temp("fileio_io_scheduler");
+    std::vector<uint8_t> payload(256);
+    for (size_t i = 0; i < payload.size(); ++i) {
+        payload[i] = static_cast<uint8_t>(i);
+    }
+    WriteFileBytes(temp.Path(), payload);
+
+    std::vector<IoBackend> backends = {IoBackend::Preadv, IoBackend::Auto};
+    if (IoUringAvailable()) {
+        backends.push_back(IoBackend::IoUring);
+    }
+    for (const IoBackend backend : backends) {
+        std::unique_ptr<IoScheduler> scheduler;
+        try {
+            scheduler = CreateIoScheduler(temp.Path(), backend);
+        } catch (const Error& error) {
+            // Built with liburing, but the kernel or a sandbox refuses io_uring.
+            ASSERT_EQ(error.GetCode(), Error::Code::Unsupported);
+            continue;
+        }
+
+        std::vector<uint8_t> first(16);
+        std::vector<uint8_t> adjacent(8);
+        std::vector<uint8_t> scattered(4);
+        const auto ticket = scheduler->Submit({{100, scattered}, {0, first}, {16, adjacent}});
+        scheduler->Wait(ticket);
+
+        EXPECT_EQ(first, std::vector<uint8_t>(payload.begin(), payload.begin() + 16));
+        EXPECT_EQ(adjacent, std::vector<uint8_t>(payload.begin() + 16, payload.begin() + 24));
+        EXPECT_EQ(scattered, std::vector<uint8_t>(payload.begin() + 100, payload.begin() + 104));
+
+        std::vector<uint8_t> past_end(8);
+        const auto failing = scheduler->Submit({{252, past_end}});
+        EXPECT_THROW(scheduler->Wait(failing), Error);
+    }
+}
+
 TEST(fileio, stream_open_missing_throws) {
     const auto missing = UniqueTempPath("fileio_stream_missing");
 